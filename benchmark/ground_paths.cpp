@@ -0,0 +1,115 @@
+// Compares the drawing paths of Toreo::Ground (Visualizer::GEOMETRY, Visualizer::INSTANCED
+// and Visualizer::TEXTURE) with Ground2D and Ground3D grids of 100 x 100 up to 2000 x 2000
+// cells, rendered offscreen with a headless Core. The times are the CPU and GPU averages of
+// the GROUND drawing pass (see Core::frame_statistics()); the paths chosen by
+// Visualizer::AUTOMATIC must be based on these results.
+//
+// usage: ground_paths [frames]
+
+#include "include/core.h"
+#include "include/ground_manager.h"
+#include "include/types.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  struct Path{
+    Visualizer::GroundMode mode;
+    const char *name;
+  };
+
+  template<typename T>
+  std::vector<T> synthetic_ground(const unsigned int elements){
+    std::mt19937 generator(7u);
+    std::uniform_real_distribution<float> color(0.0f, 255.0f);
+
+    std::vector<T> ground(static_cast<std::size_t>(elements) * elements);
+    for(T &cell : ground){
+      cell.r = color(generator);
+      cell.g = color(generator);
+      cell.b = color(generator);
+      cell.alpha = 255.0f;
+    }
+    return ground;
+  }
+
+  void set_heights(std::vector<Visualizer::Ground3D> *ground){
+    std::mt19937 generator(11u);
+    std::uniform_real_distribution<float> height(0.0f, 2.0f);
+    for(Visualizer::Ground3D &cell : *ground)
+      cell.height = height(generator);
+  }
+
+  // returns the GROUND pass timing of frames rendered with the ground in mode
+  Visualizer::FrameTiming measure(Toreo::Core *core, Toreo::GroundManager *grounds,
+                                  const GMid id, const Visualizer::GroundMode mode,
+                                  const unsigned int frames){
+    grounds->set_mode(id, mode);
+    // the first frames compile the programs and upload the data
+    for(unsigned int frame = 0; frame < 10u; ++frame)
+      core->render_frame();
+
+    core->reset_frame_statistics();
+    for(unsigned int frame = 0; frame < frames; ++frame)
+      core->render_frame();
+    return core->frame_statistics(Visualizer::GROUND);
+  }
+
+  template<typename T>
+  void compare(Toreo::Core *core, Toreo::GroundManager *grounds, const std::string type,
+               const std::vector<T> &ground, const unsigned int elements,
+               const std::vector<Path> &paths, const unsigned int frames){
+    const GMid id{grounds->add(&ground, type, 200.0f, 200.0f, elements, elements)};
+
+    float fastest{0.0f};
+    const char *fastest_name{""};
+    for(const Path &path : paths){
+      const Visualizer::FrameTiming timing{measure(core, grounds, id, path.mode, frames)};
+      std::cout << type << "\t" << elements << " x " << elements << "\t" << path.name << "\t"
+                << timing.cpu_average << "\t\t" << timing.gpu_average << "\t\t"
+                << timing.gpu_p99 << "\n";
+
+      if(fastest_name[0] == '\0' || timing.gpu_average < fastest){
+        fastest = timing.gpu_average;
+        fastest_name = path.name;
+      }
+    }
+    std::cout << type << "\t" << elements << " x " << elements << "\tfastest: "
+              << fastest_name << "\n";
+
+    grounds->delete_ground(id);
+  }
+}
+
+int main(int argc, char **argv){
+  const unsigned int frames{argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : 240u};
+  const unsigned int sizes[]{100u, 300u, 1000u, 2000u};
+
+  Toreo::Core core(argc, argv, true, 1280, 720);
+  Toreo::GroundManager grounds(&core);
+  core.enable_profiling(true, frames);
+
+  // the texture path draws Ground2D grids as one quad and Ground3D grids as a heightfield
+  const std::vector<Path> paths{ { Visualizer::GEOMETRY, "geometry" },
+                                 { Visualizer::INSTANCED, "instanced" },
+                                 { Visualizer::TEXTURE, "texture" },
+                                 { Visualizer::AUTOMATIC, "automatic" } };
+
+  std::cout << "frames: " << frames << "\n"
+            << "type\tcells\t\tpath\t\tCPU [ms]\tGPU [ms]\tGPU p99 [ms]\n";
+
+  for(const unsigned int elements : sizes){
+    const std::vector<Visualizer::Ground2D> ground_2D{
+      synthetic_ground<Visualizer::Ground2D>(elements)};
+    compare(&core, &grounds, "Ground2D", ground_2D, elements, paths, frames);
+
+    std::vector<Visualizer::Ground3D> ground_3D{synthetic_ground<Visualizer::Ground3D>(elements)};
+    set_heights(&ground_3D);
+    compare(&core, &grounds, "Ground3D", ground_3D, elements, paths, frames);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+// Measures Toreo::PointIndex with synthetic clouds of 1M and 10M points (uniformly
+// distributed inside 200 x 200 x 10 meters): the build time, picking under random cursor
+// positions with a camera looking at the cloud from above, and the radius and box queries.
+//
+// usage: point_index [queries]
+
+#include "include/point_index.h"
+#include "include/types.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+  typedef std::chrono::steady_clock clock;
+
+  std::vector<Visualizer::pointXYZI> synthetic_cloud(const std::size_t size){
+    std::mt19937 generator(7u);
+    std::uniform_real_distribution<float> horizontal(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> vertical(-2.0f, 8.0f);
+    std::uniform_real_distribution<float> intensity(0.0f, 1.0f);
+
+    std::vector<Visualizer::pointXYZI> cloud(size);
+    for(Visualizer::pointXYZI &point : cloud){
+      point.x = horizontal(generator);
+      point.y = horizontal(generator);
+      point.z = vertical(generator);
+      point.intensity = intensity(generator);
+    }
+    return cloud;
+  }
+
+  // column major perspective (45 degrees, 16:9) * view from (0, 150, 150) to the origin,
+  // in OpenGL axes
+  void camera_matrix(float *mvp){
+    const float eye[3]{0.0f, 150.0f, 150.0f};
+    const float length{std::sqrt(eye[1] * eye[1] + eye[2] * eye[2])};
+    // forward = -eye / length, side = (1, 0, 0), up = side x forward
+    const float forward[3]{0.0f, -eye[1] / length, -eye[2] / length};
+    const float up[3]{0.0f, -forward[2], forward[1]};
+    const float view[16]{
+      1.0f, up[0], -forward[0], 0.0f,
+      0.0f, up[1], -forward[1], 0.0f,
+      0.0f, up[2], -forward[2], 0.0f,
+      0.0f, -(up[1] * eye[1] + up[2] * eye[2]),
+      forward[1] * eye[1] + forward[2] * eye[2], 1.0f };
+
+    const float near{0.1f}, far{1000.0f};
+    const float f{1.0f / std::tan(45.0f * 3.14159265f / 360.0f)};
+    const float projection[16]{
+      f / (16.0f / 9.0f), 0.0f, 0.0f, 0.0f,
+      0.0f, f, 0.0f, 0.0f,
+      0.0f, 0.0f, (far + near) / (near - far), -1.0f,
+      0.0f, 0.0f, 2.0f * far * near / (near - far), 0.0f };
+
+    for(int column = 0; column < 4; ++column)
+      for(int row = 0; row < 4; ++row){
+        mvp[column * 4 + row] = 0.0f;
+        for(int k = 0; k < 4; ++k)
+          mvp[column * 4 + row] += projection[k * 4 + row] * view[column * 4 + k];
+      }
+  }
+
+  // returns milliseconds per call
+  double build(const std::vector<Visualizer::pointXYZI> &cloud, Toreo::PointIndex *index){
+    const clock::time_point start{clock::now()};
+    index->build(cloud.data(), cloud.size(), sizeof(Visualizer::pointXYZI));
+    index->wait();
+    const std::chrono::duration<double, std::milli> elapsed{clock::now() - start};
+    return elapsed.count();
+  }
+
+  double pick(Toreo::PointIndex *index, const unsigned int queries, unsigned int *hits){
+    float mvp[16];
+    camera_matrix(mvp);
+    std::mt19937 generator(11u);
+    std::uniform_real_distribution<float> cursor(-0.8f, 0.8f);
+
+    *hits = 0u;
+    const clock::time_point start{clock::now()};
+    for(unsigned int i = 0; i < queries; ++i){
+      std::uint32_t point;
+      if(index->nearest(mvp, cursor(generator), cursor(generator), 0.01f, &point)) ++*hits;
+    }
+    const std::chrono::duration<double, std::milli> elapsed{clock::now() - start};
+    return elapsed.count() / queries;
+  }
+
+  double in_radius(Toreo::PointIndex *index, const float radius, const unsigned int queries,
+                   std::size_t *found){
+    std::mt19937 generator(13u);
+    std::uniform_real_distribution<float> horizontal(-90.0f, 90.0f);
+    std::vector<std::uint32_t> indices;
+
+    *found = 0u;
+    const clock::time_point start{clock::now()};
+    for(unsigned int i = 0; i < queries; ++i){
+      const float center[3]{horizontal(generator), horizontal(generator), 3.0f};
+      *found += index->in_radius(center, radius, &indices);
+    }
+    const std::chrono::duration<double, std::milli> elapsed{clock::now() - start};
+    *found /= queries;
+    return elapsed.count() / queries;
+  }
+
+  double in_box(Toreo::PointIndex *index, const float size, const unsigned int queries,
+                std::size_t *found){
+    std::mt19937 generator(17u);
+    std::uniform_real_distribution<float> horizontal(-90.0f, 90.0f);
+    std::vector<std::uint32_t> indices;
+
+    *found = 0u;
+    const clock::time_point start{clock::now()};
+    for(unsigned int i = 0; i < queries; ++i){
+      const float minimum[3]{horizontal(generator), horizontal(generator), -2.0f};
+      const float maximum[3]{minimum[0] + size, minimum[1] + size, 8.0f};
+      *found += index->in_box(minimum, maximum, &indices);
+    }
+    const std::chrono::duration<double, std::milli> elapsed{clock::now() - start};
+    *found /= queries;
+    return elapsed.count() / queries;
+  }
+}
+
+int main(int argc, char **argv){
+  const unsigned int queries{argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : 1000u};
+  const std::size_t sizes[]{1000000u, 10000000u};
+
+  std::cout << "queries: " << queries << "\n"
+            << "points\t\toperation\t\tresult\t\ttime [ms]\n";
+
+  for(const std::size_t size : sizes){
+    const std::vector<Visualizer::pointXYZI> cloud{synthetic_cloud(size)};
+    Toreo::PointIndex index;
+
+    const double built{build(cloud, &index)};
+    std::cout << size << "\tbuild\t\t\t" << index.size() << "\t\t" << built << "\n";
+
+    unsigned int hits{0u};
+    const double picked{pick(&index, queries, &hits)};
+    std::cout << size << "\tpick\t\t\t" << hits << " hits\t" << picked << "\n";
+
+    std::size_t found{0u};
+    const double radius{in_radius(&index, 1.0f, queries, &found)};
+    std::cout << size << "\tradius 1 m\t\t" << found << "\t\t" << radius << "\n";
+
+    const double box{in_box(&index, 5.0f, queries, &found)};
+    std::cout << size << "\tbox 5 x 5 m\t\t" << found << "\t\t" << box << "\n";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+// Compares the cost of calling the drawing functions through boost::signals2 (the old
+// Core::paint() and manager dispatch) against the flat render-pass vector.
+//
+// usage: render_pass_dispatch [frames]
+
+#include "include/types.h"
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/signals2.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // something the compiler can not remove, similar to a very small draw_all()
+  struct Counter{
+    volatile unsigned long calls = 0;
+    void draw(){ ++calls; }
+  };
+
+  typedef std::chrono::steady_clock clock;
+
+  double signal_dispatch(const unsigned int passes, const unsigned int frames,
+                         Counter *counter){
+    std::vector<boost::signals2::signal<void ()> > signals(9);
+    std::vector<boost::signals2::connection> connections;
+
+    for(unsigned int i = 0; i < passes; ++i)
+      connections.push_back(signals[i % 9].connect(boost::bind(&Counter::draw, counter)));
+
+    const clock::time_point start{clock::now()};
+    for(unsigned int frame = 0; frame < frames; ++frame)
+      for(int i = 0; i < 9; ++i)
+        signals[i]();
+    const std::chrono::duration<double, std::nano> elapsed{clock::now() - start};
+
+    for(boost::signals2::connection &connection : connections)
+      connection.disconnect();
+    return elapsed.count() / frames;
+  }
+
+  double pass_dispatch(const unsigned int passes, const unsigned int frames,
+                       Counter *counter){
+    std::vector<Visualizer::RenderPass> render_passes;
+
+    // same sorted insertion as Core::add_render_pass()
+    for(unsigned int i = 0; i < passes; ++i){
+      Visualizer::RenderPass pass = { static_cast<Visualizer::Order>(i % 9), static_cast<int>(i),
+                                      boost::bind(&Counter::draw, counter) };
+      std::vector<Visualizer::RenderPass>::iterator position{render_passes.begin()};
+      while(position != render_passes.end() && position->order <= pass.order)
+        ++position;
+      render_passes.insert(position, pass);
+    }
+
+    const std::size_t size{render_passes.size()};
+    const clock::time_point start{clock::now()};
+    for(unsigned int frame = 0; frame < frames; ++frame){
+      std::size_t pass{0};
+      for(int i = 0; i < 9; ++i)
+        while(pass < size && render_passes[pass].order == i)
+          render_passes[pass++].draw();
+    }
+    const std::chrono::duration<double, std::nano> elapsed{clock::now() - start};
+
+    return elapsed.count() / frames;
+  }
+}
+
+int main(int argc, char **argv){
+  const unsigned int frames{argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : 20000u};
+  const unsigned int passes[]{9u, 64u, 256u, 1024u};
+  Counter counter;
+
+  std::cout << "frames: " << frames << "\n"
+            << "passes\tsignals2 [ns/frame]\trender passes [ns/frame]\tspeed-up\n";
+
+  for(const unsigned int quantity : passes){
+    const double signal{signal_dispatch(quantity, frames, &counter)};
+    const double flat{pass_dispatch(quantity, frames, &counter)};
+    std::cout << quantity << "\t" << signal << "\t\t" << flat << "\t\t\t"
+              << signal / flat << "x\n";
+  }
+  return counter.calls > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+// Measures the downsampling speed of Toreo::VoxelGrid with synthetic clouds of 1M and 10M
+// points (uniformly distributed inside 200 x 200 x 10 meters) using one thread and all the
+// cores, and the random subset for comparison.
+//
+// usage: voxel_grid [repetitions]
+
+#include "include/types.h"
+#include "include/voxel_grid.h"
+
+#include <boost/thread.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+  typedef std::chrono::steady_clock clock;
+
+  std::vector<Visualizer::pointXYZI> synthetic_cloud(const std::size_t size){
+    std::mt19937 generator(7u);
+    std::uniform_real_distribution<float> horizontal(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> vertical(-2.0f, 8.0f);
+    std::uniform_real_distribution<float> intensity(0.0f, 1.0f);
+
+    std::vector<Visualizer::pointXYZI> cloud(size);
+    for(Visualizer::pointXYZI &point : cloud){
+      point.x = horizontal(generator);
+      point.y = horizontal(generator);
+      point.z = vertical(generator);
+      point.intensity = intensity(generator);
+    }
+    return cloud;
+  }
+
+  // returns millions of input points per second and the number of output points
+  double voxel_grid(const std::vector<Visualizer::pointXYZI> &cloud, const float leaf_size,
+                    const unsigned int threads, const unsigned int repetitions,
+                    std::size_t *output_size){
+    Toreo::VoxelGrid grid(leaf_size, threads);
+    std::vector<unsigned char> output;
+
+    const clock::time_point start{clock::now()};
+    for(unsigned int i = 0; i < repetitions; ++i)
+      *output_size = grid.filter(cloud.data(), cloud.size(), sizeof(Visualizer::pointXYZI),
+                                 &output);
+    const std::chrono::duration<double> elapsed{clock::now() - start};
+
+    return cloud.size() * repetitions / elapsed.count() / 1.0e6;
+  }
+
+  double random_subset(const std::vector<Visualizer::pointXYZI> &cloud, const float fraction,
+                       const unsigned int repetitions, std::size_t *output_size){
+    Toreo::VoxelGrid grid;
+    std::vector<unsigned char> output;
+
+    const clock::time_point start{clock::now()};
+    for(unsigned int i = 0; i < repetitions; ++i)
+      *output_size = grid.random_subset(cloud.data(), cloud.size(),
+                                        sizeof(Visualizer::pointXYZI), fraction, &output);
+    const std::chrono::duration<double> elapsed{clock::now() - start};
+
+    return cloud.size() * repetitions / elapsed.count() / 1.0e6;
+  }
+}
+
+int main(int argc, char **argv){
+  const unsigned int repetitions{argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : 5u};
+  const unsigned int cores{std::max(boost::thread::hardware_concurrency(), 1u)};
+  const std::size_t sizes[]{1000000u, 10000000u};
+  const float leaf_sizes[]{0.05f, 0.2f, 1.0f};
+
+  std::cout << "repetitions: " << repetitions << ", cores: " << cores << "\n"
+            << "points\tmethod\t\t\toutput\t\t1 thread [Mpts/s]\t" << cores
+            << " threads [Mpts/s]\n";
+
+  for(const std::size_t size : sizes){
+    const std::vector<Visualizer::pointXYZI> cloud{synthetic_cloud(size)};
+    std::size_t output{0u};
+
+    for(const float leaf_size : leaf_sizes){
+      const double single{voxel_grid(cloud, leaf_size, 1u, repetitions, &output)};
+      const double multiple{voxel_grid(cloud, leaf_size, cores, repetitions, &output)};
+      std::cout << size << "\tvoxel grid " << leaf_size << " m\t" << output << "\t\t"
+                << single << "\t\t\t" << multiple << "\n";
+    }
+
+    const double subset{random_subset(cloud, 0.25f, repetitions, &output)};
+    std::cout << size << "\trandom subset 25%\t" << output << "\t\t" << subset << "\t\t\t-\n";
+  }
+  return EXIT_SUCCESS;
+}
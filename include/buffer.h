@@ -3,6 +3,8 @@
 
 #include "glad/glad.h"
 
+#include "include/gl_state.h"
+
 namespace Toreo {
   class Buffer
   {
@@ -25,7 +27,7 @@ namespace Toreo {
         glDeleteBuffers(1, &array_buffer_);
       if(has_element_buffer_)
         glDeleteBuffers(1, &element_buffer_);
-      glDeleteVertexArrays(1, &vertex_array_);
+      GLState::delete_vertex_arrays(1, &vertex_array_);
     }
     // creates a new GL_VERTEX_ARRAY that could contain a GL_ARRAY_BUFFER and GL_ELEMENT_BUFFER
     // it also binds this GL_VERTEX_ARRAY
@@ -37,30 +39,34 @@ namespace Toreo {
     }
     // binds this GL_VERTEX_ARRAY_OBJECT or create and bind it if has not been created yet
     void vertex_bind(){
-      if(is_created_)
-        glBindVertexArray(vertex_array_);
-      else
+      if(!is_created_)
         create();
+      GLState::bind_vertex_array(vertex_array_);
     }
-    // Releases this GL_VERTEX_ARRAY_OBJECT
+    // Releases this GL_VERTEX_ARRAY_OBJECT, the unbinding is deferred: the array stays bound
+    // until another one is bound (this avoids re-binding the same array for consecutive
+    // elements), every element buffer bind of this class binds its own array first
     void vertex_release(){
-      glBindVertexArray(0);
     }
     // binds this GL_VERTEX_BUFFER_OBJECT
     void buffer_bind(){
       if(is_created_){
         if(has_array_buffer_)
           glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
-        if(has_element_buffer_)
+        if(has_element_buffer_){
+          GLState::bind_vertex_array(vertex_array_);
           glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_);
+        }
       }
     }
     // Releases this GL_VERTEX_BUFFER_OBJECT
     void buffer_release(){
       if(has_array_buffer_)
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-      if(has_element_buffer_)
+      if(has_element_buffer_){
+        GLState::bind_vertex_array(vertex_array_);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+      }
     }
     void divisor(const GLuint attribute_id, const GLuint divisor){
       glVertexAttribDivisor(attribute_id, divisor);
@@ -69,7 +75,8 @@ namespace Toreo {
     // also creates a new GL_ARRAY_BUFFER if has not been created yet
     // and allocates its buffered data
     // it also binds this GL_VERTEX_ARRAY and GL_ARRAY_BUFFER
-    void allocate_array(const GLvoid *data, GLsizei size_in_bytes, GLenum ussage = GL_STATIC_DRAW){
+    void allocate_array(const GLvoid *data, GLsizeiptr size_in_bytes,
+                        GLenum ussage = GL_STATIC_DRAW){
       if(!has_array_buffer_){
         glGenBuffers(1, &array_buffer_);
         has_array_buffer_ = true;
@@ -77,6 +84,12 @@ namespace Toreo {
       glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
       glBufferData(GL_ARRAY_BUFFER, size_in_bytes, data, ussage);
     }
+    // writes size_in_bytes of data at offset_in_bytes of the GL_ARRAY_BUFFER,
+    // it must be already allocated; it also binds the GL_ARRAY_BUFFER
+    void update_array(const GLvoid *data, GLintptr offset_in_bytes, GLsizeiptr size_in_bytes){
+      glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
+      glBufferSubData(GL_ARRAY_BUFFER, offset_in_bytes, size_in_bytes, data);
+    }
     // creates a new GL_VERTEX_ARRAY if is not yet created
     // also creates a new GL_ELEMENT_BUFFER if has not been created yet
     // and allocates its buffered data
@@ -86,6 +99,7 @@ namespace Toreo {
         glGenBuffers(1, &element_buffer_);
         has_element_buffer_ = true;
       }
+      if(is_created_) GLState::bind_vertex_array(vertex_array_);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_);
       glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_in_bytes, data, ussage);
     }
@@ -115,12 +129,17 @@ namespace Toreo {
     // Returns the size in bytes of the element array buffer
     GLint size_element(){
       GLint size{0};
-      if(has_array_buffer_){
+      if(has_element_buffer_){
+        GLState::bind_vertex_array(vertex_array_);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer_);
         glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
       }
       return size;
     }
+    // returns the GL_ARRAY_BUFFER id, 0 if it was not allocated yet
+    const GLuint array_id(){
+      return has_array_buffer_ ? array_buffer_ : 0;
+    }
 
   private:
     GLuint vertex_array_, array_buffer_, element_buffer_;
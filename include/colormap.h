@@ -0,0 +1,93 @@
+#ifndef TORERO_COLORMAP_H
+#define TORERO_COLORMAP_H
+
+#include "glad/glad.h"
+
+#include "include/gl_state.h"
+
+#include "algebraica/algebraica.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Toreo {
+  // color palette baked into a 1D lookup texture of 256 texels: the palette is interpolated
+  // once when it changes instead of for every vertex, the shaders read it with:
+  //   texture(u_colormap, value * 255.0 / 256.0 + 0.5 / 256.0)   value = 0 -> 1
+  // and the first color of the palette with texelFetch(u_colormap, 0, 0)
+  class Colormap
+  {
+  public:
+    static const GLsizei size_ = 256;
+
+    // the texture is created with the palette, the OpenGL context must exist
+    Colormap(const algebraica::vec3f *colors = nullptr, const unsigned int quantity = 0u) :
+      texture_(0)
+    {
+      glGenTextures(1, &texture_);
+      GLState::active_texture(GL_TEXTURE0);
+      GLState::bind_texture(GL_TEXTURE_1D, texture_);
+      glTexStorage1D(GL_TEXTURE_1D, 1, GL_RGBA8, size_);
+      glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      set(colors, quantity);
+    }
+    // frees the texture, the OpenGL context must still exist
+    ~Colormap(){
+      GLState::delete_textures(1, &texture_);
+    }
+    Colormap(const Colormap&) = delete;
+    Colormap &operator=(const Colormap&) = delete;
+
+    // colors go from 0 to 1, the values between two consecutive colors are interpolated
+    // linearly (the same as the old per vertex palette); without colors it is white
+    void set(const algebraica::vec3f *colors, const unsigned int quantity){
+      unsigned char texels[size_ * 4];
+      bake(colors, quantity, texels);
+
+      GLState::active_texture(GL_TEXTURE0);
+      GLState::bind_texture(GL_TEXTURE_1D, texture_);
+      glTexSubImage1D(GL_TEXTURE_1D, 0, 0, size_, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    }
+    // writes the size_ RGBA texels of the palette into texels
+    static void bake(const algebraica::vec3f *colors, const unsigned int quantity,
+                     unsigned char *texels){
+      for(GLsizei i = 0; i < size_; ++i){
+        algebraica::vec3f color(1.0f, 1.0f, 1.0f);
+
+        if(colors && quantity > 0u){
+          const float position{static_cast<float>(i) / (size_ - 1) * (quantity - 1u)};
+          const unsigned int first{std::min(static_cast<unsigned int>(position), quantity - 1u)};
+          const unsigned int second{std::min(first + 1u, quantity - 1u)};
+          const float fraction{position - first};
+          color = (colors[second] - colors[first]) * fraction + colors[first];
+        }
+
+        texels[i * 4]     = channel(color.x);
+        texels[i * 4 + 1] = channel(color.y);
+        texels[i * 4 + 2] = channel(color.z);
+        texels[i * 4 + 3] = 255u;
+      }
+    }
+    // binds the texture to the texture unit (GL_TEXTURE0 + unit)
+    void bind(const GLenum unit = 0u){
+      GLState::active_texture(GL_TEXTURE0 + unit);
+      GLState::bind_texture(GL_TEXTURE_1D, texture_);
+    }
+    // returns the texture id
+    const GLuint id(){
+      return texture_;
+    }
+
+  private:
+    static unsigned char channel(const float value){
+      return static_cast<unsigned char>(std::lround(std::min(std::max(value, 0.0f), 1.0f) *
+                                                    255.0f));
+    }
+
+    GLuint texture_;
+  };
+}
+
+#endif // TORERO_COLORMAP_H
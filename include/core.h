@@ -7,21 +7,30 @@
 
 #include "include/camera.h"
 #include "include/definitions.h"
+#include "include/frame_profiler.h"
+#include "include/framebuffer.h"
+#include "include/gl_extensions.h"
+#include "include/gl_state.h"
 #include "include/types.h"
 
 // linear mathematical functions
 #include "algebraica/algebraica.h"
 // standard
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/signals2.hpp>
+#include <boost/thread.hpp>
 
 void callback_resize(GLFWwindow *window, int width, int height);
 void callback_mouse_click(GLFWwindow *window, int button, int action, int mods);
 void callback_mouse_move(GLFWwindow *window, double xpos, double ypos);
 void callback_mouse_scroll(GLFWwindow *window, double xoffset, double yoffset);
+void callback_refresh(GLFWwindow *window);
 
 namespace Toreo {
   class Core
@@ -35,13 +44,20 @@ namespace Toreo {
      * **Arguments**
      * {int} argc = Number of arguments.
      * {char**} argv = Array containing the character string of all arguments.
+     * {const bool} headless = If `true`, no window will be shown; everything is drawn into
+     * an offscreen framebuffer that you could render with `render_frame()` and read with
+     * `read_frame()` or `save_frame()`. An EGL surfaceless context is used when torero was
+     * compiled with EGL (it also works with Mesa's llvmpipe), otherwise a hidden GLFW window.
+     * {const int} width = Width in pixels of the window or the offscreen framebuffer.
+     * {const int} height = Height in pixels of the window or the offscreen framebuffer.
      *
      * **Errors**
-     * This will throw an error if GLFW or GLAD libraries were not correctly loaded/created.
-     * In this case a message will be displayed at the Terminal/console.
+     * This will throw an error if GLFW, EGL or GLAD libraries were not correctly
+     * loaded/created. In this case a message will be displayed at the Terminal/console.
      *
      */
-    explicit Core(int argc, char **argv);
+    explicit Core(int argc, char **argv, const bool headless = false,
+                  const int width = DEFAULT_WIDTH, const int height = DEFAULT_HEIGHT);
     virtual ~Core();
 
     // ------------------------------------------------------------------------------------ //
@@ -236,6 +252,28 @@ namespace Toreo {
      *
      */
     const algebraica::vec3f &camera_position();
+    /*
+     * ### Obtaining the camera's uniform buffer
+     *
+     * All the camera matrices and the camera position are stored in a single uniform
+     * buffer object that is bound to `CAMERA_UNIFORM_BINDING`, it is updated only once
+     * every time the camera changes. Shaders use it by declaring the uniform block:
+     *
+     * ```glsl
+     * layout(std140, binding = 0) uniform Camera{
+     *   mat4 u_pv;
+     *   mat4 u_view;
+     *   mat4 u_projection;
+     *   mat4 u_static_pv;
+     *   vec3 u_camera_position;
+     * };
+     * ```
+     *
+     * **Returns**
+     * {const GLuint} OpenGL id of the uniform buffer, 0 if the window was not created.
+     *
+     */
+    const GLuint camera_uniform_buffer();
 
     // ------------------------------------------------------------------------------------ //
     // ----------------------------- SCENE's FRAME MATRICES ------------------------------- //
@@ -321,6 +359,26 @@ namespace Toreo {
      *
      */
     void set_window_size(const int width, const int height);
+    /*
+     * ### Obtaining the window and frame sizes
+     *
+     * The window size is measured in screen coordinates (the same as the mouse position)
+     * and the frame size in pixels of the framebuffer (the viewport), they are different in
+     * HiDPI monitors. Both values are cached, it could be called from any thread.
+     *
+     * **Arguments**
+     * {int*} window_width = Address where the window's width will be written, could be
+     * `nullptr`.
+     * {int*} window_height = Address where the window's height will be written, could be
+     * `nullptr`.
+     * {int*} frame_width = Address where the framebuffer's width will be written, could be
+     * `nullptr`.
+     * {int*} frame_height = Address where the framebuffer's height will be written, could be
+     * `nullptr`.
+     *
+     */
+    void window_size(int *window_width, int *window_height,
+                     int *frame_width = nullptr, int *frame_height = nullptr);
     /*
      * ### Window position
      *
@@ -392,6 +450,31 @@ namespace Toreo {
      *
      */
     void redraw_screen();
+    /*
+     * ### Requesting a new frame
+     *
+     * The screen is only drawn again when something has changed, call this function after
+     * you modify anything that is drawn (the managers already do it when you update, move,
+     * hide or delete their elements, and the camera when it moves). It is safe to call
+     * this from any thread; it wakes up `execute()` or the render thread.
+     *
+     * The managers keep only the address of the transformation matrices you give them
+     * (`set_transformation_matrix()` and `add()`), they can not know when you modify the
+     * values of a matrix: call this function afterwards (`VehicleManager::update()` already
+     * calls it for its frames).
+     *
+     */
+    void request_redraw();
+    /*
+     * ### Continuous drawing for animations
+     *
+     * While at least one animation is running the screen is drawn every frame even if
+     * nothing requested it. Every call to `start_animation()` must be followed by one call
+     * to `stop_animation()` when the animation ends.
+     *
+     */
+    void start_animation();
+    void stop_animation();
     /*
      * ### Restarting the screen viewport
      *
@@ -500,10 +583,13 @@ namespace Toreo {
      * {const bool} infinite_loop = if set to `true` it will maintain the window open
      * until close event.
      *
+     * In headless mode there is no window to maintain open, a single frame is rendered
+     * into the offscreen framebuffer and the function returns immediately.
+     *
      * **Errors**
      * This will return the type of error if the window was not created properly;
-     * `EXIT_SUCCESS`, `GLFW_NOT_LOADED`, `WINDOW_NOT_LOADED`, `GLAD_NOT_LOADED`
-     * or `EXISTING_WINDOW`.
+     * `EXIT_SUCCESS`, `GLFW_NOT_LOADED`, `WINDOW_NOT_LOADED`, `GLAD_NOT_LOADED`,
+     * `EXISTING_WINDOW`, `EGL_NOT_LOADED` or `FRAMEBUFFER_NOT_LOADED`.
      *
      */
     int execute(const bool infinite_loop = true);
@@ -535,6 +621,156 @@ namespace Toreo {
     int execute(const int width, const int height, const std::string title = "Torero",
                 const bool full_screen = true, const bool maximized = false,
                 const bool infinite_loop = true);
+    /*
+     * ### Execute window with a dedicated render thread
+     *
+     * Draws the scene continuously in a new thread owned by this *class* while the calling
+     * thread (which must be the main thread) processes the window events; it returns when
+     * the window is closed. Sensor threads can then publish their data through
+     * `TripleBuffer` and the managers' `subscribe()` while a frame is being drawn.
+     * **Note:** OpenGL functions only work in the render thread, use `post()` to call any
+     * function of this or the manager *classes* from other threads.
+     *
+     * **Errors**
+     * This will return the type of error if the window was not created properly;
+     * `EXIT_SUCCESS`, `GLFW_NOT_LOADED`, `WINDOW_NOT_LOADED`, `GLAD_NOT_LOADED`,
+     * `EXISTING_WINDOW`, `EGL_NOT_LOADED` or `FRAMEBUFFER_NOT_LOADED`.
+     *
+     */
+    int execute_concurrently();
+    /*
+     * ### Running a function in the render thread
+     *
+     * The function `task` is stored and called (in the same order they were posted) before
+     * the next frame is drawn; it is safe to call this from any thread.
+     *
+     * **Arguments**
+     * {const boost::function<void ()>} task = Function to execute, use `boost::bind` to
+     * include its arguments.
+     *
+     */
+    void post(const boost::function<void ()> task);
+
+    // ------------------------------------------------------------------------------------ //
+    // ------------------------------- OFFSCREEN RENDERING -------------------------------- //
+    // ------------------------------------------------------------------------------------ //
+    /*
+     * ### Checking if the visualizer is headless
+     *
+     * **Returns**
+     * {bool} Returns `true` if this *class* was created in headless mode.
+     *
+     */
+    bool is_headless() const;
+    /*
+     * ### Offscreen framebuffer size
+     *
+     * Changes the resolution of the offscreen framebuffer, the camera's aspect ratio is
+     * also updated. Only used in headless mode.
+     *
+     * **Arguments**
+     * {const int} width = Width in pixels of the rendered frame.
+     * {const int} height = Height in pixels of the rendered frame.
+     *
+     * **Returns**
+     * {bool} Returns `false` if it is not headless or the framebuffer could not be created.
+     *
+     */
+    bool set_frame_size(const int width, const int height);
+    /*
+     * ### Rendering a single frame
+     *
+     * Draws all the elements (the same as a window repaint) into the offscreen framebuffer,
+     * use this function to batch-render recorded data or to benchmark the drawing without
+     * a display server.
+     *
+     * **Returns**
+     * {bool} Returns `false` if it is not headless or the context was not created properly.
+     *
+     */
+    bool render_frame();
+    /*
+     * ### Reading the last rendered frame
+     *
+     * Copies the pixels of the last rendered frame as 8 bit RGBA, the first row is the top
+     * of the image.
+     *
+     * **Arguments**
+     * {std::vector<unsigned char>*} pixels = Address to the vector where the pixels will be
+     * copied, it is resized to `width * height * 4`.
+     * {int*} width = Address where the width in pixels will be written, could be `nullptr`.
+     * {int*} height = Address where the height in pixels will be written, could be `nullptr`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if it is not headless or the context was not created properly.
+     *
+     */
+    bool read_frame(std::vector<unsigned char> *pixels,
+                    int *width = nullptr, int *height = nullptr);
+    /*
+     * ### Saving the last rendered frame
+     *
+     * Writes the last rendered frame into a PNG image.
+     *
+     * **Arguments**
+     * {const std::string} path = Path to the PNG file that will be created.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the frame could not be read or the image was not written.
+     *
+     */
+    bool save_frame(const std::string path);
+
+    // ------------------------------------------------------------------------------------ //
+    // --------------------------------- FRAME STATISTICS --------------------------------- //
+    // ------------------------------------------------------------------------------------ //
+    /*
+     * ### Enabling the frame profiler
+     *
+     * Measures the CPU time and the GPU time (`GL_TIME_ELAPSED` queries) that every drawing
+     * pass (see `Visualizer::Order`) takes. The GPU results are collected some frames later
+     * when they are ready, so the drawing is never stalled.
+     *
+     * **Arguments**
+     * {const bool} enable = Set this to `true` to start profiling or `false` to stop it.
+     * {const unsigned int} history = Number of frames used to calculate the statistics.
+     *
+     */
+    void enable_profiling(const bool enable = true, const unsigned int history = 240u);
+    /*
+     * ### Obtaining the timing of a drawing pass
+     *
+     * Returns the minimum, average and 99th percentile of CPU and GPU times in milliseconds
+     * of the last `history` frames.
+     *
+     * **Arguments**
+     * {Visualizer::Order} object = *Class manager* name.
+     *
+     * **Returns**
+     * {Visualizer::FrameTiming} All values are zero if profiling is not enabled.
+     *
+     */
+    Visualizer::FrameTiming frame_statistics(Visualizer::Order object);
+    /*
+     * ### Restarting the frame statistics
+     *
+     * Removes all the collected samples, useful after loading new data.
+     *
+     */
+    void reset_frame_statistics();
+    /*
+     * ### Obtaining the OpenGL state changes
+     *
+     * Programs, vertex arrays, textures, capabilities, blending and depth state are bound
+     * through a state cache (see `GLState`) that skips the calls that would not change
+     * anything. This returns how many calls reached the driver and how many were skipped
+     * during the last frame.
+     *
+     * **Returns**
+     * {Visualizer::StateChanges} Issued and skipped calls of the last frame.
+     *
+     */
+    Visualizer::StateChanges state_statistics();
 
     // ------------------------------------------------------------------------------------ //
     // ------------------------------ OPENGL TEXTURE MANAGER ------------------------------ //
@@ -574,6 +810,35 @@ namespace Toreo {
      *
      */
     boost::signals2::signal<void ()> *syncronize(Visualizer::Order object);
+    /*
+     * ### Registering a drawing pass
+     *
+     * The function `pass` is called every time the screen is drawn, all the passes are
+     * sorted by `order` (the passes with the same order are called in the same sequence they
+     * were added) and before the signal `syncronize(order)`. Unlike signals, the passes are
+     * stored in a plain vector and no lock is taken while drawing, therefore, passes can
+     * only be added or removed from the thread that draws (see `post()`), never while drawing.
+     *
+     * **Arguments**
+     * {const Visualizer::Order} order = *Class manager* name, defines when it is drawn.
+     * {const boost::function<void ()>} pass = Drawing function.
+     *
+     * **Returns**
+     * {int} Identification number of the pass, use it to remove it.
+     *
+     */
+    int add_render_pass(const Visualizer::Order order, const boost::function<void ()> pass);
+    /*
+     * ### Removing a drawing pass
+     *
+     * **Arguments**
+     * {const int} id = Identification number returned by `add_render_pass()`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the pass with **id** was **not** found.
+     *
+     */
+    bool remove_render_pass(const int id);
     /*
      * ### Signal triggered by camera changes
      *
@@ -612,6 +877,7 @@ namespace Toreo {
     static boost::signals2::signal<void (int, int)> signal_mouse_click;
     static boost::signals2::signal<void (double, double)> signal_mouse_move;
     static boost::signals2::signal<void (double)> signal_mouse_scroll;
+    static boost::signals2::signal<void ()> signal_window_refresh;
 
     // ------------------------------------------------------------------------------------ //
     // --------------------------------------- SLOTS -------------------------------------- //
@@ -638,21 +904,56 @@ namespace Toreo {
     virtual void resize(const int width, const int height);
 
   private:
+    void event_resize(const int width, const int height);
+    void event_resized(const int width, const int height,
+                       const int window_width, const int window_height);
     void event_mouse_click(int button, int action);
+    void event_mouse_clicked(const int button, const int action,
+                             const double xpos, const double ypos);
     void event_mouse_move(double xpos, double ypos);
     void event_mouse_scroll(double yoffset);
 
+    // posts the task if the caller is not the render thread, returns false if it was not
+    bool defer(const boost::function<void ()> &task);
+    void run_tasks();
+    void render_loop();
+
     void updated_camera();
+    void update_camera_buffer();
     void load_window_icon();
 
+    bool create_window();
+    bool create_headless_context();
+    bool create_egl_context();
+    void destroy_egl_context();
+
     int argc_;
     char **argv_;
     GLFWwindow *window_;
+    bool headless_;
+    // EGL handles, stored as void* to avoid including EGL's headers (and its X11 macros)
+    void *egl_display_, *egl_context_;
+    Framebuffer *framebuffer_;
+    FrameProfiler *profiler_;
+    // shared camera data for all the shaders (CAMERA_UNIFORM_BINDING)
+    GLuint camera_buffer_;
+    boost::thread *render_thread_;
+    std::atomic<bool> is_rendering_, has_tasks_;
+    boost::mutex tasks_mutex_;
+    std::vector<boost::function<void ()> > tasks_;
     int width_, height_, half_height_, position_x_, position_y_;
+    int window_width_, window_height_;
     int error_log_, error_;
     bool is_left_click_, is_right_click_, is_scroll_click_;
     int old_x_, old_y_;
-    bool is_inversed_, has_changed_;
+    bool is_inversed_;
+    // the scene must be drawn again; modified by any thread
+    std::atomic<bool> has_changed_;
+    // the camera's uniform buffer must be updated before the next frame
+    std::atomic<bool> camera_changed_;
+    std::atomic<int> animations_;
+    boost::mutex redraw_mutex_;
+    boost::condition_variable redraw_condition_;
 
     GLfloat max_filtering_;
     algebraica::mat4f identity_matrix_;
@@ -662,6 +963,9 @@ namespace Toreo {
     // signals
     boost::signals2::signal<void ()> signal_updated_camera_, signal_updated_screen_;
     std::vector<boost::signals2::signal<void ()> > signal_draw_;
+    // sorted by order
+    std::vector<Visualizer::RenderPass> render_passes_;
+    int next_render_pass_;
   };
 }
 
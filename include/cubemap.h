@@ -6,6 +6,7 @@
 
 #include "include/buffer.h"
 #include "include/definitions.h"
+#include "include/gl_state.h"
 #include "include/shader.h"
 #include "include/types.h"
 
@@ -10,10 +10,19 @@
 #define WINDOW_NOT_LOADED     -2
 #define GLAD_NOT_LOADED       -3
 #define EXISTING_WINDOW       -4
+#define EGL_NOT_LOADED        -5
+#define FRAMEBUFFER_NOT_LOADED -6
 
 #define DEFAULT_WIDTH       1500
 #define DEFAULT_HEIGHT      800
 
+// ------------------------------------------------------------------------------------ //
+// ------------------------------ Uniform buffer bindings ----------------------------- //
+// ------------------------------------------------------------------------------------ //
+
+// binding point of the camera's uniform block (see "layout(binding = 0) uniform Camera")
+#define CAMERA_UNIFORM_BINDING 0
+
 // ------------------------------------------------------------------------------------ //
 // ---------------------------------- Point cloud types ------------------------------- //
 // ------------------------------------------------------------------------------------ //
@@ -22,6 +31,13 @@
 #define POINT_XYZI            1u
 #define POINT_XYZRGB          2u
 #define POINT_XYZRGBA         3u
+// quantized types (see Visualizer::pointXYZIq16 and Visualizer::pointXYZRGB8)
+#define POINT_XYZI_Q16        4u
+#define POINT_XYZRGB8         5u
+// fields described by a Visualizer::PointLayout (see PointCloudFile)
+#define POINT_LAYOUT          6u
+// bytes of a point cloud file mapped and uploaded at a time
+#define POINT_FILE_BLOCK      67108864u
 
 // ------------------------------------------------------------------------------------ //
 // ---------------------------- Physical values definitions --------------------------- //
@@ -0,0 +1,65 @@
+#ifndef TORERO_FRAME_PROFILER_H
+#define TORERO_FRAME_PROFILER_H
+
+#include "glad/glad.h"
+
+#include "include/types.h"
+
+#include <chrono>
+#include <vector>
+
+namespace Toreo {
+  class FrameProfiler
+  {
+  public:
+    // passes = number of drawing passes measured per frame
+    // history = number of frames kept to calculate the statistics
+    FrameProfiler(const unsigned int passes, const unsigned int history = 240u);
+    // the OpenGL context must still exist when destroying this object
+    ~FrameProfiler();
+
+    // call it before the first pass of every frame; it collects the GPU results
+    // of older frames that are already available without waiting for them
+    void begin_frame();
+    // starts measuring the pass with index "pass"
+    void begin(const unsigned int pass);
+    // stops measuring the pass with index "pass", passes must not overlap
+    void end(const unsigned int pass);
+
+    // returns minimum, average and 99th percentile of the last "history" frames
+    Visualizer::FrameTiming statistics(const unsigned int pass) const;
+    // removes all the collected samples
+    void reset();
+
+  private:
+    typedef std::chrono::steady_clock clock;
+
+    // rolling ring buffer of samples in milliseconds
+    struct Samples{
+      std::vector<float> values;
+      unsigned int next = 0u;
+      unsigned int size = 0u;
+    };
+
+    void add_sample(Samples *samples, const float value);
+    void collect(const unsigned int frame);
+    static void calculate(const Samples &samples, float *minimum,
+                          float *average, float *p99);
+
+    // GPU timer results arrive a few frames later, this is the number of frames
+    // whose queries could be in flight at the same time
+    static const unsigned int frames_in_flight_ = 4u;
+
+    const unsigned int passes_;
+    unsigned int frame_;
+    bool has_queries_;
+
+    std::vector<GLuint> queries_;
+    // if the queries of a frame were issued and not yet collected
+    std::vector<bool> pending_, issued_;
+    std::vector<clock::time_point> start_;
+    std::vector<Samples> cpu_, gpu_;
+  };
+}
+
+#endif // TORERO_FRAME_PROFILER_H
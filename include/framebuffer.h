@@ -0,0 +1,166 @@
+#ifndef TORERO_FRAMEBUFFER_H
+#define TORERO_FRAMEBUFFER_H
+
+#include "glad/glad.h"
+
+#include <string>
+#include <vector>
+
+namespace Toreo {
+  class Framebuffer
+  {
+  public:
+    // construct this Framebuffer object and creates a new GL_FRAMEBUFFER if width and height
+    // are bigger than zero, samples > 1 creates a multisampled framebuffer that is resolved
+    // into a single sampled one before reading it
+    Framebuffer(const GLsizei width = 0, const GLsizei height = 0, const GLsizei samples = 1) :
+      framebuffer_(0),
+      color_buffer_(0),
+      depth_buffer_(0),
+      resolve_framebuffer_(0),
+      resolve_buffer_(0),
+      width_(0),
+      height_(0),
+      samples_(samples),
+      is_created_(false),
+      error_log_("Framebuffer not created yet...\n----------\n")
+    {
+      if(width > 0 && height > 0)
+        create(width, height);
+    }
+    // frees the memory of its GL_FRAMEBUFFER and GL_RENDERBUFFER
+    ~Framebuffer(){
+      destroy();
+    }
+    // creates the framebuffer with a RGBA color attachment and a depth attachment,
+    // if the framebuffer was already created, it will be re-created with the new size
+    bool create(const GLsizei width, const GLsizei height){
+      destroy();
+      error_log_.clear();
+
+      width_ = width;
+      height_ = height;
+
+      glGenFramebuffers(1, &framebuffer_);
+      glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+
+      glGenRenderbuffers(1, &color_buffer_);
+      glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+      if(samples_ > 1)
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_RGBA8, width_, height_);
+      else
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+      glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                GL_RENDERBUFFER, color_buffer_);
+
+      glGenRenderbuffers(1, &depth_buffer_);
+      glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+      if(samples_ > 1)
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_DEPTH24_STENCIL8,
+                                         width_, height_);
+      else
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+      glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                GL_RENDERBUFFER, depth_buffer_);
+
+      is_created_ = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+      if(is_created_ && samples_ > 1){
+        glGenFramebuffers(1, &resolve_framebuffer_);
+        glBindFramebuffer(GL_FRAMEBUFFER, resolve_framebuffer_);
+
+        glGenRenderbuffers(1, &resolve_buffer_);
+        glBindRenderbuffer(GL_RENDERBUFFER, resolve_buffer_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                  GL_RENDERBUFFER, resolve_buffer_);
+
+        is_created_ = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+      }
+
+      if(!is_created_)
+        error_log_ += "The framebuffer is not complete...\n----------\n";
+
+      glBindRenderbuffer(GL_RENDERBUFFER, 0);
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      return is_created_;
+    }
+    // returns true if the framebuffer was properly created
+    bool is_created(){
+      return is_created_;
+    }
+    // if create() or is_created() are false, this will return the error's description
+    const std::string error_log(){
+      return error_log_;
+    }
+    // binds this GL_FRAMEBUFFER, everything drawn after this will be written into it
+    void bind(){
+      glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+      glViewport(0, 0, width_, height_);
+    }
+    // releases this GL_FRAMEBUFFER, the default framebuffer is bound again
+    void release(){
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    // copies the RGBA pixels of the framebuffer into pixels, the first row is the top
+    // of the image (the vertical flipping of OpenGL is already done)
+    bool read_pixels(std::vector<unsigned char> *pixels){
+      if(!is_created_ || !pixels) return false;
+
+      const std::size_t row_size{static_cast<std::size_t>(width_) * 4u};
+      std::vector<unsigned char> flipped(row_size * height_);
+
+      if(samples_ > 1){
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_framebuffer_);
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, resolve_framebuffer_);
+      }else
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, flipped.data());
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+      pixels->resize(flipped.size());
+      for(GLsizei row = 0; row < height_; ++row)
+        std::copy(flipped.begin() + (height_ - row - 1) * row_size,
+                  flipped.begin() + (height_ - row) * row_size,
+                  pixels->begin() + row * row_size);
+      return true;
+    }
+    // returns the framebuffer id
+    const GLuint id(){
+      return framebuffer_;
+    }
+    // returns the width in pixels
+    const GLsizei width(){
+      return width_;
+    }
+    // returns the height in pixels
+    const GLsizei height(){
+      return height_;
+    }
+
+  private:
+    void destroy(){
+      if(resolve_buffer_) glDeleteRenderbuffers(1, &resolve_buffer_);
+      if(resolve_framebuffer_) glDeleteFramebuffers(1, &resolve_framebuffer_);
+      if(depth_buffer_) glDeleteRenderbuffers(1, &depth_buffer_);
+      if(color_buffer_) glDeleteRenderbuffers(1, &color_buffer_);
+      if(framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+      framebuffer_ = color_buffer_ = depth_buffer_ = 0;
+      resolve_framebuffer_ = resolve_buffer_ = 0;
+      is_created_ = false;
+    }
+
+    GLuint framebuffer_, color_buffer_, depth_buffer_;
+    GLuint resolve_framebuffer_, resolve_buffer_;
+    GLsizei width_, height_, samples_;
+    bool is_created_;
+    std::string error_log_;
+  };
+}
+
+#endif // TORERO_FRAMEBUFFER_H
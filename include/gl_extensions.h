@@ -0,0 +1,85 @@
+#ifndef TORERO_GL_EXTENSIONS_H
+#define TORERO_GL_EXTENSIONS_H
+
+#include "glad/glad.h"
+
+#include <string>
+
+// GL 4.4 / ARB_buffer_storage tokens, missing in our GL 4.2 GLAD loader
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+// GL 4.3 / ARB_compute_shader and ARB_shader_storage_buffer_object tokens
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+
+namespace Toreo {
+  // OpenGL functions newer than the 4.2 core profile that GLAD loads, they are optional:
+  // Core loads them after creating the context and every user must check if they exist
+  // and keep a 4.2 fallback
+  class GLExtensions
+  {
+  public:
+    typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size,
+                                               const void *data, GLbitfield flags);
+    typedef void (APIENTRYP MultiDrawArraysIndirectProc)(GLenum mode, const void *indirect,
+                                                         GLsizei drawcount, GLsizei stride);
+    typedef void (APIENTRYP DispatchComputeProc)(GLuint groups_x, GLuint groups_y,
+                                                 GLuint groups_z);
+
+    // loads the functions with the same loader used for GLAD, returns false if
+    // none of them is supported
+    static bool load(GLADloadproc loader){
+      buffer_storage = nullptr;
+      multi_draw_arrays_indirect = nullptr;
+      dispatch_compute = nullptr;
+
+      if(version(4, 4) || has_extension("GL_ARB_buffer_storage"))
+        buffer_storage = reinterpret_cast<BufferStorageProc>(loader("glBufferStorage"));
+      if(version(4, 3) || has_extension("GL_ARB_multi_draw_indirect"))
+        multi_draw_arrays_indirect =
+            reinterpret_cast<MultiDrawArraysIndirectProc>(loader("glMultiDrawArraysIndirect"));
+      // the compute shaders read and write shader storage buffers
+      if(version(4, 3))
+        dispatch_compute = reinterpret_cast<DispatchComputeProc>(loader("glDispatchCompute"));
+
+      return buffer_storage != nullptr || multi_draw_arrays_indirect != nullptr ||
+             dispatch_compute != nullptr;
+    }
+    // returns true if the context version is equal or newer than major.minor
+    static bool version(const int major, const int minor){
+      return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+    }
+    // returns true if the driver exposes the extension "name"
+    static bool has_extension(const std::string &name){
+      GLint extensions{0};
+      glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+      for(GLint i = 0; i < extensions; ++i)
+        if(name == reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)))
+          return true;
+      return false;
+    }
+
+    // glBufferStorage(), immutable storage that could be persistently mapped
+    static BufferStorageProc buffer_storage;
+    // glMultiDrawArraysIndirect(), all the commands of a GL_DRAW_INDIRECT_BUFFER in one call
+    static MultiDrawArraysIndirectProc multi_draw_arrays_indirect;
+    // glDispatchCompute(), runs the current compute shader (GLSL 4.30)
+    static DispatchComputeProc dispatch_compute;
+  };
+}
+
+#endif // TORERO_GL_EXTENSIONS_H
@@ -0,0 +1,173 @@
+#ifndef TORERO_GL_STATE_H
+#define TORERO_GL_STATE_H
+
+#include "glad/glad.h"
+
+#include "include/types.h"
+
+namespace Toreo {
+  // central tracker of the OpenGL state that changes between draw calls (program, vertex
+  // array, texture units, capabilities, blending and depth), Shader, Buffer and Texture
+  // route their binds through it so redundant driver calls are skipped.
+  // All the functions must be called from the thread that owns the OpenGL context and
+  // every state change of the tracked objects must go through this class, otherwise
+  // invalidate() must be called before the next cached call.
+  class GLState
+  {
+  public:
+    // same as glUseProgram()
+    static void use_program(const GLuint program){
+      if(state_.program == program){
+        skip();
+        return;
+      }
+      glUseProgram(program);
+      state_.program = program;
+      issue();
+    }
+    // same as glBindVertexArray()
+    static void bind_vertex_array(const GLuint vertex_array){
+      if(state_.vertex_array == vertex_array){
+        skip();
+        return;
+      }
+      glBindVertexArray(vertex_array);
+      state_.vertex_array = vertex_array;
+      issue();
+    }
+    // same as glActiveTexture(), texture = GL_TEXTURE0 + unit
+    static void active_texture(const GLenum texture){
+      if(state_.active_texture == texture){
+        skip();
+        return;
+      }
+      glActiveTexture(texture);
+      state_.active_texture = texture;
+      issue();
+    }
+    // same as glBindTexture(), it binds the texture to the active texture unit;
+    // only GL_TEXTURE_1D, GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP of the first units are cached
+    static void bind_texture(const GLenum target, const GLuint texture){
+      GLuint *bound{bound_texture(target)};
+      if(bound && *bound == texture){
+        skip();
+        return;
+      }
+      glBindTexture(target, texture);
+      if(bound) *bound = texture;
+      issue();
+    }
+    // same as glEnable() and glDisable()
+    static void enable(const GLenum capability){
+      set_capability(capability, true);
+    }
+    static void disable(const GLenum capability){
+      set_capability(capability, false);
+    }
+    // same as glBlendFunc()
+    static void blend_func(const GLenum source, const GLenum destination){
+      if(state_.blend_source == source && state_.blend_destination == destination){
+        skip();
+        return;
+      }
+      glBlendFunc(source, destination);
+      state_.blend_source = source;
+      state_.blend_destination = destination;
+      issue();
+    }
+    // same as glDepthFunc()
+    static void depth_func(const GLenum function){
+      if(state_.depth_function == function){
+        skip();
+        return;
+      }
+      glDepthFunc(function);
+      state_.depth_function = function;
+      issue();
+    }
+    // same as glDepthMask()
+    static void depth_mask(const GLboolean flag){
+      if(state_.depth_mask == static_cast<GLint>(flag)){
+        skip();
+        return;
+      }
+      glDepthMask(flag);
+      state_.depth_mask = flag;
+      issue();
+    }
+
+    // same as glDeleteProgram(), glDeleteVertexArrays() and glDeleteTextures(), OpenGL
+    // unbinds the deleted objects so they are also removed from the cache
+    static void delete_program(const GLuint program){
+      glDeleteProgram(program);
+      if(state_.program == program) state_.program = unknown_;
+    }
+    static void delete_vertex_arrays(const GLsizei n, const GLuint *vertex_arrays){
+      glDeleteVertexArrays(n, vertex_arrays);
+      for(GLsizei i = 0; i < n; ++i)
+        if(state_.vertex_array == vertex_arrays[i]) state_.vertex_array = unknown_;
+    }
+    static void delete_textures(const GLsizei n, const GLuint *textures);
+
+    // forgets everything, the next call of every function will reach the driver;
+    // use it after changing the state directly with OpenGL or after creating a new context
+    static void invalidate();
+
+    // call it at the beginning of every frame, it stores the counters of the last frame
+    static void begin_frame();
+    // issued and skipped calls of the last complete frame
+    static Visualizer::StateChanges statistics();
+
+  private:
+    // value that never matches a real object, used for the state that is not known yet
+    static const GLuint unknown_ = ~0u;
+    static const unsigned int texture_units_ = 16u;
+    static const unsigned int capabilities_ = 8u;
+
+    struct State{
+      GLuint program = unknown_;
+      GLuint vertex_array = unknown_;
+      GLenum active_texture = unknown_;
+      GLuint texture_1d[texture_units_];
+      GLuint texture_2d[texture_units_];
+      GLuint texture_cube_map[texture_units_];
+      // tracked capabilities and their state: -1 = unknown, 0 = disabled, 1 = enabled
+      GLenum capability[capabilities_];
+      GLint enabled[capabilities_];
+      GLenum blend_source = unknown_;
+      GLenum blend_destination = unknown_;
+      GLenum depth_function = unknown_;
+      GLint depth_mask = -1;
+      unsigned int issued = 0u;
+      unsigned int skipped = 0u;
+      Visualizer::StateChanges last_frame;
+    };
+
+    static void issue(){
+      ++state_.issued;
+    }
+    static void skip(){
+      ++state_.skipped;
+    }
+    static GLuint *bound_texture(const GLenum target){
+      const GLuint unit{state_.active_texture - GL_TEXTURE0};
+      if(state_.active_texture == unknown_ || unit >= texture_units_) return nullptr;
+
+      switch(target){
+      case GL_TEXTURE_1D:
+        return &state_.texture_1d[unit];
+      case GL_TEXTURE_2D:
+        return &state_.texture_2d[unit];
+      case GL_TEXTURE_CUBE_MAP:
+        return &state_.texture_cube_map[unit];
+      default:
+        return nullptr;
+      }
+    }
+    static void set_capability(const GLenum capability, const bool enable);
+
+    static State state_;
+  };
+}
+
+#endif // TORERO_GL_STATE_H
@@ -10,6 +10,7 @@
 
 #include "algebraica/algebraica.h"
 
+#include <cstddef>
 #include <vector>
 
 namespace Toreo {
@@ -22,7 +23,10 @@ namespace Toreo {
     Ground(Shader *ground_shader, const std::vector<Visualizer::FreeGround3D> *ground);
     Ground(Shader *ground_shader, const std::vector<Visualizer::FreePolarGround2D> *ground);
     Ground(Shader *ground_shader, const std::vector<Visualizer::FreePolarGround3D> *ground);
+    // frees the textures, the OpenGL context must still exist
+    ~Ground();
 
+    // an input of the same type keeps the uploaded cells (see update_changes())
     void change_input(const std::vector<Visualizer::Ground2D> *ground);
     void change_input(const std::vector<Visualizer::Ground3D> *ground);
     void change_input(const std::vector<Visualizer::FreeGround2D> *ground);
@@ -39,6 +43,35 @@ namespace Toreo {
 
     void fog_visibility(const bool visible = true);
 
+    // Visualizer::TEXTURE draws the grids (Ground2D and Ground3D) from textures of their
+    // cells, the texels are updated with glTexSubImage2D and the draw does not depend on
+    // the number of cells (Ground2D) or does not need a geometry shader (Ground3D);
+    // free grounds and grounds without texture program are drawn with Visualizer::GEOMETRY;
+    // Visualizer::INSTANCED draws the same vertices as Visualizer::GEOMETRY with one instance
+    // per cell; Visualizer::AUTOMATIC (default) is TEXTURE for the grids and INSTANCED for
+    // the free grounds, GEOMETRY is used if their programs are not set
+    void set_mode(const Visualizer::GroundMode mode);
+    const Visualizer::GroundMode mode();
+    // program of the texture mode: ground_texture.vert and ground.frag with GROUND_TEXTURE
+    void set_texture_shader(Shader *texture_shader);
+    // program of the instanced mode: ground_instanced.vert and ground.frag
+    void set_instanced_shader(Shader *instanced_shader);
+
+    // a scrolling grid (Ground2D or Ground3D) follows navigation_frame: it is a toroidal
+    // grid where the cell (x, y) of the fixed frame, x = floor(position_x / element_length)
+    // and y = floor(position_y / element_width), is at the index
+    // (y mod number_of_elements_through_width) * number_of_elements_through_length +
+    // (x mod number_of_elements_through_length) and is drawn at its position in the fixed
+    // frame; nullptr stops scrolling
+    void set_scrolling(const algebraica::mat4f *navigation_frame);
+    const bool is_scrolling();
+    // first cell (x, y) of the window around the current navigation frame, the window
+    // has number_of_elements_through_length x number_of_elements_through_width cells
+    void scrolling_window(int *x, int *y);
+    // moves the window to scrolling_window() uploading only the cells that were not
+    // visible, the rest of the grid is not modified (see update_region())
+    bool scroll();
+
     void translate(const float x = 0.0f, const float y = 0.0f, const float z = 0.0f);
     void translate(const algebraica::vec3f translation);
     void rotate(const float pitch = 0.0f, const float yaw = 0.0f, const float roll = 0.0f);
@@ -48,11 +81,55 @@ namespace Toreo {
     void rotate_in_z(const float angle);
 
     bool update();
+    // uploads only the cells from (x, y) to (x + columns, y + rows) of a grid (Ground2D or
+    // Ground3D), x goes through the length and y through the width; it does a complete
+    // update() if the size of the grid changed since the last one or for free grounds
+    bool update_region(const unsigned int x, const unsigned int y,
+                       const unsigned int columns, const unsigned int rows);
+    // compares the grid with a copy of the last uploaded one and uploads only the changed
+    // cells (the bounding rectangle of consecutive changed rows); the first call does a
+    // complete update() and starts keeping the copy
+    bool update_changes();
     bool draw();
 
   private:
+    // uniforms of ground.geom and ground_instanced.vert (they have the same names)
+    struct CellUniforms{
+      GLint primary_model, secondary_model, fog;
+      GLint width, length, is_2D, position, is_free, is_polar;
+      GLint scrolling, scroll, offset;
+    };
+
     void initialize();
     void restart();
+    // the texture mode can be used
+    const bool is_textured();
+    // the instanced mode can be used (and the texture mode is not used)
+    const bool is_instanced();
+    void cell_uniforms(Shader *shader, CellUniforms *uniforms);
+    void set_cell_uniforms(Shader *shader, const CellUniforms &uniforms);
+    // divisor of the vertex attributes: 1 in the instanced mode, 0 in the geometry mode
+    void set_divisors();
+    bool update_textures();
+    bool draw_textures();
+    // packs the cells from (x, y) to (x + columns, y + rows) into texels and uploads them,
+    // x goes through the length and y through the width (the cells of a row are contiguous)
+    void upload_cells(const unsigned int x, const unsigned int y,
+                      const unsigned int columns, const unsigned int rows);
+    void delete_textures();
+    // floats per cell and the cells of the grid (Ground2D or Ground3D)
+    std::size_t cell_floats();
+    const float *grid();
+    GLsizei cells();
+    // the grid was uploaded completely
+    void uploaded(const unsigned int columns, const unsigned int rows);
+    // uploads count columns (or rows) of the window starting at the cell first
+    bool expose(const int first, const int count, const bool columns);
+    void set_scrolling_uniforms(Shader *shader, const GLint scrolling,
+                                const GLint scroll, const GLint offset);
+    // packs the cells from (x, y) to (x + columns, y + rows) into vertices and uploads them
+    void upload_records(const unsigned int x, const unsigned int y,
+                        const unsigned int columns, const unsigned int rows);
 
     Shader *shader_;
     Buffer buffer_;
@@ -76,8 +153,35 @@ namespace Toreo {
     GLsizei type_size_, data_size_;
 
     GLint i_position_, i_color_, i_dimension_, i_height_;
-    GLint u_primary_model_, u_secondary_model_, u_fog_;
-    GLint u_width_, u_length_, u_2D_, u_position_, u_free_, u_polar_;
+    CellUniforms u_geometry_;
+
+    Visualizer::GroundMode mode_;
+    Shader *texture_shader_;
+    // attribute-less draws of the texture mode still need a vertex array
+    Buffer cells_;
+    // textures of the cells' colors and heights, texture_columns_ x texture_rows_ texels
+    GLuint colors_, heights_;
+    unsigned int texture_columns_, texture_rows_;
+    std::vector<unsigned char> color_texels_;
+    std::vector<float> height_texels_;
+
+    GLint u_texture_primary_model_, u_texture_secondary_model_, u_texture_fog_;
+    GLint u_texture_width_, u_texture_length_, u_divisions_, u_3D_;
+
+    // size of the grid in the GPU (buffer or textures), 0 if it must be uploaded completely
+    unsigned int uploaded_columns_, uploaded_rows_;
+    // copy of the last uploaded grid for update_changes(), empty until it is used
+    std::vector<float> snapshot_;
+
+    // the grid is drawn around this frame, its window starts at the cell (scroll_x_, scroll_y_)
+    const algebraica::mat4f *scrolling_frame_;
+    int scroll_x_, scroll_y_;
+    GLint u_texture_scrolling_, u_texture_scroll_, u_texture_offset_;
+
+    // ground_instanced.vert for Visualizer::INSTANCED, it draws buffer_ with one cell per
+    // instance (see set_divisors())
+    Shader *instanced_shader_;
+    CellUniforms u_instanced_;
   };
 }
 
@@ -7,7 +7,9 @@
 #include "include/definitions.h"
 #include "include/line_grid.h"
 #include "include/ground.h"
+#include "include/ground_tiles.h"
 #include "include/shader.h"
+#include "include/triple_buffer.h"
 #include "include/texture.h"
 #include "include/types.h"
 
@@ -208,6 +210,77 @@ namespace Toreo {
              const std::string name,
              const algebraica::mat4f *transformation_matrix = nullptr,
              const bool ground_visible = true);
+    /*
+     * ### Adding a tiled ground map
+     *
+     * Use it for maps that are too big for one grid (a city at 10 cm per cell, for example):
+     * the map is a square quadtree of tiles with `resolution` x `resolution` cells each, the
+     * root covers the whole map and every level halves the size of the cells. Only the
+     * visible tiles are drawn, with a level of detail depending on their distance to the
+     * camera; their cells are requested to `loader` from worker threads (it must be
+     * thread-safe and must not use OpenGL) and the loaded tiles are kept in the GPU until
+     * `set_tiles_cache_size()` is reached. The tiles are drawn with `Visualizer::AUTOMATIC`
+     * mode by default (see `set_mode()`).
+     *
+     * **Arguments**
+     * {const GroundTiles::Loader &} loader = Function that fills the cells of a tile, it
+     * returns `false` if the map does not have data in that tile (see `GroundTiles::Loader`).
+     * {const std::string} name = Title to display for this ground.
+     * {const float} minimum_x = Back limit of the map in meters.
+     * {const float} minimum_y = Right limit of the map in meters.
+     * {const float} size = Length and width of the map in meters.
+     * {const unsigned int} levels = Number of levels of the quadtree, the finest cells
+     * measure `size / (resolution * 2^(levels - 1))`.
+     * {const unsigned int} resolution = Cells through the length and the width of each tile.
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const bool} ground_visible = Visibility of this ground.
+     *
+     * **Returns**
+     * {GMid} Ground identification number (use it for future modifications)
+     *
+     */
+    GMid add_tiles(const GroundTiles::Loader &loader,
+                   const std::string name,
+                   const float minimum_x,
+                   const float minimum_y,
+                   const float size,
+                   const unsigned int levels = 8u,
+                   const unsigned int resolution = 256u,
+                   const algebraica::mat4f *transformation_matrix = nullptr,
+                   const bool ground_visible = true);
+    /*
+     * ### Changing the GPU memory of a tiled ground map
+     *
+     * Maximum GPU memory used by the loaded tiles of the ground with *identification number*
+     * = `id` (see `add_tiles()`), the least recently drawn tiles are freed. The default is
+     * 256 MB.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the tiled ground you want to modify.
+     * {const std::size_t} bytes = Maximum memory in bytes.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the tiled ground with **id** was **not** found.
+     *
+     */
+    bool set_tiles_cache_size(GMid id, const std::size_t bytes);
+    /*
+     * ### Changing the level of detail of a tiled ground map
+     *
+     * The tiles of the ground with *identification number* = `id` are replaced by finer ones
+     * while their cells would measure more than `pixel_error` pixels in the screen; lower
+     * values draw more detail and load more tiles.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the tiled ground you want to modify.
+     * {const float} pixel_error = Maximum size of a cell in pixels.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the tiled ground with **id** was **not** found.
+     *
+     */
+    bool set_tiles_pixel_error(GMid id, const float pixel_error = 2.0f);
     /*
      * ### Changing the ground data input: uniform 2D ground
      *
@@ -304,6 +377,88 @@ namespace Toreo {
      *
      */
     bool change_input(GMid id, const std::vector<Visualizer::FreePolarGround3D> *ground);
+    /*
+     * ### Changing how a ground is drawn
+     *
+     * With `Visualizer::GEOMETRY` every cell is uploaded as a point and expanded into a
+     * square or a box by a geometry shader. With `Visualizer::INSTANCED` the same cells are
+     * instances of a square or a box built by the vertex shader (`glDrawArraysInstanced`),
+     * without geometry shader. With `Visualizer::TEXTURE` the cells are texels of a RGBA8
+     * color texture (and a R16F height texture for `Ground3D`), updating uploads 4 bytes per
+     * cell and a `Ground2D` is drawn as one quad whatever its number of cells; a `Ground3D`
+     * becomes a heightfield (continuous surface) instead of boxes, free grounds are never
+     * drawn with textures. `Visualizer::AUTOMATIC` is the default: it uses
+     * `Visualizer::TEXTURE` for the grids and `Visualizer::INSTANCED` for the free grounds,
+     * the fastest paths measured by `benchmark/ground_paths` at every size; run it to compare
+     * the paths in your driver.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground you want to modify.
+     * {const Visualizer::GroundMode} mode = `Visualizer::GEOMETRY`, `Visualizer::TEXTURE`,
+     * `Visualizer::INSTANCED` or `Visualizer::AUTOMATIC`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool set_mode(GMid id, const Visualizer::GroundMode mode);
+    /*
+     * ### Making a ground grid follow the vehicle
+     *
+     * A scrolling ground (`Ground2D` or `Ground3D`) is a window of
+     * `number_of_elements_through_length` x `number_of_elements_through_width` cells around
+     * the `navigation_frame` (use `VehicleManager::navigation_frame()`) that stays fixed in the
+     * world while the vehicle moves. Its vector is **toroidal**: the cell `x, y` of the fixed
+     * frame (`x = floor(position_x / element_length)`, `y = floor(position_y / element_width)`)
+     * is at the index `(y mod elements_through_width) * elements_through_length +
+     * (x mod elements_through_length)`, so moving the window only needs the newly visible
+     * cells, write them and call `scroll()`. The ground is drawn with the navigation frame as
+     * its transformation matrix. `Visualizer::TEXTURE` mode uploads each exposed column or row
+     * with one call.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground you want to modify.
+     * {const algebraica::mat4f *} navigation_frame = Frame to follow, `nullptr` stops scrolling.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool set_scrolling(GMid id, const algebraica::mat4f *navigation_frame);
+    /*
+     * ### Obtaining the window of a scrolling ground
+     *
+     * Gives the first cell (fixed frame) of the window around the current navigation frame,
+     * the window goes from `x` to `x + number_of_elements_through_length - 1` and from `y` to
+     * `y + number_of_elements_through_width - 1`. Write the cells that were not inside the
+     * previous window before calling `scroll()`.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground.
+     * {int *} x = First cell through the length (forward).
+     * {int *} y = First cell through the width (to the left).
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool scrolling_window(GMid id, int *x, int *y);
+    /*
+     * ### Scrolling a ground
+     *
+     * This function moves the window of the scrolling **ground** with *identification number*
+     * = `id` to the current navigation frame, only the newly visible columns and rows are
+     * uploaded. Call it every time the vehicle moves (connect it to the same signal as the
+     * vehicle's update), grounds that are not scrolling are updated completely.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground you want to scroll.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool scroll(GMid id);
     /*
      * ### Adding fog to the scene
      *
@@ -498,7 +653,8 @@ namespace Toreo {
      * ### Setting the transformation matrix
      *
      * This function changes the transformation matrix (coordinate system's origin and
-     * orientation) of the **ground** with *identification number* = `id`.
+     * orientation) of the **ground** with *identification number* = `id`. Only its address
+     * is kept: call `Core::request_redraw()` after you modify the values of the matrix.
      *
      * **Arguments**
      * {GMid} id = **id** of the ground you want to modify.
@@ -604,6 +760,45 @@ namespace Toreo {
      *
      */
     bool update(GMid id);
+    /*
+     * ### Updating only a region of a ground grid
+     *
+     * This function uploads only the cells from (`x`, `y`) to (`x + columns`, `y + rows`) of
+     * the **ground** with *identification number* = `id`, `x` goes through the length and
+     * `y` through the width (the index of a cell is `y * number_of_elements_through_length + x`).
+     * Use it when you know which cells were modified, the upload is proportional to the
+     * region instead of the whole grid. Free grounds and grids whose size changed since the
+     * last update are updated completely.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground you want to update.
+     * {const unsigned int} x = First cell through the length.
+     * {const unsigned int} y = First cell through the width.
+     * {const unsigned int} columns = Number of cells through the length.
+     * {const unsigned int} rows = Number of cells through the width.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool update_region(GMid id, const unsigned int x, const unsigned int y,
+                       const unsigned int columns, const unsigned int rows);
+    /*
+     * ### Updating only the modified cells of a ground grid
+     *
+     * This function compares the data of the **ground** with *identification number* = `id`
+     * with a copy of the last uploaded one (using SSE2 if available) and uploads only the
+     * modified cells. The first call updates the whole ground and starts keeping the copy
+     * (one more copy of the grid in memory), following calls are cheap when few cells change.
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground you want to update.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool update_changes(GMid id);
     /*
      * ### Updating the data of every ground
      *
@@ -689,27 +884,87 @@ namespace Toreo {
      *
      */
     void connect_all(boost::signals2::signal<void ()> *signal);
+    /*
+     * ### Subscribing an specific ground to a triple buffer
+     *
+     * Producer threads (sensor drivers, for example) write into `source->back()` and call
+     * `source->publish()`, the ground with *identification number* = `id` takes the newest
+     * snapshot and updates its data right before being drawn, without locks and without
+     * torn reads; only the cells that changed are uploaded (see `update_changes()`). Use it
+     * with `Core::execute_concurrently()` to receive data while drawing.
+     * The triple buffer must live longer than the ground, subscribe before the producer
+     * starts publishing (every publication requests a new frame).
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground.
+     * {TripleBuffer<std::vector<T> >*} source = Address to the triple buffer, `T` must be
+     * one of the ground types accepted by `add()`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    template<typename T>
+    bool subscribe(GMid id, TripleBuffer<std::vector<T> > *source){
+      if(grounds_.size() > id)
+        if(grounds_[id].ground != nullptr){
+          grounds_[id].refresh = boost::bind(&GroundManager::consume<T>, this, id, source);
+          source->set_notifier(boost::bind(&GroundManager::request_redraw, this));
+          return true;
+        }else
+          return false;
+      else
+        return false;
+    }
+    /*
+     * ### Unsubscribing an specific ground from its triple buffer
+     *
+     * **Arguments**
+     * {GMid} id = **id** of the ground.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the ground with **id** was **not** found.
+     *
+     */
+    bool unsubscribe(GMid id);
 
   private:
-    void updated_camera();
+    void request_redraw();
+    // pixels per unit at distance 1 (see GroundTiles::draw())
+    float screen_factor();
+
+    template<typename T>
+    bool consume(GMid id, TripleBuffer<std::vector<T> > *source){
+      if(!source->consume()) return false;
+      Ground *ground{grounds_[id].ground};
+      ground->change_input(source->front());
+      // a scrolling window uploads the newly exposed cells first, then only the cells that
+      // changed since the last snapshot are uploaded
+      if(ground->is_scrolling()) ground->scroll();
+      ground->update_changes();
+      return true;
+    }
+
     void initialize();
 
     Core *core_;
 
     Shader *ground_shader_;
-    GLint u_projection_ground_, u_view_ground_, u_point_light_ground_;
-    GLint u_point_light_color_ground_, u_directional_light_ground_;
-    GLint u_directional_light_color_ground_, u_camera_position_ground_;
+    // ground_texture.vert and ground.frag for Visualizer::TEXTURE
+    Shader *ground_texture_shader_;
+    // ground_instanced.vert and ground.frag for Visualizer::INSTANCED
+    Shader *ground_instanced_shader_;
+    GLint u_point_light_ground_, u_point_light_color_ground_;
+    GLint u_directional_light_ground_, u_directional_light_color_ground_;
 
     std::vector<Visualizer::GroundElement> grounds_;
 
     LineGrid *grid_;
     Shader *line_shader_;
-    GLint u_view_line_, u_perspective_line_;
     bool grid_visibility_;
 
-    boost::signals2::connection signal_updated_camera_;
-    boost::signals2::connection signal_updated_all_, signal_draw_all_;
+    boost::signals2::connection signal_updated_all_;
+    int render_pass_;
   };
 }
 
@@ -0,0 +1,143 @@
+#ifndef TORERO_GROUND_TILES_H
+#define TORERO_GROUND_TILES_H
+
+#include "glad/glad.h"
+
+#include "include/definitions.h"
+#include "include/ground.h"
+#include "include/shader.h"
+#include "include/types.h"
+#include "include/worker_pool.h"
+
+#include "algebraica/algebraica.h"
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace Toreo {
+  // ground map too big for one grid: a quadtree of square tiles over the map, the root
+  // (level 0) covers the whole map and every child covers a quarter of its parent, all the
+  // tiles have resolution x resolution cells so the cells of a level are half the size of
+  // its parent's. Only the tiles inside the view whose cells would be bigger than
+  // pixel_error pixels are refined, their cells are requested to a loader running in worker
+  // threads and every loaded tile is a Ground (drawn with the ground shaders) kept in a LRU
+  // cache limited by its GPU memory.
+  class GroundTiles
+  {
+  public:
+    // fills the cells of tile (resolution x resolution, with the same order as a Ground2D
+    // grid: cells[row * resolution + column], row 0 at the maximum y and column 0 at the
+    // maximum x); returns false if the map does not have data in that tile.
+    // It runs in the worker threads: it must be thread-safe and must not use OpenGL
+    typedef boost::function<bool (const Visualizer::GroundTile &tile,
+                                  std::vector<Visualizer::Ground2D> *cells)> Loader;
+
+    // the map goes from (minimum_x, minimum_y) to (minimum_x + size, minimum_y + size) in
+    // meters, levels = number of levels of the quadtree (the finest cells measure
+    // size / (resolution * 2^(levels - 1)))
+    GroundTiles(Shader *ground_shader, Shader *texture_shader, Shader *instanced_shader,
+                const Loader &loader,
+                const float minimum_x, const float minimum_y, const float size,
+                const unsigned int levels = 8u, const unsigned int resolution = 256u);
+    // stops the workers and frees the tiles, the OpenGL context must still exist
+    ~GroundTiles();
+
+    void set_transformation_matrix(const algebraica::mat4f *transformation_matrix);
+    // mode of the tiles (see Ground::set_mode()), the loaded tiles are loaded again
+    void set_mode(const Visualizer::GroundMode mode);
+    void fog_visibility(const bool visible = true);
+    // maximum GPU memory in bytes used by the tiles, the least recently drawn are freed
+    void set_cache_size(const std::size_t bytes);
+    // a tile is refined while its cells measure more than pixel_error pixels
+    void set_pixel_error(const float pixel_error = 2.0f);
+    // function called from a worker thread every time a tile was loaded (to request a redraw)
+    void set_notifier(const boost::function<void ()> &notifier);
+
+    // draws the visible tiles with the finest loaded level, missing tiles are requested to
+    // the workers; pv = camera perspective-view matrix, camera = camera position (OpenGL
+    // coordinates), screen_factor = pixels per unit at distance 1
+    // (viewport height / (2 * tan(fov / 2))); returns the number of tiles drawn
+    std::size_t draw(const algebraica::mat4f &pv, const algebraica::vec3f &camera,
+                     const float screen_factor);
+
+  private:
+    enum State{
+      EMPTY,
+      LOADING,
+      LOADED,
+      // the loader does not have data for this tile
+      MISSING
+    };
+    // a tile without entry in tiles_ is EMPTY
+    struct Tile{
+      State state = EMPTY;
+      Ground *ground = nullptr;
+      std::vector<Visualizer::Ground2D> cells;
+      // last frame where the tile was drawn (or visited if it is MISSING)
+      unsigned int frame = 0u;
+      // position in cache_ (LOADED) or missing_ (MISSING)
+      std::list<std::uint64_t>::iterator cached;
+    };
+    typedef std::unordered_map<std::uint64_t, Tile> TileMap;
+    struct LoadedTile{
+      std::uint64_t key;
+      Visualizer::GroundTile area;
+      bool exists;
+      std::vector<Visualizer::Ground2D> cells;
+    };
+
+    static std::uint64_t key(const unsigned int level, const unsigned int x,
+                             const unsigned int y);
+    Visualizer::GroundTile area(const unsigned int level, const unsigned int x,
+                                const unsigned int y);
+    // adds the loaded tiles that cover the visible area of (level, x, y) to visible
+    void select(const unsigned int level, const unsigned int x, const unsigned int y,
+                const float *mvp, const float *model, const algebraica::vec3f &camera,
+                const float screen_factor, std::vector<Tile*> *visible);
+    bool is_visible(const Visualizer::GroundTile &area, const float *mvp);
+    float screen_error(const Visualizer::GroundTile &area, const float *model,
+                       const algebraica::vec3f &camera, const float screen_factor);
+    void request(const unsigned int level, const unsigned int x, const unsigned int y);
+    // keeps a MISSING tile until the end of the frame
+    void keep_missing(Tile &tile);
+    void load_tile(const std::uint64_t key, const Visualizer::GroundTile area);
+    void upload_tiles();
+    void create_ground(const Visualizer::GroundTile &area, Tile &tile);
+    // deletes the ground and the entry of the tile, returns the next entry
+    TileMap::iterator free_tile(TileMap::iterator tile);
+    void evict_tiles();
+    std::size_t tile_bytes();
+
+    Shader *shader_, *texture_shader_, *instanced_shader_;
+    Loader loader_;
+    float minimum_x_, minimum_y_, size_;
+    unsigned int levels_, resolution_;
+
+    TileMap tiles_;
+    // tiles in GPU memory, the most recently used first
+    std::list<std::uint64_t> cache_;
+    // tiles without data, the most recently visited first; they are forgotten when they
+    // are not visible anymore
+    std::list<std::uint64_t> missing_;
+    std::size_t cache_bytes_, cache_size_;
+    float pixel_error_;
+    unsigned int frame_;
+
+    const algebraica::mat4f *primary_model_;
+    algebraica::mat4f identity_matrix_;
+    Visualizer::GroundMode mode_;
+    bool fog_visibility_;
+
+    boost::function<void ()> notifier_;
+    boost::mutex loaded_mutex_;
+    std::vector<LoadedTile> loaded_;
+    WorkerPool *workers_;
+  };
+}
+
+#endif // TORERO_GROUND_TILES_H
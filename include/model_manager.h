@@ -66,7 +66,8 @@ namespace Toreo {
     // Changes the visibility of the 3D model.
     // Returns false if Model element with ID = id was not found.
     bool set_visibility(MMid model_id, MMelement element_id, const bool visible = true);
-    // Sets the transformation matrix for the 3D model with ID = id.
+    // Sets the transformation matrix for the 3D model with ID = id, only its address is kept:
+    // call Core::request_redraw() after you modify the values of the matrix.
     // Returns false if Model element with ID = id was not found.
     bool set_transformation_matrix(MMid model_id, MMelement element_id,
                                    const algebraica::mat4f *transformation_matrix);
@@ -124,7 +125,6 @@ namespace Toreo {
 
   private:
     void draw(Visualizer::Model3D *model, Visualizer::Model3DElement *element);
-    void update_camera();
     void update_vehicle_model();
 
     MMid load_db5();
@@ -133,8 +133,8 @@ namespace Toreo {
     Core *core_;
 
     Shader *model_shader_;
-    GLint m_u_scene_model_, m_u_object_model_, m_u_view_, m_u_projection_, m_u_light_;
-    GLint m_u_light_color_, m_u_light_size_, m_u_camera_, m_u_sun_, m_u_sun_color_;
+    GLint m_u_scene_model_, m_u_object_model_, m_u_light_, m_u_light_color_;
+    GLint m_u_light_size_, m_u_sun_, m_u_sun_color_;
     GLint m_u_pbr_, m_u_fog_, m_u_metallized_, m_u_metallic_value_, m_u_roughed_;
     GLint m_u_roughness_value_, m_u_colored_, m_u_color_, m_u_emitting_;
 
@@ -145,7 +145,7 @@ namespace Toreo {
 
     std::vector<Visualizer::Model3D> models_;
 
-    boost::signals2::connection signal_updated_camera_, signal_draw_all_;
+    int render_pass_;
 
     algebraica::vec3f sun_direction_, sun_color_;
   };
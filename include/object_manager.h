@@ -8,6 +8,7 @@
 #include "include/definitions.h"
 #include "include/objects.h"
 #include "include/shader.h"
+#include "include/triple_buffer.h"
 #include "include/texture.h"
 #include "include/types.h"
 
@@ -53,7 +54,8 @@ namespace Toreo {
                      const bool visible = true);
     // This will change the input data for the Point cloud with ID = id
     bool change_input(OMid id, const std::vector<Visualizer::Object> *objects);
-    // Sets the transformation matrix for the Point cloud with ID = id.
+    // Sets the transformation matrix for the Point cloud with ID = id, only its address is
+    // kept: call Core::request_redraw() after you modify the values of the matrix.
     bool set_transformation_matrix(OMid id, const algebraica::mat4f *transformation_matrix);
     // Changes the visibility of the point cloud,
     // returns false if point cloud with ID = id was not found.
@@ -102,8 +104,35 @@ namespace Toreo {
      *
      */
     void connect_all(boost::signals2::signal<void ()> *signal);
+    // Subscribes the object with ID = id to a triple buffer written by other threads,
+    // the newest published snapshot is taken right before drawing (without locking);
+    // subscribe before the producer starts publishing.
+    // Returns false if the object does not exists.
+    template<typename T>
+    bool subscribe(OMid id, TripleBuffer<std::vector<T> > *source){
+      if(objects_.size() > id)
+        if(objects_[id].object != nullptr){
+          objects_[id].refresh = boost::bind(&ObjectManager::consume<T>, this, id, source);
+          source->set_notifier(boost::bind(&ObjectManager::request_redraw, this));
+          return true;
+        }else
+          return false;
+      else
+        return false;
+    }
+    // Stops taking data from the triple buffer, returns false if the object does not exists.
+    bool unsubscribe(OMid id);
 
   private:
+    void request_redraw();
+
+    template<typename T>
+    bool consume(OMid id, TripleBuffer<std::vector<T> > *source){
+      if(!source->consume()) return false;
+      objects_[id].object->change_input(source->front());
+      return true;
+    }
+
     void prepare_hollow_cylinder();
     void prepare_solid_cylinder();
     void prepare_hollow_box();
@@ -114,20 +143,18 @@ namespace Toreo {
     void prepare_solid_circle();
     void prepare_arrow();
 
-    void updated_camera();
-
     Core *core_;
 
     Shader *shader_;
     Buffer *hollow_cylinder_, *hollow_box_, *solid_box_, *solid_cylinder_;
     Buffer *hollow_square_, *solid_square_, *hollow_circle_, *solid_circle_, *solid_arrow_;
-    GLint u_pv_, u_camera_position_, u_point_light_, u_point_light_color_, u_ao_;
+    GLint u_point_light_, u_point_light_color_, u_ao_;
     GLint u_directional_light_, u_directional_light_color_;
     std::vector<Visualizer::ObjectElement> objects_;
     Texture *ao_cylinder_, *ao_box_, *ao_square_, *ao_circle_, *ao_arrow_;
 
-    boost::signals2::connection signal_updated_camera_, signal_draw_all_;
     boost::signals2::connection signal_updated_all_;
+    int render_pass_;
   };
   }
 
@@ -0,0 +1,150 @@
+#ifndef TORERO_OCTREE_CLOUD_H
+#define TORERO_OCTREE_CLOUD_H
+
+#include "glad/glad.h"
+
+#include "include/buffer.h"
+#include "include/colormap.h"
+#include "include/definitions.h"
+#include "include/shader.h"
+#include "include/types.h"
+#include "include/worker_pool.h"
+
+#include "algebraica/algebraica.h"
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace Toreo {
+  // static point cloud too big for the GPU (or the RAM), stored on disk as an octree with a
+  // node hierarchy similar to Potree: every node contains a subsample of the points inside its
+  // bounding box with a minimum distance between them (spacing), the spacing of the children is
+  // half of their parent's; drawing a node and all its ancestors gives a uniform density.
+  // Only the nodes inside the view whose spacing is visible in screen are drawn, their points
+  // are read from the file by worker threads and kept in a LRU cache of GPU buffers.
+  //
+  // File format (*.toct, native endianness):
+  //   OctreeHeader
+  //   OctreeNode x header.node_count (node 0 is the root)
+  //   Visualizer::pointXYZI x (sum of all the nodes' count), each node's points are contiguous
+  class OctreeCloud
+  {
+  public:
+    struct OctreeHeader{
+      char magic[4];
+      std::uint32_t version;
+      std::uint32_t node_count;
+      std::uint32_t point_type;
+      std::uint64_t point_count;
+    };
+    struct OctreeNode{
+      float minimum[3];
+      float maximum[3];
+      float spacing;
+      std::uint32_t count;
+      // position in bytes of the first point from the beginning of the file
+      std::uint64_t offset;
+      // index of each octant's child, -1 if it does not exist
+      std::int32_t children[8];
+    };
+
+    // loads the node hierarchy of the file "path", the points are loaded when needed;
+    // check is_loaded() and error_log() afterwards
+    OctreeCloud(Shader *shader_program, const std::string path,
+                const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+                const float point_size = 1.0f, const float maximum_intensity_value = 1.0f);
+    // stops the workers and frees the GPU buffers, the OpenGL context must still exist
+    ~OctreeCloud();
+
+    // creates an octree file from a point cloud, node_capacity = maximum number of points
+    // of the nodes without children; the whole cloud must fit in memory
+    static bool build(const std::string path, const std::vector<Visualizer::pointXYZI> &points,
+                      const unsigned int node_capacity = 20000u);
+    // creates an octree file from a point cloud file (see PointCloudFile) without loading it:
+    // the points of every node whose subtree has more than chunk_points are streamed into one
+    // temporary file per octant (next to path), smaller subtrees are built in memory like
+    // build(); LAS positions are relative to PointCloudFile::origin()
+    static bool convert(const std::string path, const std::string source_path,
+                        const unsigned int node_capacity = 20000u,
+                        const std::size_t chunk_points = 5000000u);
+
+    // returns true if the hierarchy was loaded properly
+    bool is_loaded();
+    // if is_loaded() is false, this will return the error's description
+    const std::string error_log();
+    // total number of points in the file
+    std::uint64_t size();
+
+    void set_color_mode(const Visualizer::ColorMode color_mode = Visualizer::VARIABLE);
+    void set_transformation_matrix(const algebraica::mat4f *transformation_matrix);
+    void set_point_size(const float point_size = 1.0f);
+    void set_maximum_intensity_value(const float maximum_intensity_value = 1.0f);
+    // maximum number of points kept in GPU memory, the least recently used nodes are freed
+    void set_cache_size(const std::size_t points);
+    // function called from a worker thread every time a node was read (to request a redraw)
+    void set_notifier(const boost::function<void ()> &notifier);
+
+    // draws the visible nodes with the biggest screen-space error first until point_budget
+    // is reached, missing nodes are requested to the workers;
+    // pv = camera perspective-view matrix, camera = camera position (OpenGL coordinates),
+    // screen_factor = pixels per unit at distance 1 (viewport height / (2 * tan(fov / 2)))
+    // returns the number of points drawn
+    std::size_t draw(const algebraica::mat4f &pv, const algebraica::vec3f &camera,
+                     const float screen_factor, const std::size_t point_budget);
+
+  private:
+    struct Node{
+      OctreeNode data;
+      Buffer *buffer = nullptr;
+      bool is_loading = false;
+      // last frame where the node was drawn
+      unsigned int frame = 0u;
+      std::list<int>::iterator cached;
+    };
+    struct LoadedNode{
+      int node;
+      std::vector<Visualizer::pointXYZI> points;
+    };
+
+    bool open();
+    void load_node(const int node, const std::uint64_t offset, const std::uint32_t count);
+    void upload_nodes();
+    void evict_nodes();
+    bool is_visible(const Node &node, const float *mvp);
+    float screen_error(const Node &node, const float *model, const algebraica::vec3f &camera,
+                       const float screen_factor);
+
+    Shader *shader_;
+    std::string path_, error_log_;
+    bool is_loaded_;
+    std::uint64_t point_count_;
+
+    std::vector<Node> nodes_;
+    // resident nodes, the most recently used first
+    std::list<int> cache_;
+    std::size_t cache_points_, cache_size_;
+    unsigned int frame_;
+
+    const algebraica::mat4f *primary_model_;
+    algebraica::mat4f secondary_model_, identity_matrix_;
+    Visualizer::ColorMode color_mode_;
+    float point_size_, maximum_intensity_value_;
+    Colormap colormap_;
+
+    GLint i_position_, i_intensity_;
+    GLint u_primary_model_, u_secondary_model_, u_color_mode_, u_intensity_range_;
+    GLint u_scale_, u_offset_;
+
+    boost::function<void ()> notifier_;
+    boost::mutex loaded_mutex_;
+    std::vector<LoadedNode> loaded_;
+    WorkerPool *workers_;
+  };
+}
+
+#endif // TORERO_OCTREE_CLOUD_H
@@ -4,12 +4,20 @@
 #include "glad/glad.h"
 
 #include "include/buffer.h"
+#include "include/colormap.h"
 #include "include/definitions.h"
+#include "include/point_cloud_batch.h"
+#include "include/point_cloud_file.h"
+#include "include/point_index.h"
+#include "include/point_processor.h"
 #include "include/shader.h"
+#include "include/stream_buffer.h"
 #include "include/types.h"
+#include "include/voxel_grid.h"
 
 #include "algebraica/algebraica.h"
 
+#include <atomic>
 #include <vector>
 
 namespace Toreo {
@@ -30,10 +38,43 @@ namespace Toreo {
     PointCloud(Shader *shader_program, const std::vector<Visualizer::pointXYZRGBA> *point_cloud,
                const float point_size = 1.0f, const float maximum_intensity_value = 1.0f);
 
+    // quantized point clouds: position = (x / 32767) * scale + offset
+    PointCloud(Shader *shader_program, const std::vector<Visualizer::pointXYZIq16> *point_cloud,
+               const algebraica::vec3f scale, const algebraica::vec3f offset = algebraica::vec3f(),
+               const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+               const float point_size = 1.0f, const float maximum_intensity_value = 255.0f);
+
+    PointCloud(Shader *shader_program, const std::vector<Visualizer::pointXYZRGB8> *point_cloud,
+               const algebraica::vec3f scale, const algebraica::vec3f offset = algebraica::vec3f(),
+               const float point_size = 1.0f, const float maximum_intensity_value = 1.0f);
+
+    // point cloud read from a memory mapped file, this object takes the ownership of file;
+    // use Visualizer::NONE as color_mode to draw the file's colors
+    PointCloud(Shader *shader_program, PointCloudFile *file,
+               const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+               const float point_size = 1.0f, const float maximum_intensity_value = 255.0f);
+    // interleaved points with the fields described by layout (sensor buffers like
+    // PointCloud2), the fields that are not in layout (ring, time...) are skipped;
+    // number of points = point_cloud->size() / layout.stride
+    PointCloud(Shader *shader_program, const std::vector<unsigned char> *point_cloud,
+               const Visualizer::PointLayout layout,
+               const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+               const float point_size = 1.0f, const float maximum_intensity_value = 1.0f);
+    ~PointCloud();
+
     void change_input(const std::vector<Visualizer::pointXYZ> *point_cloud);
     void change_input(const std::vector<Visualizer::pointXYZI> *point_cloud);
     void change_input(const std::vector<Visualizer::pointXYZRGB> *point_cloud);
     void change_input(const std::vector<Visualizer::pointXYZRGBA> *point_cloud);
+    void change_input(const std::vector<Visualizer::pointXYZIq16> *point_cloud);
+    void change_input(const std::vector<Visualizer::pointXYZRGB8> *point_cloud);
+    // keeps the last layout
+    void change_input(const std::vector<unsigned char> *point_cloud);
+    void change_input(const std::vector<unsigned char> *point_cloud,
+                      const Visualizer::PointLayout layout);
+    // changes the decoding of quantized positions: position = (x / 32767) * scale + offset
+    void set_quantization(const algebraica::vec3f scale,
+                          const algebraica::vec3f offset = algebraica::vec3f());
 
     // sets the colormap
     // you must specify the size of the palette, the maximum readable size is 10 colors
@@ -44,6 +85,10 @@ namespace Toreo {
     //    Visualizer::VARIABLE    -> draws all the points within the colormap relative to their intensity
     //    Visualizer::NONE        -> use this when using RGB or RGBA data
     void set_color_mode(const Visualizer::ColorMode color_mode = Visualizer::VARIABLE);
+    // programs specialized for every color mode (point_cloud.vert compiled with
+    // COLOR_MODE = Visualizer::ColorMode), variants[color_mode] is chosen when drawing;
+    // without variants (or if one was not created) shader_program is used for all the modes
+    void set_shader_variants(Shader *const *variants);
     void set_transformation_matrix(const algebraica::mat4f *transformation_matrix);
     void set_point_size(const float point_size = 1.0f);
     void set_maximum_intensity_value(const float maximum_intensity_value = 1.0f);
@@ -59,21 +104,120 @@ namespace Toreo {
     // copies the point cloud's information into an openGL buffer
     // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
     bool update();
+    // copies only the points first -> first + count of the input (they were modified), the
+    // number of drawn points follows the input's size; clouds that are streamed, accumulated,
+    // batched, downsampled or read from files, and inputs bigger than the storage are
+    // copied completely with update()
+    bool update_range(const std::size_t first, const std::size_t count);
+    // copies only the points added at the end of the input since the last update
+    bool append();
     // draws the point cloud into the screen
     // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
     bool draw();
+    // streaming mode: the points are copied into a persistently mapped ring buffer of
+    // 3 regions, the GPU reads one region while the next update writes another one,
+    // useful for clouds that change every frame
+    void set_streaming(const bool streaming = true);
+    const bool is_streaming();
+    // x, y and z of the cloud's origin in the file's coordinates (see PointCloudFile::origin())
+    // returns false if the cloud was not read from a file
+    bool file_origin(double *origin);
+    // reduces the points before uploading them (the data is not modified), value is the
+    // leaf size in meters for VOXEL_GRID or the fraction of points kept for RANDOM_SUBSET;
+    // only clouds with float positions (not quantized). The points are reduced by a worker
+    // thread after update() and uploaded by the next update() or draw()
+    void set_downsampling(const Visualizer::Downsampling downsampling, const float value);
+    // called from the worker thread when the reduced points are ready to be drawn
+    void set_notifier(const boost::function<void ()> &notifier);
+    // accumulation mode: every update is kept as a new scan in a GPU ring of the last
+    // "scans" updates with its own pose and timestamp, only the new scan is uploaded;
+    // the scans fade out in fade_time seconds (0 = no fading), scans = 0 disables it.
+    // It replaces the streaming mode
+    void set_accumulation(const unsigned int scans, const float fade_time = 0.0f);
+    // pose (in the coordinate system of the transformation matrix) and time in seconds of
+    // the data of the next update, without timestamp the time of the update is used
+    void set_scan_pose(const algebraica::mat4f &pose, const double timestamp = -1.0);
+    // batched mode: the points are uploaded into the vertex arena of batch and draw() only
+    // queues the cloud, it is drawn with all the other clouds by batch->draw();
+    // only clouds of float points (pointXYZ, pointXYZI, pointXYZRGB and pointXYZRGBA)
+    // without streaming or accumulation, nullptr leaves the batch
+    void set_batch(PointCloudBatch *batch);
+    // GPU processing stage (see PointProcessor): clipping and coloring of the uploaded
+    // points with compute_program (point_cloud.comp), nullptr disables it; only clouds of
+    // float fields that are not streamed, accumulated, batched nor read from files; if the
+    // processing fails in draw() it is disabled and the plain points are drawn.
+    // Returns false if the compute shaders are not supported (OpenGL 4.3)
+    bool set_processing(Shader *compute_program, const Visualizer::PointProcessing *processing);
+    // spatial index for picking and region queries, it is created from the input (before
+    // downsampling) by the first query after an update, the updates only mark it as outdated;
+    // only clouds with float positions (not quantized nor files). Indices are positions in
+    // the input
+    void set_indexing(const bool indexing = true);
+    const bool is_indexing();
+    // nearest point to the camera drawn within radius (normalized device units) of x, y
+    // (normalized device coordinates), pv = camera's perspective-view matrix;
+    // position is in the coordinates of the input
+    bool nearest_point(const algebraica::mat4f &pv, const float x, const float y,
+                       const float radius, std::uint32_t *index,
+                       algebraica::vec3f *position = nullptr, float *depth = nullptr);
+    // points within radius of center or inside the box, in the coordinates of the input
+    std::size_t points_in_radius(const algebraica::vec3f &center, const float radius,
+                                 std::vector<std::uint32_t> *indices);
+    std::size_t points_in_box(const algebraica::vec3f &minimum,
+                              const algebraica::vec3f &maximum,
+                              std::vector<std::uint32_t> *indices);
 
   private:
+    struct Scan{
+      Buffer *buffer = nullptr;
+      GLsizei size = 0;
+      algebraica::mat4f pose;
+      double timestamp = 0.0;
+    };
+
     void initialize();
+    void locate_uniforms();
+    void update_colormap();
+    // the type (or layout) of the points changed: their attributes, stream regions and
+    // accumulated scans are not valid anymore
     void restart();
+    void set_attributes();
+    // uploads points of the current type (to the newest scan, stream region, batch or buffer_)
+    void upload(const GLvoid *data, const GLsizei points);
+    void upload_file();
+    // copies the input and reduces it in filter_worker_, the newest result is in filtered_
+    void downsample(const GLvoid *data, const GLsizei points);
+    void filter(const boost::shared_ptr<std::vector<unsigned char> > points,
+                const GLsizei stride, const GLuint position,
+                const Visualizer::Downsampling downsampling, const float value);
+    void upload_filtered();
+    // builds index_ again if the input changed and waits until it is ready
+    void update_index();
+    // current input and its number of points
+    const GLvoid *input(GLsizei *size);
+    // runs the processing stage on the uploaded points, false if their fields are not floats
+    bool process();
+    // positions are floats (not quantized)
+    const bool float_positions();
+    void clear_scans();
 
     Shader *shader_;
+    // array of Visualizer::NONE + 1 programs and the one used by the last draw
+    Shader *const *variants_ = nullptr;
+    Shader *program_ = nullptr;
     Buffer buffer_;
 
     const std::vector<Visualizer::pointXYZ>     *point_cloud_xyz_;
     const std::vector<Visualizer::pointXYZI>    *point_cloud_xyzi_;
     const std::vector<Visualizer::pointXYZRGB>  *point_cloud_rgb_;
     const std::vector<Visualizer::pointXYZRGBA> *point_cloud_rgba_;
+    const std::vector<Visualizer::pointXYZIq16> *point_cloud_q16_;
+    const std::vector<Visualizer::pointXYZRGB8> *point_cloud_rgb8_;
+    const std::vector<unsigned char>            *point_cloud_raw_;
+    PointCloudFile *file_;
+    // whether upload_file() was called, an empty or unreadable file is not read again
+    bool file_uploaded_ = false;
+    Visualizer::PointLayout layout_;
 
     const algebraica::mat4f *primary_model_;
     algebraica::mat4f secondary_model_, identity_matrix_;
@@ -81,14 +225,55 @@ namespace Toreo {
     float point_size_, maximum_intensity_value_;
     algebraica::vec3f color_palette_[10];
     unsigned int type_, color_size_;
+    Colormap colormap_;
     GLsizei type_size_;
     GLsizei data_size_;
+    // bytes allocated in buffer_ and whether it holds the whole input (see update_range())
+    GLsizeiptr capacity_ = 0;
+    bool buffered_ = false;
+    // first point to draw, the beginning of the last written region when streaming
+    GLint first_;
+
+    StreamBuffer stream_;
+    bool is_streaming_;
+    unsigned int region_;
+
+    Visualizer::Downsampling downsampling_ = Visualizer::NO_DOWNSAMPLING;
+    float downsampling_value_ = 1.0f;
+    VoxelGrid voxel_grid_;
+    std::vector<unsigned char> downsampled_;
+    WorkerPool *filter_worker_ = nullptr;
+    boost::function<void ()> notifier_;
+    boost::mutex filtered_mutex_;
+    std::vector<unsigned char> filtered_;
+    GLsizei filtered_stride_ = 0;
+    std::atomic<bool> is_filtered_{false};
+
+    // ring of accumulated scans, newest_scan_ is the last written
+    std::vector<Scan> scans_;
+    unsigned int newest_scan_ = 0u;
+    float fade_time_ = 0.0f;
+    algebraica::mat4f scan_pose_;
+    double scan_timestamp_ = -1.0;
+
+    PointCloudBatch *batch_ = nullptr;
+    int batch_handle_ = -1;
+
+    PointIndex *index_ = nullptr;
+    // the input changed after the last build of index_ (the queries run in other threads)
+    std::atomic<bool> index_outdated_{false};
+
+    // the processed points are up to date with the input and the transformation
+    PointProcessor *processor_ = nullptr;
+    bool processed_ = false;
 
     GLint i_position_, i_intensity_, i_color_, i_alpha_;
-    GLint u_primary_model_, u_secondary_model_, u_palette_, u_color_size_;
-    GLint u_color_mode_, u_intensity_range_, u_has_alpha_;
+    GLint u_primary_model_, u_secondary_model_, u_color_mode_, u_intensity_range_;
+    GLint u_has_alpha_, u_scale_, u_offset_;
+    GLint u_age_, u_fade_time_;
 
     GLint offset_, offset_x2_;
+    algebraica::vec3f quantization_scale_, quantization_offset_;
   };
   }
 
@@ -0,0 +1,105 @@
+#ifndef TORERO_POINT_CLOUD_BATCH_H
+#define TORERO_POINT_CLOUD_BATCH_H
+
+#include "glad/glad.h"
+
+#include "include/colormap.h"
+#include "include/definitions.h"
+#include "include/gl_extensions.h"
+#include "include/gl_state.h"
+#include "include/shader.h"
+#include "include/types.h"
+
+#include "algebraica/algebraica.h"
+
+#include <vector>
+
+namespace Toreo {
+  // many small point clouds (radars, ultrasonic sensors...) drawn without changing the
+  // program, the vertex array or any uniform between them:
+  //  - the points of every cloud are a range of a vertex arena shared by the clouds of the
+  //    same point type (POINT_XYZ, POINT_XYZI, POINT_XYZRGB and POINT_XYZRGBA)
+  //  - the model matrix, color mode, intensity range, point size and palette row of every
+  //    queued cloud go into a texture buffer read by point_cloud_batch.vert
+  //  - the palettes are the rows of one lookup texture (see Colormap)
+  //  - every cloud is a command of a GL_DRAW_INDIRECT_BUFFER, its baseInstance is the index
+  //    of its data (it reaches the shader as a per instance attribute)
+  // With glMultiDrawArraysIndirect (GL 4.3) every arena is drawn with one call, otherwise
+  // the commands are issued with glDrawArraysInstancedBaseInstance (GL 4.2).
+  class PointCloudBatch
+  {
+  public:
+    // shader_program = point_cloud_batch.vert and point_cloud.frag
+    PointCloudBatch(Shader *shader_program);
+    // frees the buffers and textures, the OpenGL context must still exist
+    ~PointCloudBatch();
+
+    // adds a cloud of the point type, returns its handle or -1 if the type can not be batched
+    int join(const unsigned int type);
+    // removes the cloud, its range of the arena is reused
+    void leave(const int handle);
+    // returns the point type of the cloud
+    unsigned int type(const int handle);
+
+    // copies the points of the cloud into its range of the arena, the range grows 50% over
+    // the needed size to avoid moving it every time the number of points changes a little
+    void upload(const int handle, const void *points, const GLsizei size);
+    // colors go from 0 to 1 (see Colormap)
+    void set_colormap(const int handle, const algebraica::vec3f *colors,
+                      const unsigned int quantity);
+    // the cloud will be drawn by the next draw()
+    void queue(const int handle, const algebraica::mat4f &model,
+               const Visualizer::ColorMode color_mode, const float maximum_intensity_value,
+               const bool has_alpha, const float point_size);
+
+    // draws the queued clouds and empties the queue
+    // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
+    bool draw();
+
+  private:
+    struct Arena{
+      unsigned int type;
+      GLsizei stride;
+      GLuint vertex_array = 0, buffer = 0;
+      // in points
+      GLsizei capacity = 0, used = 0;
+    };
+    struct Member{
+      int arena = -1;
+      // range of the arena in points
+      GLint first = 0;
+      GLsizei capacity = 0, size = 0;
+    };
+    struct Command{
+      GLuint count, instance_count, first, base_instance;
+    };
+
+    int arena(const unsigned int type);
+    // moves the ranges in use to a new buffer with space for at least extra more points
+    void grow(Arena &arena, const GLsizei extra);
+    void set_attributes(Arena &arena);
+    void reserve_clouds(const std::size_t clouds);
+    void reserve_rows(const std::size_t rows);
+
+    Shader *shader_;
+    std::vector<Arena> arenas_;
+    std::vector<Member> members_;
+
+    // queued clouds of every arena, the data of the texture buffer and all the commands
+    std::vector<std::vector<Command> > commands_;
+    std::vector<float> clouds_;
+    std::vector<Command> indirect_;
+
+    // u_clouds, index of every cloud (per instance attribute) and indirect commands,
+    // with space for cloud_capacity_ clouds
+    GLuint cloud_buffer_, cloud_texture_, index_buffer_, indirect_buffer_;
+    std::size_t cloud_capacity_;
+
+    // u_colormaps, one row per member
+    GLuint colormaps_;
+    std::size_t rows_;
+    std::vector<unsigned char> palettes_;
+  };
+}
+
+#endif // TORERO_POINT_CLOUD_BATCH_H
@@ -0,0 +1,96 @@
+#ifndef TORERO_POINT_CLOUD_FILE_H
+#define TORERO_POINT_CLOUD_FILE_H
+
+#include "glad/glad.h"
+
+#include "include/types.h"
+
+#include "algebraica/algebraica.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace Toreo {
+  // point cloud file that is read through memory mapping: only the header is parsed, the
+  // points are never copied into memory (but the block of a LAS file), map() returns the
+  // address of a block of points inside the mapped file with the field layout of layout(),
+  // the blocks can be uploaded directly to OpenGL (see PointCloud::update).
+  //
+  // Supported formats (little endian):
+  //   *.pcd  Point Cloud Library, "DATA binary" only (not ascii or binary_compressed),
+  //          fields: x y z, intensity, rgb or rgba
+  //   *.las  ASPRS LAS 1.0 -> 1.4, point formats 0 -> 10 (not compressed *.laz),
+  //          the integer positions are decoded by map() (the block is copied) with the
+  //          header's scale and offset into floats relative to origin()
+  //   *.traw torero raw format (see save()): RawHeader followed by the points
+  class PointCloudFile
+  {
+  public:
+    struct RawHeader{
+      char magic[4];
+      std::uint32_t version;
+      std::uint64_t point_count;
+      // stride followed by offset, type, count and normalized of position, intensity,
+      // color and alpha
+      std::uint32_t layout[17];
+      float scale[3];
+      float offset[3];
+    };
+
+    // opens the file and reads its header; check is_loaded() and error_log() afterwards
+    explicit PointCloudFile(const std::string path);
+
+    // writes count points with the fields described by layout into a *.traw file
+    static bool save(const std::string path, const Visualizer::PointLayout &layout,
+                     const void *points, const std::uint64_t count,
+                     const algebraica::vec3f scale = algebraica::vec3f(1.0f, 1.0f, 1.0f),
+                     const algebraica::vec3f offset = algebraica::vec3f());
+
+    // returns true if the header was read properly
+    bool is_loaded();
+    // if is_loaded() is false, this will return the error's description
+    const std::string error_log();
+    // number of points in the file
+    std::uint64_t size();
+    // fields of every point
+    const Visualizer::PointLayout &layout();
+    // decoding of the positions: position * scale + offset
+    const algebraica::vec3f &scale();
+    const algebraica::vec3f &offset();
+    // x, y and z of the point (0, 0, 0) of the cloud in the file's coordinates (the center
+    // of georeferenced LAS files), place the cloud with it; zero for the other formats
+    const double *origin();
+
+    // maps the points from first to first + count - 1 and returns the address of the
+    // first one, it is valid until the next call of map() or unmap();
+    // returns nullptr if the points are outside the file
+    const unsigned char *map(const std::uint64_t first, const std::uint64_t count);
+    // unmaps the last block
+    void unmap();
+
+  private:
+    bool read_pcd();
+    bool read_las();
+    bool read_raw();
+
+    std::string path_, error_log_;
+    bool is_loaded_;
+
+    std::uint64_t point_count_, data_offset_, file_size_;
+    Visualizer::PointLayout layout_;
+    algebraica::vec3f scale_, offset_;
+    // LAS positions: value * position_scale_ + position_offset_ - origin_ (double precision)
+    bool decodes_positions_;
+    double position_scale_[3], position_offset_[3], origin_[3];
+    std::vector<unsigned char> block_;
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+  };
+}
+
+#endif // TORERO_POINT_CLOUD_FILE_H
@@ -5,8 +5,11 @@
 #include "glad/glad.h"
 
 #include "include/definitions.h"
+#include "include/octree_cloud.h"
 #include "include/point_cloud.h"
+#include "include/range_image_cloud.h"
 #include "include/shader.h"
+#include "include/triple_buffer.h"
 #include "include/types.h"
 
 #include "algebraica/algebraica.h"
@@ -14,6 +17,7 @@
 #include <boost/signals2.hpp>
 #include <boost/bind.hpp>
 // standard
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -162,6 +166,234 @@ namespace Toreo {
               const bool visible = true,
               const float point_size = 1.0f,
               const float maximum_intensity_value = 1.0f);
+    /*
+     * ### Adding a new quantized 3D point cloud with intensity values
+     *
+     * This will add a new point cloud with values type `Visualizer::pointXYZIq16`: positions
+     * are 16 bits fixed-point integers and the intensity is 8 bits (8 bytes per point instead
+     * of 16). The positions are decoded in the GPU as `(x / 32767) * scale + offset`, for
+     * example: a lidar with 200 meters of range uses `scale = (200, 200, 200)` and has a
+     * resolution of 6 millimeters.
+     *
+     * **Arguments**
+     * {const std::vector<Visualizer::pointXYZIq16>*} point_cloud = Address to the point cloud
+     * data (see data types for more information).
+     * {const std::string} name = Title to display for this point cloud.
+     * {const algebraica::vec3f} scale = Distance in meters represented by 32767 in each axis.
+     * {const algebraica::vec3f} offset = Position in meters of the point (0, 0, 0).
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const Visualizer::ColorMode} color_mode = see **color mode** *section*.
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     * {const float} maximum_intensity_value = maximum value that the intensity could have
+     * (0 -> 255).
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     */
+    PCMid add(const std::vector<Visualizer::pointXYZIq16> *point_cloud,
+              const std::string name,
+              const algebraica::vec3f scale,
+              const algebraica::vec3f offset = algebraica::vec3f(),
+              const algebraica::mat4f *transformation_matrix = nullptr,
+              const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+              const bool visible = true,
+              const float point_size = 1.0f,
+              const float maximum_intensity_value = 255.0f);
+    /*
+     * ### Adding a new quantized 3D point cloud with RGBA colors
+     *
+     * This will add a new point cloud with values type `Visualizer::pointXYZRGB8`: positions
+     * are 16 bits fixed-point integers and the color is 8 bits per channel (12 bytes per point
+     * instead of 24 or 28). The positions are decoded as `(x / 32767) * scale + offset`.
+     *
+     * **Arguments**
+     * {const std::vector<Visualizer::pointXYZRGB8>*} point_cloud = Address to the point cloud
+     * data (see data types for more information).
+     * {const std::string} name = Title to display for this point cloud.
+     * {const algebraica::vec3f} scale = Distance in meters represented by 32767 in each axis.
+     * {const algebraica::vec3f} offset = Position in meters of the point (0, 0, 0).
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     */
+    PCMid add(const std::vector<Visualizer::pointXYZRGB8> *point_cloud,
+              const std::string name,
+              const algebraica::vec3f scale,
+              const algebraica::vec3f offset = algebraica::vec3f(),
+              const algebraica::mat4f *transformation_matrix = nullptr,
+              const bool visible = true,
+              const float point_size = 1.0f);
+    /*
+     * ### Adding a point cloud from a raw sensor buffer
+     *
+     * This will add a point cloud from an interleaved byte buffer (like a `PointCloud2`
+     * message) without converting it: `layout` describes the offset, type and number of
+     * components of the position, intensity, color and alpha fields and the stride between
+     * points; other fields (ring, timestamp...) are skipped. The number of points is
+     * `point_cloud->size() / layout.stride`.
+     *
+     * **Arguments**
+     * {const std::vector<unsigned char>*} point_cloud = Address to the point cloud bytes.
+     * {const Visualizer::PointLayout} layout = Fields of every point (see data types).
+     * {const std::string} name = Title to display for this point cloud.
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const Visualizer::ColorMode} color_mode = Type of coloring (see ColorMode), use
+     * `Visualizer::NONE` to draw the color field.
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     * {const float} maximum_intensity_value = maximum value for the point's intensity.
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     */
+    PCMid add(const std::vector<unsigned char> *point_cloud,
+              const Visualizer::PointLayout layout,
+              const std::string name,
+              const algebraica::mat4f *transformation_matrix = nullptr,
+              const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+              const bool visible = true,
+              const float point_size = 1.0f,
+              const float maximum_intensity_value = 1.0f);
+    /*
+     * ### Adding an organized lidar scan (range image)
+     *
+     * This will add the scan of a spinning lidar as a range image of `rings` x `columns`
+     * 16 bits ranges and an optional image of 8 bits intensities, only these images are
+     * uploaded (3 bytes per point) and the points are reconstructed in the GPU with the
+     * elevation angle of every ring and the azimuth of every column (see `set_azimuth()`).
+     * A range of 0 means no return.
+     *
+     * **Arguments**
+     * {const std::vector<unsigned short>*} range = Address to the ranges (rings x columns,
+     * row major).
+     * {const std::vector<unsigned char>*} intensity = Address to the intensities (rings x
+     * columns, row major), `nullptr` if the sensor does not have them.
+     * {const unsigned int} rings = Number of rows (lasers).
+     * {const unsigned int} columns = Number of columns (azimuth steps).
+     * {const std::vector<float>&} elevations = Elevation angle of every ring in radians.
+     * {const std::string} name = Title to display for this point cloud.
+     * {const float} range_scale = Distance in meters of one range unit.
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const Visualizer::ColorMode} color_mode = Type of coloring (see ColorMode).
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     */
+    PCMid add(const std::vector<unsigned short> *range,
+              const std::vector<unsigned char> *intensity,
+              const unsigned int rings,
+              const unsigned int columns,
+              const std::vector<float> &elevations,
+              const std::string name,
+              const float range_scale = 0.004f,
+              const algebraica::mat4f *transformation_matrix = nullptr,
+              const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+              const bool visible = true,
+              const float point_size = 1.0f);
+    /*
+     * ### Adding a map point cloud stored on disk (octree)
+     *
+     * This will add a point cloud with values type `Visualizer::pointXYZI` that is too big to
+     * be kept in memory, it is stored in a `*.toct` file (see `OctreeCloud::convert()`, it
+     * creates one from a PCD, LAS or raw file without loading it) as an octree where every
+     * node contains a subsample of its points. Only the nodes inside the view with a visible
+     * level of detail are drawn, they are loaded in background and the least recently used
+     * ones are freed from the GPU. The number of points drawn by all the octrees in one frame
+     * is limited by `set_point_budget()`.
+     *
+     * **Arguments**
+     * {const std::string} octree_path = Path to the octree file.
+     * {const std::string} name = Title to display for this point cloud.
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const Visualizer::ColorMode} color_mode = Type of coloring (see ColorMode).
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     * {const float} maximum_intensity_value = maximum value for the point's intensity.
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     * **Errors**
+     * If the file could not be opened this will display an error message, the returned
+     * point cloud will not be drawn.
+     *
+     */
+    PCMid add(const std::string octree_path,
+              const std::string name,
+              const algebraica::mat4f *transformation_matrix = nullptr,
+              const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+              const bool visible = true,
+              const float point_size = 1.0f,
+              const float maximum_intensity_value = 1.0f);
+    /*
+     * ### Loading a point cloud file
+     *
+     * This will add a point cloud read from a binary `*.pcd`, `*.las` or `*.traw` file (see
+     * `PointCloudFile`). The file is memory mapped and uploaded in blocks directly from the
+     * mapped pages, the points are never copied into a `std::vector` and files bigger than the
+     * memory can be loaded.
+     *
+     * **Arguments**
+     * {const std::string} path = Path to the point cloud file.
+     * {const std::string} name = Title to display for this point cloud.
+     * {const algebraica::mat4f*} transformation_matrix = Address to the transformation matrix
+     * that defines the coordinate system's origin and orientation.
+     * {const Visualizer::ColorMode} color_mode = Type of coloring (see ColorMode), use
+     * `Visualizer::NONE` to draw the file's colors.
+     * {const bool} visible = visibility of this point cloud.
+     * {const float} point_size = point size for each point in the cloud.
+     * {const float} maximum_intensity_value = maximum value for the point's intensity.
+     *
+     * **Returns**
+     * {PCMid} Point cloud identification number (use it for future modifications)
+     *
+     * **Errors**
+     * If the file could not be read this will display an error message, the returned
+     * point cloud will be empty.
+     *
+     */
+    PCMid load(const std::string path,
+               const std::string name,
+               const algebraica::mat4f *transformation_matrix = nullptr,
+               const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+               const bool visible = true,
+               const float point_size = 1.0f,
+               const float maximum_intensity_value = 255.0f);
+    /*
+     * ### Obtaining the origin of a point cloud file
+     *
+     * The positions of georeferenced `*.las` files (UTM or ECEF coordinates) are too big for
+     * floats, they are loaded relative to an origin (the center of the file's bounding box)
+     * computed in double precision. Use it to place the point cloud with its transformation
+     * matrix; it is zero for the other formats.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     * {double*} x = Address where the origin's x will be written.
+     * {double*} y = Address where the origin's y will be written.
+     * {double*} z = Address where the origin's z will be written.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found or it was not
+     * loaded from a file.
+     *
+     */
+    bool file_origin(PCMid id, double *x, double *y, double *z);
     /*
      * ### Changing the point cloud data input: 3D
      *
@@ -226,6 +458,126 @@ namespace Toreo {
      *
      */
     bool change_input(PCMid id, const std::vector<Visualizer::pointXYZRGBA> *point_cloud);
+    /*
+     * ### Changing the point cloud data input: quantized 3D with intensity
+     *
+     * This function changes the data input for the quantized **point cloud** with
+     * *identification number* = `id`, the positions are decoded with the last `scale` and
+     * `offset` (see `set_quantization()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const std::vector<Visualizer::pointXYZIq16>*} point_cloud = new address to a quantized
+     * point cloud's data.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool change_input(PCMid id, const std::vector<Visualizer::pointXYZIq16> *point_cloud);
+    /*
+     * ### Changing the point cloud data input: quantized 3D with RGBA colors
+     *
+     * This function changes the data input for the quantized **point cloud** with
+     * *identification number* = `id`, the positions are decoded with the last `scale` and
+     * `offset` (see `set_quantization()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const std::vector<Visualizer::pointXYZRGB8>*} point_cloud = new address to a quantized
+     * point cloud's data.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool change_input(PCMid id, const std::vector<Visualizer::pointXYZRGB8> *point_cloud);
+    /*
+     * ### Changing the point cloud data input: raw buffer
+     *
+     * This function changes the data input for the **point cloud** with *identification
+     * number* = `id` to an interleaved byte buffer, the last layout is kept if it is not
+     * defined (useful when subscribing a `TripleBuffer<std::vector<unsigned char> >`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const std::vector<unsigned char>*} point_cloud = new address to the point cloud bytes.
+     * {const Visualizer::PointLayout} layout = Fields of every point (see data types).
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool change_input(PCMid id, const std::vector<unsigned char> *point_cloud);
+    bool change_input(PCMid id, const std::vector<unsigned char> *point_cloud,
+                      const Visualizer::PointLayout layout);
+    /*
+     * ### Changing the point cloud data input: range image
+     *
+     * This function changes the range and intensity images of the **range image** point
+     * cloud with *identification number* = `id`, both must have rings x columns values.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const std::vector<unsigned short>*} range = new address to the ranges.
+     * {const std::vector<unsigned char>*} intensity = new address to the intensities.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool change_input(PCMid id, const std::vector<unsigned short> *range,
+                      const std::vector<unsigned char> *intensity = nullptr);
+    /*
+     * ### Changing the beam angles of a range image
+     *
+     * This function changes the elevation angle and the horizontal offset of every ring of
+     * the **range image** point cloud with *identification number* = `id`.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const std::vector<float>&} elevations = Elevation angle of every ring in radians.
+     * {const std::vector<float>&} azimuth_offsets = Horizontal offset of every ring in radians.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_beam_angles(PCMid id, const std::vector<float> &elevations,
+                         const std::vector<float> &azimuth_offsets = std::vector<float>());
+    /*
+     * ### Changing the azimuth of the columns of a range image
+     *
+     * The azimuth of the column `c` is `start + c * step`, by default `start = 0` and
+     * `step = 2 * pi / columns`.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const float} start = Azimuth of the first column in radians.
+     * {const float} step = Azimuth between consecutive columns in radians.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_azimuth(PCMid id, const float start, const float step);
+    /*
+     * ### Changing the decoding of quantized positions
+     *
+     * Quantized point clouds (`Visualizer::pointXYZIq16` and `Visualizer::pointXYZRGB8`)
+     * decode their positions as `(x / 32767) * scale + offset`.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const algebraica::vec3f} scale = Distance in meters represented by 32767 in each axis.
+     * {const algebraica::vec3f} offset = Position in meters of the point (0, 0, 0).
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_quantization(PCMid id, const algebraica::vec3f scale,
+                          const algebraica::vec3f offset = algebraica::vec3f());
     /*
      * ### Changing the visibility of a point cloud
      *
@@ -240,6 +592,238 @@ namespace Toreo {
      *
      */
     bool set_visibility(PCMid id, const bool visible = true);
+    /*
+     * ### Streaming a point cloud
+     *
+     * Point clouds that change every frame (lidar scans for example) should use the
+     * streaming mode: the points are copied into a persistently mapped buffer divided in
+     * 3 regions that are written in turns while the GPU still draws the previous ones.
+     * Updating the cloud costs one `memcpy` and it never waits for the GPU. If the driver
+     * does not support `glBufferStorage` (OpenGL 4.4) the regions are written with
+     * `glBufferSubData` instead.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const bool} streaming = `true` to use the streaming mode, `false` to use a
+     * normal buffer that is re-allocated in every update.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_streaming(PCMid id, const bool streaming = true);
+    /*
+     * ### Batching a point cloud
+     *
+     * Many small point clouds (radars or ultrasonic sensors for example) are limited by the
+     * CPU cost of drawing every one of them separately. Batched point clouds share one
+     * vertex buffer per point type, their transformation matrices, color modes and palettes
+     * are written into a texture buffer and all of them are drawn with one
+     * `glMultiDrawArraysIndirect` call per point type (OpenGL 4.3). Without it every cloud
+     * still uses one `glDrawArraysInstancedBaseInstance` call but no program, vertex array
+     * or uniform changes. Only point clouds of `pointXYZ`, `pointXYZI`, `pointXYZRGB` and
+     * `pointXYZRGBA` without streaming nor accumulation are batched, and they are drawn
+     * after the other point clouds.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const bool} batched = `true` to draw it in the batch, `false` to draw it separately.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_batched(PCMid id, const bool batched = true);
+    /*
+     * ### Processing a point cloud in the GPU
+     *
+     * Clips and colors the points with a compute shader after uploading them, so they do not
+     * have to be processed by the CPU: the points inside a box (the ego vehicle for example)
+     * or behind up to 4 planes are removed and the rest can be colored by their height or
+     * their range with the point cloud's colormap. The kept points are written compacted
+     * into another buffer and drawn with an indirect command filled by the shader. The
+     * points are processed again after every update or transformation. It needs OpenGL 4.3
+     * and point clouds with float fields that are not streamed, accumulated, batched nor
+     * read from files, the others are drawn without processing.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const Visualizer::PointProcessing*} processing = Processing settings (they are
+     * copied), `nullptr` disables the processing.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found or the compute
+     * shaders are not supported.
+     *
+     */
+    bool set_processing(PCMid id, const Visualizer::PointProcessing *processing);
+    /*
+     * ### Indexing a point cloud for picking and region queries
+     *
+     * Creates a spatial index (a hash of voxels) of the point cloud every time it is updated,
+     * the index is built by a worker thread and the queries use the last finished one, so
+     * they can be done while the cloud changes. Only point clouds with float positions
+     * (not quantized, octrees nor files) are indexed.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const bool} indexing = `true` to create the index, `false` to remove it.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_indexing(PCMid id, const bool indexing = true);
+    /*
+     * ### Picking a point
+     *
+     * Finds the point closest to the camera among the points drawn within `radius` pixels
+     * of the screen position (`x` to the right and `y` down from the top left corner of the
+     * window, in window coordinates as the mouse events). The point cloud must be indexed
+     * (see `set_indexing()`), it does not use OpenGL.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     * {const int} screen_x = horizontal position in pixels.
+     * {const int} screen_y = vertical position in pixels.
+     * {std::uint32_t*} index = position of the point in the point cloud's data.
+     * {algebraica::vec3f*} position = position of the point in the point cloud's coordinates.
+     * {const float} radius = maximum distance to the point in pixels.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found, it is not
+     * indexed or there is no point near the screen position.
+     *
+     */
+    bool nearest_point(PCMid id, const int screen_x, const int screen_y, std::uint32_t *index,
+                       algebraica::vec3f *position = nullptr, const float radius = 5.0f);
+    /*
+     * ### Picking a point of any point cloud
+     *
+     * Same as above but searching all the visible indexed point clouds, `id` receives the
+     * point cloud of the point closest to the camera.
+     *
+     * **Arguments**
+     * {const int} screen_x = horizontal position in pixels.
+     * {const int} screen_y = vertical position in pixels.
+     * {PCMid*} id = **id** of the point cloud of the found point.
+     * {std::uint32_t*} index = position of the point in the point cloud's data.
+     * {algebraica::vec3f*} position = position of the point in the point cloud's coordinates.
+     * {const float} radius = maximum distance to the point in pixels.
+     *
+     * **Returns**
+     * {bool} Returns `false` if there is no point near the screen position.
+     *
+     */
+    bool nearest_point(const int screen_x, const int screen_y, PCMid *id, std::uint32_t *index,
+                       algebraica::vec3f *position = nullptr, const float radius = 5.0f);
+    /*
+     * ### Finding the points inside a sphere
+     *
+     * Writes the indices (positions in the point cloud's data) of the points within `radius`
+     * meters of `center`, in the point cloud's coordinates. The point cloud must be indexed
+     * (see `set_indexing()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     * {const algebraica::vec3f&} center = center of the sphere.
+     * {const float} radius = radius of the sphere in meters.
+     * {std::vector<std::uint32_t>*} indices = found points, the vector is emptied first.
+     *
+     * **Returns**
+     * {std::size_t} Number of points found.
+     *
+     */
+    std::size_t points_in_radius(PCMid id, const algebraica::vec3f &center, const float radius,
+                                 std::vector<std::uint32_t> *indices);
+    /*
+     * ### Finding the points inside a box
+     *
+     * Writes the indices (positions in the point cloud's data) of the points inside the axis
+     * aligned box from `minimum` to `maximum`, in the point cloud's coordinates. The point
+     * cloud must be indexed (see `set_indexing()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     * {const algebraica::vec3f&} minimum = corner of the box with the smallest coordinates.
+     * {const algebraica::vec3f&} maximum = corner of the box with the biggest coordinates.
+     * {std::vector<std::uint32_t>*} indices = found points, the vector is emptied first.
+     *
+     * **Returns**
+     * {std::size_t} Number of points found.
+     *
+     */
+    std::size_t points_in_box(PCMid id, const algebraica::vec3f &minimum,
+                              const algebraica::vec3f &maximum,
+                              std::vector<std::uint32_t> *indices);
+    /*
+     * ### Downsampling a point cloud before uploading it
+     *
+     * Dense point clouds can be reduced before every update: `Visualizer::VOXEL_GRID` keeps
+     * the first point inside every cube with sides = `value` meters and
+     * `Visualizer::RANDOM_SUBSET` keeps a fixed fraction = `value` of the points (the same
+     * points every update). The filtering uses all the processor cores and SIMD instructions,
+     * the original data is not modified. Quantized point clouds are not downsampled.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const Visualizer::Downsampling} downsampling = Type of downsampling (see data types).
+     * {const float} value = Leaf size in meters or fraction of points kept.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_downsampling(PCMid id, const Visualizer::Downsampling downsampling,
+                          const float value = 0.1f);
+    /*
+     * ### Accumulating the last scans of a point cloud
+     *
+     * Keeps the last `scans` updates of the point cloud in the GPU, every one with the pose
+     * and time it had when it was updated (see `accumulate()`), only the newest scan is
+     * uploaded in every update. The older scans fade out and disappear `fade_time` seconds
+     * after the newest one, the fading is done in the shader.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const unsigned int} scans = Number of scans kept, `0` disables the accumulation.
+     * {const float} fade_time = Seconds until a scan disappears, `0` means no fading.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool set_accumulation(PCMid id, const unsigned int scans, const float fade_time = 0.0f);
+    /*
+     * ### Adding a new scan to an accumulated point cloud
+     *
+     * Uploads the current data of the point cloud as its newest scan with the pose that the
+     * sensor had when it was captured (use it instead of `update()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to modify.
+     * {const algebraica::mat4f&} pose = Pose of the scan in the coordinate system of the
+     * transformation matrix.
+     * {const double} timestamp = Capture time in seconds, a negative value uses the
+     * current time.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool accumulate(PCMid id, const algebraica::mat4f &pose, const double timestamp = -1.0);
+    /*
+     * ### Changing the point budget of the octrees
+     *
+     * Maximum number of points drawn in one frame by all the octree point clouds (see
+     * `add(octree_path)`), the nodes with the biggest level of detail error are drawn first.
+     * Three times this quantity is kept in GPU memory as cache.
+     *
+     * **Arguments**
+     * {const std::size_t} points = maximum number of points per frame.
+     *
+     */
+    void set_point_budget(const std::size_t points = 5000000u);
     /*
      * ### Changing the colormap's palette of a point cloud
      *
@@ -284,7 +868,8 @@ namespace Toreo {
      * ### Setting the transformation matrix
      *
      * This function changes the transformation matrix (coordinate system's origin and
-     * orientation) of the **point cloud** with *identification number* = `id`.
+     * orientation) of the **point cloud** with *identification number* = `id`. Only its address
+     * is kept: call `Core::request_redraw()` after you modify the values of the matrix.
      *
      * **Arguments**
      * {PCMid} id = **id** of the point cloud you want to modify.
@@ -390,6 +975,40 @@ namespace Toreo {
      *
      */
     bool update(PCMid id);
+    /*
+     * ### Updating part of the data of a point cloud
+     *
+     * Copies only the points from `first` to `first + count` of the point cloud's data (for
+     * example the sector of a rotating lidar that changed), the cost is proportional to the
+     * modified points. The GPU storage grows 50% over the size of the data, if the data
+     * becomes bigger than it, the whole point cloud is copied into a bigger storage. Points
+     * removed from the end of the data are not drawn anymore. Streamed, accumulated,
+     * batched, downsampled and file point clouds are always copied completely.
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to update.
+     * {const std::size_t} first = first modified point.
+     * {const std::size_t} count = number of modified points.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool update_range(PCMid id, const std::size_t first, const std::size_t count);
+    /*
+     * ### Updating the points added to a point cloud
+     *
+     * Copies only the points added at the end of the point cloud's data since its last
+     * update (see `update_range()`).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud you want to update.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool append(PCMid id);
     /*
      * ### Updating the data of every point cloud
      *
@@ -475,18 +1094,77 @@ namespace Toreo {
      *
      */
     void connect_all(boost::signals2::signal<void ()> *signal);
+    /*
+     * ### Subscribing an specific point cloud to a triple buffer
+     *
+     * Producer threads (sensor drivers, for example) write into `source->back()` and call
+     * `source->publish()`, the point cloud with *identification number* = `id` takes the newest
+     * snapshot and updates its data right before being drawn, without locks and without
+     * torn reads. Use it with `Core::execute_concurrently()` to receive data while drawing.
+     * The triple buffer must live longer than the point cloud, subscribe before the producer
+     * starts publishing (every publication requests a new frame).
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     * {TripleBuffer<std::vector<T> >*} source = Address to the triple buffer, `T` must be
+     * one of the point types accepted by `add()`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    template<typename T>
+    bool subscribe(PCMid id, TripleBuffer<std::vector<T> > *source){
+      if(point_clouds_.size() > id)
+        if(point_clouds_[id].point_cloud != nullptr){
+          point_clouds_[id].refresh = boost::bind(&PointCloudManager::consume<T>, this, id, source);
+          source->set_notifier(boost::bind(&PointCloudManager::request_redraw, this));
+          return true;
+        }else
+          return false;
+      else
+        return false;
+    }
+    /*
+     * ### Unsubscribing an specific point cloud from its triple buffer
+     *
+     * **Arguments**
+     * {PCMid} id = **id** of the point cloud.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the point cloud with **id** was **not** found.
+     *
+     */
+    bool unsubscribe(PCMid id);
 
   private:
-    void updated_camera();
+    void request_redraw();
+    float screen_factor();
+    // converts a position and a radius in pixels into normalized device coordinates
+    void screen_to_device(const int screen_x, const int screen_y, const float radius,
+                          float *x, float *y, float *device_radius);
+
+    template<typename T>
+    bool consume(PCMid id, TripleBuffer<std::vector<T> > *source){
+      if(!source->consume()) return false;
+      point_clouds_[id].point_cloud->change_input(source->front());
+      return true;
+    }
 
     Core *core_;
 
-    Shader *shader_;
-    GLint u_pv_;
+    Shader *shader_, *range_shader_;
+    // point_cloud.vert compiled for every Visualizer::ColorMode
+    Shader *shader_variants_[Visualizer::NONE + 1];
+    Shader *batch_shader_;
+    PointCloudBatch *batch_;
+    // point_cloud.comp, created by the first set_processing()
+    Shader *process_shader_;
     std::vector<Visualizer::PointCloudElement> point_clouds_;
+    std::size_t point_budget_;
 
-    boost::signals2::connection signal_updated_camera_, signal_draw_all_;
     boost::signals2::connection signal_updated_all_;
+    int render_pass_;
   };
   }
 
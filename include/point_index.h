@@ -0,0 +1,87 @@
+#ifndef TORERO_POINT_INDEX_H
+#define TORERO_POINT_INDEX_H
+
+#include "include/worker_pool.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Toreo {
+  // spatial index of a point cloud for picking and region queries: the points are sorted by
+  // voxel and every occupied voxel is found with a hash table (voxel -> range of points).
+  // The positions are copied by build() and the index is created by a worker thread, the
+  // queries use the last finished index (none until the first build finishes) and they can
+  // run while a new one is being built. The returned indices are positions in the array
+  // given to build().
+  class PointIndex
+  {
+  public:
+    PointIndex();
+    // waits until the running build finishes
+    ~PointIndex();
+
+    // copies the positions (three floats at position_offset bytes of every point, each
+    // point is stride bytes long) and creates the index in the worker thread, a build that
+    // has not started yet is replaced by the new one
+    void build(const void *points, const std::size_t count, const std::size_t stride,
+               const std::size_t position_offset = 0u);
+    // waits until the index of the last build() is created
+    void wait();
+    // returns true if an index was already created
+    bool is_ready();
+    // number of points of the current index
+    std::size_t size();
+
+    // picking: mvp = perspective-view-model matrix of the cloud, the points are converted to
+    // OpenGL axes (-y, z, -x) before it as in point_cloud.vert; x, y = normalized device
+    // coordinates of the cursor and radius = maximum distance in normalized device units
+    // (horizontal); finds the point closest to the camera among the points drawn within
+    // radius of the cursor, depth is its normalized device depth (-1 -> 1)
+    bool nearest(const float *mvp, const float x, const float y, const float radius,
+                 std::uint32_t *index, float *position = nullptr, float *depth = nullptr);
+    // points within radius of center, the coordinates are the same as the points'
+    std::size_t in_radius(const float *center, const float radius,
+                          std::vector<std::uint32_t> *indices);
+    // points inside the box from minimum to maximum (inclusive)
+    std::size_t in_box(const float *minimum, const float *maximum,
+                       std::vector<std::uint32_t> *indices);
+
+  private:
+    struct Cell{
+      std::uint64_t key;
+      std::uint32_t first, count;
+    };
+    struct Grid{
+      // positions sorted by voxel (x, y, z) and their index in the original points
+      std::vector<float> positions;
+      std::vector<std::uint32_t> indices;
+      // open addressing table of the occupied voxels, key = ~0 is empty
+      std::vector<Cell> cells;
+      std::size_t mask = 0u;
+      float voxel = 1.0f;
+      float minimum[3] = {0.0f, 0.0f, 0.0f};
+      float maximum[3] = {0.0f, 0.0f, 0.0f};
+      std::int32_t voxels[3] = {1, 1, 1};
+    };
+
+    void create(const boost::shared_ptr<std::vector<float> > positions);
+    boost::shared_ptr<const Grid> grid();
+
+    // points inside the box (and the sphere if center is not nullptr)
+    static void collect(const Grid &grid, const float *minimum, const float *maximum,
+                        const float *center, const float squared_radius,
+                        std::vector<std::uint32_t> *indices);
+    static const Cell *find(const Grid &grid, const std::int32_t x, const std::int32_t y,
+                            const std::int32_t z);
+    static std::int32_t voxel(const Grid &grid, const float value, const int axis);
+
+    boost::mutex mutex_;
+    boost::shared_ptr<const Grid> grid_;
+    WorkerPool *worker_;
+  };
+}
+
+#endif // TORERO_POINT_INDEX_H
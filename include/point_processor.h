@@ -0,0 +1,68 @@
+#ifndef TORERO_POINT_PROCESSOR_H
+#define TORERO_POINT_PROCESSOR_H
+
+#include "glad/glad.h"
+
+#include "include/buffer.h"
+#include "include/colormap.h"
+#include "include/definitions.h"
+#include "include/gl_extensions.h"
+#include "include/shader.h"
+#include "include/types.h"
+
+#include "algebraica/algebraica.h"
+
+namespace Toreo {
+  // GPU processing stage of a point cloud: a compute shader (point_cloud.comp) reads the
+  // uploaded points, removes the clipped ones, colors the rest and writes them compacted
+  // into its own buffer; the number of kept points is counted by the shader directly into
+  // a glDrawArraysIndirect command, the CPU never reads the points back.
+  // Every output point is 8 floats: x, y, z, intensity, red, green, blue and alpha.
+  // It needs OpenGL 4.3 (see GLExtensions::dispatch_compute)
+  class PointProcessor
+  {
+  public:
+    // shader_program = point_cloud.comp (see Shader::create_compute()), the attribute
+    // locations are the ones of point_cloud.vert
+    PointProcessor(Shader *shader_program, const GLint position, const GLint intensity,
+                   const GLint color, const GLint alpha);
+    ~PointProcessor();
+
+    // returns true if the compute shaders are supported
+    static bool is_supported();
+
+    void set_processing(const Visualizer::PointProcessing &processing);
+    const Visualizer::PointProcessing &processing();
+    // true if the output's colors come from the colormap (draw them as Visualizer::NONE)
+    const bool is_coloring();
+
+    // processes size points of input (a GL_ARRAY_BUFFER) with float fields at the offsets
+    // (in bytes, negative if the point does not have them), every point is stride bytes;
+    // model = secondary model of the point cloud (OpenGL axes, see point_cloud.vert)
+    // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
+    bool process(const GLuint input, const GLsizei size, const GLsizei stride,
+                 const GLint position, const GLint intensity,
+                 const GLint color, const GLint alpha,
+                 const algebraica::mat4f &model, Colormap &colormap);
+    // draws the output of the last process() with the current program
+    void draw();
+
+  private:
+    void reserve(const GLsizei size);
+
+    Shader *shader_;
+    Visualizer::PointProcessing processing_;
+
+    // compacted points and their indirect command (count, 1, 0, 0)
+    Buffer output_;
+    GLuint command_;
+    GLsizei capacity_;
+    GLint i_position_, i_intensity_, i_color_, i_alpha_;
+
+    GLint u_size_, u_stride_, u_position_, u_intensity_, u_color_, u_alpha_, u_model_;
+    GLint u_clip_box_, u_box_minimum_, u_box_maximum_, u_planes_, u_plane_;
+    GLint u_coloring_, u_coloring_minimum_, u_coloring_maximum_;
+  };
+}
+
+#endif // TORERO_POINT_PROCESSOR_H
@@ -0,0 +1,94 @@
+#ifndef TORERO_RANGE_IMAGE_CLOUD_H
+#define TORERO_RANGE_IMAGE_CLOUD_H
+
+#include "glad/glad.h"
+
+#include "include/buffer.h"
+#include "include/colormap.h"
+#include "include/definitions.h"
+#include "include/gl_state.h"
+#include "include/shader.h"
+#include "include/types.h"
+
+#include "algebraica/algebraica.h"
+
+#include <vector>
+
+namespace Toreo {
+  // organized scan of a spinning lidar (rings x columns) uploaded as a 16 bits range image and
+  // an 8 bits intensity image (3 bytes per point instead of 16 of pointXYZI), the points are
+  // reconstructed in the vertex shader (range_image.vert) with the elevation angle of every
+  // ring and the azimuth of every column:
+  //   azimuth   = azimuth_start + column * azimuth_step + azimuth_offset[ring]
+  //   range     = range_image[ring][column] * range_scale (0 = no return)
+  //   x, y, z   = range * (cos(elevation) * cos(azimuth), cos(elevation) * sin(azimuth),
+  //                        sin(elevation))
+  class RangeImageCloud
+  {
+  public:
+    // elevations = elevation angle of every ring in radians (ring 0 is the first row),
+    // range_scale = meters per range unit
+    RangeImageCloud(Shader *shader_program, const unsigned int rings, const unsigned int columns,
+                    const std::vector<float> &elevations, const float range_scale = 0.004f,
+                    const Visualizer::ColorMode color_mode = Visualizer::VARIABLE,
+                    const float point_size = 1.0f);
+    // frees the textures, the OpenGL context must still exist
+    ~RangeImageCloud();
+
+    // range and intensity contain rings x columns values (row major), without intensity all
+    // the points have intensity 0
+    void change_input(const std::vector<unsigned short> *range,
+                      const std::vector<unsigned char> *intensity = nullptr);
+    // elevation angle and horizontal offset of every ring in radians
+    void set_beam_angles(const std::vector<float> &elevations,
+                         const std::vector<float> &azimuth_offsets = std::vector<float>());
+    // azimuth of the first column and between consecutive columns in radians,
+    // by default: 0 and 2 * pi / columns
+    void set_azimuth(const float start, const float step);
+    void set_range_scale(const float range_scale);
+
+    // sets the colormap, color channels go from 0 to 255
+    // you must specify the size of the palette, the maximum readable size is 10 colors
+    void set_colormap(const algebraica::vec3f *colors, const unsigned int quantity = 1u);
+    void set_color_mode(const Visualizer::ColorMode color_mode = Visualizer::VARIABLE);
+    void set_transformation_matrix(const algebraica::mat4f *transformation_matrix);
+    void set_point_size(const float point_size = 1.0f);
+
+    // copies the range and intensity images into their textures
+    // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
+    bool update();
+    // draws the point cloud into the screen
+    // returns false if the GL_SHADER_PROGRAM was not created or compiled properly
+    bool draw();
+
+  private:
+    void create_texture(const GLuint texture, const GLenum internal_format,
+                        const GLsizei width, const GLsizei height);
+
+    Shader *shader_;
+    // the vertex array has no attributes, it is only required to draw
+    Buffer buffer_;
+    // range, intensity and beam angles
+    GLuint textures_[3];
+
+    const std::vector<unsigned short> *range_;
+    const std::vector<unsigned char> *intensity_;
+
+    unsigned int rings_, columns_;
+    float range_scale_, azimuth_start_, azimuth_step_;
+
+    const algebraica::mat4f *primary_model_;
+    algebraica::mat4f secondary_model_, identity_matrix_;
+    Visualizer::ColorMode color_mode_;
+    float point_size_;
+    algebraica::vec3f color_palette_[10];
+    unsigned int color_size_;
+    // the palette baked into a lookup texture (texture unit 3 of range_image.vert)
+    Colormap colormap_;
+
+    GLint u_primary_model_, u_secondary_model_, u_color_mode_;
+    GLint u_range_scale_, u_azimuth_start_, u_azimuth_step_, u_columns_;
+  };
+}
+
+#endif // TORERO_RANGE_IMAGE_CLOUD_H
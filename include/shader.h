@@ -3,8 +3,12 @@
 
 #include "glad/glad.h"
 
+#include "include/gl_extensions.h"
+#include "include/gl_state.h"
+
 #include "algebraica/algebraica.h"
 
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -20,31 +24,37 @@ namespace Toreo {
       is_created_(false),
       error_log_("Shader program not created yet...\n----------\n")
     {}
-    // Construct this object and creates this shader program
+    // Construct this object and creates this shader program, defines are preprocessor
+    // lines ("#define NAME value\n") inserted after the #version line of every stage,
+    // used to compile specialized variants of the same files; the lines #include "file" are
+    // replaced by the content of file (see include_files())
     Shader(const std::string vertex_path,
            const std::string fragment_path,
-           const std::string geometry_path = "") :
+           const std::string geometry_path = "",
+           const std::string defines = "") :
       id_(0),
       is_created_(false),
       error_log_()
     {
-      create(vertex_path, fragment_path, geometry_path);
+      create(vertex_path, fragment_path, geometry_path, defines);
     }
     // Deletes the shader program from OpenGL memory
     ~Shader(){
       if(is_created_)
-        glDeleteProgram(id_);
+        GLState::delete_program(id_);
     }
     // Creates the shader program if is not yet created
     bool operator()(const std::string vertex_path,
                     const std::string fragment_path,
-                    const std::string geometry_path = ""){
-      return create(vertex_path, fragment_path, geometry_path);
+                    const std::string geometry_path = "",
+                    const std::string defines = ""){
+      return create(vertex_path, fragment_path, geometry_path, defines);
     }
     // Creates the shader program
     bool create(const std::string vertex_path,
                 const std::string fragment_path,
-                const std::string geometry_path = ""){
+                const std::string geometry_path = "",
+                const std::string defines = ""){
       if(!is_created_){
         error_log_.clear();
 
@@ -136,6 +146,19 @@ namespace Toreo {
           std::string geometry_text;
           if(geometry) geometry_text = geometry_stream.str();
 
+          if(!include_files(&vertex_text, vertex_absolute_path) ||
+             !include_files(&fragment_text, fragment_absolute_path) ||
+             (geometry && !include_files(&geometry_text, geometry_absolute_path))){
+            is_created_ = false;
+            return false;
+          }
+
+          if(!defines.empty()){
+            insert_defines(&vertex_text, defines);
+            insert_defines(&fragment_text, defines);
+            if(geometry) insert_defines(&geometry_text, defines);
+          }
+
           // convert stream into const char*
           const char *vertex_code{vertex_text.c_str()};
           const char *fragment_code{fragment_text.c_str()};
@@ -230,6 +253,83 @@ namespace Toreo {
         return false;
       }
     }
+    // Creates a compute shader program (GLSL 4.30), it must be loaded first
+    // (see GLExtensions::dispatch_compute)
+    bool create_compute(const std::string compute_path, const std::string defines = ""){
+      if(!is_created_){
+        error_log_.clear();
+
+        std::string compute_absolute_path(compute_path);
+        if(compute_absolute_path.front() != '/')
+          compute_absolute_path = "/" + compute_absolute_path;
+
+        // Verifying the existence of the compute shader path
+        if(!boost::filesystem::exists(boost::filesystem::path(compute_absolute_path))){
+          compute_absolute_path = boost::filesystem::current_path().string() +
+                                  compute_absolute_path;
+
+          if(!boost::filesystem::exists(boost::filesystem::path(compute_absolute_path))){
+            error_log_ = "The file: " + compute_path + " was not found.\n" +
+                         "  Neither: " + compute_absolute_path + "\n";
+            return false;
+          }
+        }
+
+        std::ifstream compute_file(compute_absolute_path);
+        if(!compute_file.is_open()){
+          error_log_ += "The compute shader: " + compute_absolute_path +
+                        " was not opened.\n----------\n";
+          return false;
+        }
+
+        std::stringstream compute_stream;
+        compute_stream << compute_file.rdbuf();
+        compute_file.close();
+
+        std::string compute_text(compute_stream.str());
+        if(!include_files(&compute_text, compute_absolute_path)) return false;
+        if(!defines.empty()) insert_defines(&compute_text, defines);
+        const char *compute_code{compute_text.c_str()};
+
+        GLint has_succed;
+        char info_log[512];
+        GLsizei info_size;
+        is_created_ = true;
+
+        GLuint compute_shader{glCreateShader(GL_COMPUTE_SHADER)};
+        glShaderSource(compute_shader, 1, &compute_code, NULL);
+        glCompileShader(compute_shader);
+        // check for shader compile errors
+        glGetShaderiv(compute_shader, GL_COMPILE_STATUS, &has_succed);
+        if(has_succed == GL_FALSE){
+          glGetShaderInfoLog(compute_shader, 512, &info_size, info_log);
+          error_log_ += "\n### Compute shader compilation failed...\n\n" +
+                        std::string(info_log, info_size) + "\n----------\n";
+          is_created_ = false;
+        }
+
+        id_ = glCreateProgram();
+        glAttachShader(id_, compute_shader);
+        glLinkProgram(id_);
+        // check for linking errors
+        glGetProgramiv(id_, GL_LINK_STATUS, &has_succed);
+        if(has_succed == GL_FALSE){
+          glGetProgramInfoLog(id_, 512, &info_size, info_log);
+          error_log_ += "\n### Shader program linking failed...\n\n" +
+                        std::string(info_log, info_size) +
+                        "\n----------\n";
+          is_created_ = false;
+        }
+        glDetachShader(id_, compute_shader);
+        glDeleteShader(compute_shader);
+
+        use();
+        return is_created_;
+      }else{
+        error_log_ += "The shader was previously created.\n----------\n";
+        return false;
+      }
+    }
     // Returns true if the shader program was properly created
     bool is_created(){
       return is_created_;
@@ -240,7 +340,7 @@ namespace Toreo {
     }
     // activate the shader
     bool use(){
-      glUseProgram(id_);
+      GLState::use_program(id_);
       return is_created_;
     }
     // returns the program id
@@ -307,6 +407,59 @@ namespace Toreo {
     }
 
   private:
+    // the #version directive must be the first line of the source, #line keeps the line
+    // numbers of the compilation errors
+    static void insert_defines(std::string *text, const std::string &defines){
+      std::size_t position{text->find("#version")};
+      if(position != std::string::npos) position = text->find('\n', position);
+      if(position == std::string::npos)
+        text->insert(0, defines + "\n#line 1\n");
+      else
+        text->insert(position + 1, defines + "\n#line 2\n");
+    }
+    // replaces every line #include "file" by the content of file (relative to the directory
+    // of path), used for the blocks shared by several shaders like camera.glsl
+    bool include_files(std::string *text, const std::string &path){
+      const std::string directory{boost::filesystem::path(path).parent_path().string()};
+
+      std::size_t position{text->find("#include")};
+      while(position != std::string::npos){
+        if(position > 0 && (*text)[position - 1] != '\n'){
+          position = text->find("#include", position + 1);
+          continue;
+        }
+
+        const std::size_t end{std::min(text->find('\n', position), text->size())};
+        const std::size_t first{text->find('"', position)};
+        const std::size_t last{first < end ? text->find('"', first + 1) : std::string::npos};
+        if(last >= end){
+          error_log_ += "Invalid #include in: " + path + "\n----------\n";
+          return false;
+        }
+
+        const std::string include_path{directory + "/" + text->substr(first + 1, last - first - 1)};
+        std::ifstream include_file(include_path);
+        if(!include_file.is_open()){
+          error_log_ += "The file: " + include_path + " included by: " + path +
+                        " was not opened.\n----------\n";
+          return false;
+        }
+
+        std::stringstream include_stream;
+        include_stream << include_file.rdbuf();
+        std::string content(include_stream.str());
+        if(content.empty() || content.back() != '\n') content += '\n';
+        // #line keeps the line numbers of the rest of the file
+        const std::size_t line{static_cast<std::size_t>(
+                                 std::count(text->begin(), text->begin() + position, '\n')) + 2u};
+        content += "#line " + std::to_string(line) + "\n";
+
+        text->replace(position, std::min(end + 1, text->size()) - position, content);
+        position = text->find("#include", position + content.size());
+      }
+      return true;
+    }
+
     GLuint id_;
     bool is_created_;
     std::string error_log_;
@@ -6,6 +6,7 @@
 
 #include "include/buffer.h"
 #include "include/definitions.h"
+#include "include/gl_state.h"
 #include "include/shader.h"
 #include "include/types.h"
 
@@ -38,7 +39,6 @@ namespace Toreo {
     void check_path(std::string *path);
     void load_images();
     void load_ready();
-    void update_camera();
 
     void write_data_opengl(const Visualizer::ImageFile &image, const int level);
 
@@ -49,7 +49,7 @@ namespace Toreo {
     bool is_ready_, is_loaded_;
 
     Shader *sky_shader_;
-    GLint sky_u_pv_, sky_u_skybox_;
+    GLint sky_u_skybox_;
     GLuint sky_texture_id_;
 
     Buffer *buffer_cube_;
@@ -59,7 +59,7 @@ namespace Toreo {
     boost::thread runner_;
     boost::mutex protector_;
 
-    boost::signals2::connection signal_update_camera_, signal_update_screen_;
+    int render_pass_;
   };
 }
 
@@ -0,0 +1,148 @@
+#ifndef TORERO_STREAM_BUFFER_H
+#define TORERO_STREAM_BUFFER_H
+
+#include "glad/glad.h"
+
+#include "include/gl_extensions.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Toreo {
+  // GL_ARRAY_BUFFER divided in regions that are written in turns (ring buffer) while the GPU
+  // still reads the previous ones: a region is only written again after the fence of the last
+  // draw that used it was signaled, so uploading never waits for the GPU.
+  // With glBufferStorage the whole buffer is persistently and coherently mapped and writing a
+  // region is a plain memcpy; without it every write uses glBufferSubData into a region that
+  // is not in use.
+  class StreamBuffer
+  {
+  public:
+    // construct this StreamBuffer object, the storage is allocated with reserve()
+    StreamBuffer(const unsigned int regions = 3u) :
+      buffer_(0),
+      region_size_(0),
+      mapped_(nullptr),
+      next_(0),
+      fences_(regions > 0u ? regions : 1u, nullptr)
+    {}
+    // unmaps and frees the GL_ARRAY_BUFFER, the OpenGL context must still exist
+    ~StreamBuffer(){
+      destroy();
+    }
+    // allocates regions of size_in_bytes each, the previous data is lost; the buffer
+    // stays bound to GL_ARRAY_BUFFER (to define the attributes after it)
+    bool reserve(const GLsizeiptr size_in_bytes){
+      destroy();
+      if(size_in_bytes <= 0) return false;
+
+      region_size_ = size_in_bytes;
+      const GLsizeiptr total{region_size_ * static_cast<GLsizeiptr>(fences_.size())};
+
+      glGenBuffers(1, &buffer_);
+      glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+
+      if(GLExtensions::buffer_storage){
+        const GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+        GLExtensions::buffer_storage(GL_ARRAY_BUFFER, total, nullptr, flags);
+        mapped_ = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags));
+      }
+
+      if(!mapped_)
+        glBufferData(GL_ARRAY_BUFFER, total, nullptr, GL_STREAM_DRAW);
+
+      return true;
+    }
+    // returns true if the storage was allocated
+    bool is_created(){
+      return buffer_ != 0;
+    }
+    // returns true if the buffer is persistently mapped (glBufferStorage is supported)
+    bool is_persistent(){
+      return mapped_ != nullptr;
+    }
+    // size in bytes of each region
+    GLsizeiptr region_size(){
+      return region_size_;
+    }
+    // number of regions
+    unsigned int regions(){
+      return fences_.size();
+    }
+    // offset in bytes of the region "index" from the beginning of the buffer
+    GLintptr offset(const unsigned int index){
+      return region_size_ * index;
+    }
+    // returns the next region of the ring, if the GPU has not finished reading it yet
+    // this waits for it (with 3 regions it was used 2 updates ago, rarely happens)
+    unsigned int next_region(){
+      const unsigned int index{next_};
+      next_ = (next_ + 1u) % fences_.size();
+
+      if(fences_[index]){
+        GLenum result{glClientWaitSync(fences_[index], 0, 0)};
+        while(result == GL_TIMEOUT_EXPIRED)
+          result = glClientWaitSync(fences_[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        glDeleteSync(fences_[index]);
+        fences_[index] = nullptr;
+      }
+      return index;
+    }
+    // copies size_in_bytes of data into the region "index", size_in_bytes must not be
+    // bigger than region_size()
+    void write(const unsigned int index, const GLvoid *data, const GLsizeiptr size_in_bytes){
+      if(!data || size_in_bytes <= 0 || size_in_bytes > region_size_) return;
+
+      if(mapped_)
+        std::memcpy(mapped_ + offset(index), data, size_in_bytes);
+      else{
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glBufferSubData(GL_ARRAY_BUFFER, offset(index), size_in_bytes, data);
+      }
+    }
+    // call it after the draw calls that read the region "index"
+    void fence(const unsigned int index){
+      if(!mapped_) return;
+
+      if(fences_[index]) glDeleteSync(fences_[index]);
+      fences_[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    // binds this GL_ARRAY_BUFFER
+    void bind(){
+      glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    }
+    // frees the GL_ARRAY_BUFFER, reserve() must be called again before using it
+    void destroy(){
+      for(GLsync &fence : fences_)
+        if(fence){
+          glDeleteSync(fence);
+          fence = nullptr;
+        }
+
+      if(buffer_){
+        if(mapped_){
+          glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+          glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &buffer_);
+      }
+      buffer_ = 0;
+      region_size_ = 0;
+      mapped_ = nullptr;
+      next_ = 0;
+    }
+    // returns the buffer id
+    const GLuint id(){
+      return buffer_;
+    }
+
+  private:
+    GLuint buffer_;
+    GLsizeiptr region_size_;
+    unsigned char *mapped_;
+    unsigned int next_;
+    std::vector<GLsync> fences_;
+  };
+}
+
+#endif // TORERO_STREAM_BUFFER_H
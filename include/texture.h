@@ -5,6 +5,7 @@
 #include "glad/glad.h"
 
 #include "include/definitions.h"
+#include "include/gl_state.h"
 #include "include/types.h"
 
 #include <string>
@@ -26,16 +27,16 @@ namespace Toreo{
     }
     ~Texture(){
       if(is_created_)
-        glDeleteTextures(1, &id_);
+        GLState::delete_textures(1, &id_);
     }
 
     // Creates the texture object and loads the data. Requires the location's id from shader program
     bool create(Visualizer::ImageFile *texture){
       error_log_.clear();
       if(texture->data && !is_created_){
-        glActiveTexture(GL_TEXTURE0 + active_texture_);
+        GLState::active_texture(GL_TEXTURE0 + active_texture_);
         glGenTextures(1, &id_);
-        glBindTexture(GL_TEXTURE_2D, id_);
+        GLState::bind_texture(GL_TEXTURE_2D, id_);
         // set the texture wrapping parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -67,8 +68,8 @@ namespace Toreo{
     // activate this texture
     bool use(){
       if(is_created_){
-        glActiveTexture(GL_TEXTURE0 + active_texture_);
-        glBindTexture(GL_TEXTURE_2D, id_);
+        GLState::active_texture(GL_TEXTURE0 + active_texture_);
+        GLState::bind_texture(GL_TEXTURE_2D, id_);
       }
       return is_created_;
     }
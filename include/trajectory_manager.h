@@ -7,6 +7,7 @@
 #include "include/definitions.h"
 #include "include/trajectory.h"
 #include "include/shader.h"
+#include "include/triple_buffer.h"
 #include "include/texture.h"
 #include "include/types.h"
 
@@ -121,7 +122,8 @@ namespace Toreo {
      * ### Setting the transformation matrix
      *
      * This function changes the transformation matrix (coordinate system's origin and
-     * orientation) of the **trajectory** with *identification number* = `id`.
+     * orientation) of the **trajectory** with *identification number* = `id`. Only its address
+     * is kept: call `Core::request_redraw()` after you modify the values of the matrix.
      *
      * **Arguments**
      * {TMid} id = **id** of the trajectory you want to modify.
@@ -312,21 +314,71 @@ namespace Toreo {
      *
      */
     void connect_all(boost::signals2::signal<void ()> *signal);
+    /*
+     * ### Subscribing an specific trajectory to a triple buffer
+     *
+     * Producer threads (sensor drivers, for example) write into `source->back()` and call
+     * `source->publish()`, the trajectory with *identification number* = `id` takes the newest
+     * snapshot and updates its data right before being drawn, without locks and without
+     * torn reads. Use it with `Core::execute_concurrently()` to receive data while drawing.
+     * The triple buffer must live longer than the trajectory, subscribe before the producer
+     * starts publishing (every publication requests a new frame).
+     *
+     * **Arguments**
+     * {TMid} id = **id** of the trajectory.
+     * {TripleBuffer<std::vector<T> >*} source = Address to the triple buffer, `T` must be
+     * `Visualizer::Trajectory`.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the trajectory with **id** was **not** found.
+     *
+     */
+    template<typename T>
+    bool subscribe(TMid id, TripleBuffer<std::vector<T> > *source){
+      if(trajectories_.size() > id)
+        if(trajectories_[id].trajectory != nullptr){
+          trajectories_[id].refresh = boost::bind(&TrajectoryManager::consume<T>, this, id, source);
+          source->set_notifier(boost::bind(&TrajectoryManager::request_redraw, this));
+          return true;
+        }else
+          return false;
+      else
+        return false;
+    }
+    /*
+     * ### Unsubscribing an specific trajectory from its triple buffer
+     *
+     * **Arguments**
+     * {TMid} id = **id** of the trajectory.
+     *
+     * **Returns**
+     * {bool} Returns `false` if the trajectory with **id** was **not** found.
+     *
+     */
+    bool unsubscribe(TMid id);
 
   private:
-    void updated_camera();
+    void request_redraw();
+
+    template<typename T>
+    bool consume(TMid id, TripleBuffer<std::vector<T> > *source){
+      if(!source->consume()) return false;
+      trajectories_[id].trajectory->change_input(source->front());
+      return true;
+    }
+
     void initialize();
 
     Core *core_;
 
     Shader *shader_;
-    GLint u_pv_, u_point_light_, u_point_light_color_, u_directional_light_;
-    GLint u_directional_light_color_, u_camera_position_;
+    GLint u_point_light_, u_point_light_color_, u_directional_light_;
+    GLint u_directional_light_color_;
     std::vector<Visualizer::TrajectoryElement> trajectories_;
     Texture *solid_, *dotted_, *dashed_, *arrowed_;
 
-    boost::signals2::connection signal_updated_camera_, signal_draw_all_;
     boost::signals2::connection signal_updated_all_;
+    int render_pass_;
   };
 }
 
@@ -0,0 +1,85 @@
+#ifndef TORERO_TRIPLE_BUFFER_H
+#define TORERO_TRIPLE_BUFFER_H
+
+#include <boost/function.hpp>
+
+#include <atomic>
+
+namespace Toreo {
+  // lock-free single producer / single consumer triple buffer:
+  // the producer thread always writes into back() and calls publish() when the data is
+  // complete, the render thread calls consume() and reads front(); neither of them waits
+  // for the other and the consumer always sees the last complete snapshot (never a torn one)
+  template<typename T>
+  class TripleBuffer
+  {
+  public:
+    TripleBuffer() :
+      back_(0u),
+      front_(2u),
+      middle_(1u)
+    {}
+    // initializes the three buffers with the same value
+    explicit TripleBuffer(const T &initial_value) :
+      back_(0u),
+      front_(2u),
+      middle_(1u)
+    {
+      buffers_[0] = buffers_[1] = buffers_[2] = initial_value;
+    }
+
+    // producer side: buffer where the new data must be written
+    T *back(){
+      return &buffers_[back_];
+    }
+    // producer side: hands the back buffer over to the consumer, the previous middle
+    // buffer becomes the new back buffer (its content is an old snapshot)
+    void publish(){
+      back_ = middle_.exchange(back_ | fresh_bit_, std::memory_order_acq_rel) & index_mask_;
+      if(notifier_) notifier_();
+    }
+    // function called by publish() (in the producer thread) after every new snapshot,
+    // set it before the producer starts publishing
+    void set_notifier(const boost::function<void ()> &notifier){
+      notifier_ = notifier;
+    }
+    // consumer side: takes the last published buffer, returns false if nothing new
+    // was published since the last call
+    bool consume(){
+      if(!(middle_.load(std::memory_order_acquire) & fresh_bit_)) return false;
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask_;
+      return true;
+    }
+    // consumer side: last consumed snapshot, the address changes after consume()
+    const T *front() const{
+      return &buffers_[front_];
+    }
+    // returns true if there is a snapshot waiting to be consumed
+    bool has_new_data() const{
+      return middle_.load(std::memory_order_acquire) & fresh_bit_;
+    }
+    // index (0 to 2) of the buffers, useful when the data lives somewhere else
+    // (for example in a mapped OpenGL buffer divided in three regions)
+    unsigned int back_index() const{
+      return back_;
+    }
+    unsigned int front_index() const{
+      return front_;
+    }
+
+  private:
+    static const unsigned int index_mask_ = 3u;
+    static const unsigned int fresh_bit_ = 4u;
+
+    T buffers_[3];
+    // owned by the producer
+    unsigned int back_;
+    // owned by the consumer
+    unsigned int front_;
+    // shared: index of the middle buffer plus fresh_bit_ if it was not consumed yet
+    std::atomic<unsigned int> middle_;
+    boost::function<void ()> notifier_;
+  };
+}
+
+#endif // TORERO_TRIPLE_BUFFER_H
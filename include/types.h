@@ -2,12 +2,16 @@
 #define TORERO_TYPES_H
 
 #include "algebraica/algebraica.h"
+#include <boost/function.hpp>
 #include <boost/signals2.hpp>
 
 namespace Toreo {
   class Ground;
+  class GroundTiles;
   class Objects;
+  class OctreeCloud;
   class PointCloud;
+  class RangeImageCloud;
   class Trajectory;
   class ThreeDimensionalModelLoader;
 }
@@ -95,6 +99,12 @@ namespace Visualizer {
     std::string name;
     bool visibility;
     boost::signals2::connection connection;
+    // takes the newest published snapshot (see subscribe()), returns true if it changed
+    boost::function<bool ()> refresh;
+    // out-of-core cloud, used instead of point_cloud (see PointCloudManager::add(octree_path))
+    Toreo::OctreeCloud *octree = nullptr;
+    // organized lidar scan, used instead of point_cloud (see PointCloudManager::add(range))
+    Toreo::RangeImageCloud *range_image = nullptr;
   };
 
 #ifndef C_C_S
@@ -164,12 +174,91 @@ namespace Visualizer {
     float data[7];
   };
 
+  // quantized points: the position is stored as fixed-point 16 bits integers and decoded in
+  // the vertex shader as: position = (x / 32767) * scale + offset, scale and offset are
+  // defined per point cloud (scale = distance that 32767 represents)
+  // (8 bytes instead of 16 of pointXYZI), intensity range: 0 -> 255
+  struct pointXYZIq16{
+    short x;
+    short y;
+    short z;
+    unsigned char intensity;
+    // keeps every point 4 bytes aligned
+    unsigned char padding;
+  };
+  // (12 bytes instead of 24 of pointXYZRGB or 28 of pointXYZRGBA), colors range: 0 -> 255
+  struct pointXYZRGB8{
+    short x;
+    short y;
+    short z;
+    // keeps the color 4 bytes aligned
+    short padding;
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+  };
+
+  // attribute inside an interleaved point buffer (like a PointCloud2's field),
+  // a field with count = 0 does not exist
+  struct PointField{
+    // bytes from the beginning of the point
+    unsigned int offset = 0u;
+    // type of every component: GL_FLOAT, GL_INT, GL_UNSIGNED_SHORT, GL_UNSIGNED_BYTE...
+    unsigned int type = 0x1406u; // GL_FLOAT
+    // number of components: 3 for position and color, 1 for intensity and alpha;
+    // GL_BGRA (0x80E1) reads 4 bytes colors stored as blue, green, red, alpha
+    unsigned int count = 0u;
+    // integer values are mapped to 0 -> 1 (unsigned) or -1 -> 1 (signed)
+    bool normalized = false;
+  };
+  // fields of a point buffer
+  struct PointLayout{
+    // bytes between the beginning of two consecutive points
+    unsigned int stride = 0u;
+    PointField position;
+    PointField intensity;
+    PointField color;
+    PointField alpha;
+  };
+
   enum ColorMode : unsigned int{
     GRAYSCALE  = 0u,
     MONOCHROME = 1u,
     VARIABLE   = 2u,
     NONE       = 3u
   };
+  // preprocessing of a point cloud before uploading it (see Toreo::VoxelGrid)
+  enum Downsampling : unsigned int{
+    NO_DOWNSAMPLING = 0u,
+    // keeps one point per voxel (cube with sides = leaf size)
+    VOXEL_GRID      = 1u,
+    // keeps a fixed fraction of the points
+    RANDOM_SUBSET   = 2u
+  };
+  // color of the points computed by the GPU (see Toreo::PointProcessor)
+  enum PointColoring : unsigned int{
+    NO_COLORING     = 0u,
+    // height (z) of the point after the point cloud's translation and rotation
+    HEIGHT_COLORING = 1u,
+    // distance from the sensor (the origin of the point cloud's data)
+    RANGE_COLORING  = 2u
+  };
+  // processing of a point cloud in the GPU after uploading it, the coordinates are the ones
+  // of the point cloud after its translation and rotation (x forward, y left, z up)
+  struct PointProcessing{
+    // removes the points inside the box (the ego vehicle for example)
+    bool clip_box = false;
+    algebraica::vec3f box_minimum;
+    algebraica::vec3f box_maximum;
+    // removes the points behind any plane: x * a + y * b + z * c + d < 0 (up to 4)
+    unsigned int planes = 0u;
+    algebraica::vec4f plane[4];
+    // colors the points with the colormap: minimum -> first color, maximum -> last color
+    PointColoring coloring = NO_COLORING;
+    float coloring_minimum = 0.0f;
+    float coloring_maximum = 10.0f;
+  };
   // ------------------------------------------------------------------------------------ //
   // -------------------------------- OBJECT MANAGEMENT --------------------------------- //
   // ------------------------------------------------------------------------------------ //
@@ -222,6 +311,8 @@ namespace Visualizer {
     std::string name;
     bool visibility;
     boost::signals2::connection connection;
+    // takes the newest published snapshot (see subscribe()), returns true if it changed
+    boost::function<bool ()> refresh;
   };
 
   struct ObjectShaderHollow{
@@ -284,6 +375,8 @@ namespace Visualizer {
     std::string name;
     bool visibility;
     boost::signals2::connection connection;
+    // takes the newest published snapshot (see subscribe()), returns true if it changed
+    boost::function<bool ()> refresh;
   };
 
   struct TrajectoryShader{
@@ -379,6 +472,35 @@ namespace Visualizer {
   };
 #endif
 
+  // how the cells of a ground are drawn
+  enum GroundMode : unsigned int{
+    // every cell is a point expanded into a square or a box by ground.geom
+    GEOMETRY  = 0u,
+    // the cells are texels: colors in a RGBA8 texture and heights in a R16F texture,
+    // a Ground2D is drawn as one quad and a Ground3D as a heightfield (only grids, free
+    // grounds are drawn with GEOMETRY)
+    TEXTURE   = 1u,
+    // every cell is an instance of a square or a box (ground_instanced.vert)
+    INSTANCED = 2u,
+    // TEXTURE for the grids and INSTANCED for the free grounds, the fastest paths of
+    // benchmark/ground_paths at every size (default)
+    AUTOMATIC = 3u
+  };
+
+  // tile of a ground map (see Toreo::GroundTiles)
+  struct GroundTile{
+    // depth in the quadtree (0 = the whole map) and position of the tile in its level,
+    // x increases with the x axis (forward) and y with the y axis (to the left)
+    unsigned int level;
+    unsigned int x;
+    unsigned int y;
+    // covered area in meters: from (minimum_x, minimum_y) to
+    // (minimum_x + size, minimum_y + size)
+    float minimum_x;
+    float minimum_y;
+    float size;
+  };
+
   struct Ground2DShader{
     algebraica::vec3f position;
     algebraica::vec4f color;
@@ -395,6 +517,10 @@ namespace Visualizer {
     std::string name;
     bool visibility;
     boost::signals2::connection connection;
+    // takes the newest published snapshot (see subscribe()), returns true if it changed
+    boost::function<bool ()> refresh;
+    // tiled map, used instead of ground (see GroundManager::add_tiles())
+    Toreo::GroundTiles *tiles = nullptr;
   };
 
   // ------------------------------------------------------------------------------------ //
@@ -412,12 +538,42 @@ namespace Visualizer {
     CAMERA       = 8,
     GUI          = 9
   };
+  // number of drawing orders (see Order)
+  const int ORDER_COUNT = GUI + 1;
+  // drawing function registered in Core::add_render_pass()
+  struct RenderPass{
+    Order order;
+    int id;
+    boost::function<void ()> draw;
+  };
   enum Message : unsigned int {
     ERROR      = 0u,
     WARNING    = 1u,
     ATTENTION  = 2u,
     NORMAL     = 3u
   };
+  // ------------------------------------------------------------------------------------ //
+  // --------------------------------- FRAME STATISTICS --------------------------------- //
+  // ------------------------------------------------------------------------------------ //
+  // timing of one drawing pass (Visualizer::Order) in milliseconds
+  struct FrameTiming{
+    float cpu_minimum = 0.0f;
+    float cpu_average = 0.0f;
+    float cpu_p99 = 0.0f;
+    float gpu_minimum = 0.0f;
+    float gpu_average = 0.0f;
+    float gpu_p99 = 0.0f;
+    // number of frames used to calculate the values above
+    unsigned int cpu_samples = 0u;
+    unsigned int gpu_samples = 0u;
+  };
+  // OpenGL state changes of one frame (see GLState)
+  struct StateChanges{
+    // calls that reached the driver
+    unsigned int issued = 0u;
+    // redundant calls that were skipped
+    unsigned int skipped = 0u;
+  };
 }
 
 typedef int PCMid, MMid, MMelement, OMid, TMid, GMid;
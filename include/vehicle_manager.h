@@ -15,10 +15,12 @@
 #include <vector>
 
 namespace Toreo {
+  class Core;
+
   class VehicleManager
   {
   public:
-    VehicleManager();
+    explicit VehicleManager(Core *core);
     ~VehicleManager();
 
     void position(float *latitude = nullptr, float *longitude = nullptr,
@@ -30,12 +32,15 @@ namespace Toreo {
     void steering(float *angle = nullptr, float ratio = 3.0f);
 
     void connect(boost::signals2::signal<void ()> *signal);
+    // calculates the frames again and requests a redraw of the elements that use them
     void update();
 
     const algebraica::mat4f *navigation_frame() const;
     const algebraica::mat4f *vehicle_frame() const;
 
   private:
+    Core *core_;
+
     float null_;
     double null_d_;
 
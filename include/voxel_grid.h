@@ -0,0 +1,80 @@
+#ifndef TORERO_VOXEL_GRID_H
+#define TORERO_VOXEL_GRID_H
+
+#include "include/worker_pool.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Toreo {
+  // point cloud downsampling before uploading it: keeps the first point of every voxel
+  // (cube with sides = leaf size) or a fixed subset of the points.
+  // The voxel coordinates are computed 4 points at a time with SSE2 (when available) and the
+  // voxels are distributed by their hash between several threads, every thread removes the
+  // repeated voxels of its share with its own hash table (no locks). The calling thread
+  // and a WorkerPool (created by the first filter() that needs it) do the work.
+  // It does not use OpenGL, it can run in the thread that produces the points.
+  class VoxelGrid
+  {
+  public:
+    // threads = 0 uses all the cores
+    explicit VoxelGrid(const float leaf_size = 0.1f, const unsigned int threads = 0u);
+    // waits for the workers
+    ~VoxelGrid();
+    VoxelGrid(const VoxelGrid&) = delete;
+    VoxelGrid &operator=(const VoxelGrid&) = delete;
+
+    void set_leaf_size(const float leaf_size);
+    float leaf_size();
+
+    // keeps the first point of every voxel, the points are stride bytes long and their
+    // position are three floats (x, y, z) starting at position_offset bytes;
+    // the order of the points is preserved, returns the number of points in output
+    std::size_t filter(const void *points, const std::size_t count, const std::size_t stride,
+                       std::vector<unsigned char> *output, const std::size_t position_offset = 0u);
+    template<typename T>
+    std::size_t filter(const std::vector<T> &input, std::vector<T> *output){
+      select(input.data(), input.size(), sizeof(T), 0u);
+      output->resize(indices_.size());
+      for(std::size_t i = 0; i < indices_.size(); ++i)
+        (*output)[i] = input[indices_[i]];
+      return output->size();
+    }
+    // keeps approximately fraction (0 -> 1) of the points, the subset is chosen by a hash
+    // of the point index so the same points are kept every time (no flickering)
+    std::size_t random_subset(const void *points, const std::size_t count,
+                              const std::size_t stride, const float fraction,
+                              std::vector<unsigned char> *output);
+
+  private:
+    // fills indices_ with the index of the first point of every voxel
+    void select(const void *points, const std::size_t count, const std::size_t stride,
+                const std::size_t position_offset);
+    // computes the keys and hashes of the share (consecutive range of the count points)
+    // and distributes them into the buckets of every thread
+    void compute_keys(const unsigned char *points, const std::size_t stride,
+                      const std::size_t count, const unsigned int share,
+                      const unsigned int threads);
+    // removes the repeated voxels of the buckets of thread
+    void unique_keys(const unsigned int thread, const unsigned int threads);
+    // runs task(0) -> task(threads - 1), the last one in the calling thread
+    void run(const boost::function<void (unsigned int)> &task, const unsigned int threads);
+    void gather(const void *points, const std::size_t stride,
+                std::vector<unsigned char> *output);
+
+    float leaf_size_;
+    unsigned int threads_;
+
+    // voxel of every point: x, y and z coordinates packed in 21 bits each, and its hash
+    std::vector<std::uint64_t> keys_, hashes_;
+    // points of every share (rows) for every thread (columns): buckets_[share * threads +
+    // thread], thread = hash % threads; a thread reads its column in the points' order
+    std::vector<std::vector<std::uint32_t> > buckets_;
+    // kept points of every thread
+    std::vector<std::vector<std::uint32_t> > kept_;
+    std::vector<std::uint32_t> indices_;
+    WorkerPool *workers_;
+  };
+}
+
+#endif // TORERO_VOXEL_GRID_H
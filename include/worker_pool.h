@@ -0,0 +1,102 @@
+#ifndef TORERO_WORKER_POOL_H
+#define TORERO_WORKER_POOL_H
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace Toreo {
+  // fixed number of threads executing tasks in the order they were posted,
+  // the tasks must not use OpenGL (the workers do not have a context)
+  class WorkerPool
+  {
+  public:
+    explicit WorkerPool(const unsigned int threads = 2u) :
+      is_running_(true),
+      unfinished_(0u)
+    {
+      for(unsigned int i = 0; i < (threads > 0u ? threads : 1u); ++i)
+        threads_.push_back(new boost::thread(boost::bind(&WorkerPool::run, this)));
+    }
+    // discards the pending tasks and waits until the running ones finish
+    ~WorkerPool(){
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        is_running_ = false;
+        tasks_.clear();
+      }
+      condition_.notify_all();
+
+      for(boost::thread *thread : threads_){
+        thread->join();
+        delete thread;
+      }
+    }
+
+    // adds a task at the end of the queue
+    void post(const boost::function<void ()> &task){
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        tasks_.push_back(task);
+        ++unfinished_;
+      }
+      condition_.notify_one();
+    }
+    // discards the tasks that have not started yet
+    void clear(){
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        unfinished_ -= tasks_.size();
+        tasks_.clear();
+      }
+      finished_condition_.notify_all();
+    }
+    // waits until all the posted tasks (that were not discarded) have finished
+    void wait(){
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while(unfinished_ > 0u)
+        finished_condition_.wait(lock);
+    }
+    // number of tasks that have not started yet
+    std::size_t pending(){
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      return tasks_.size();
+    }
+
+  private:
+    void run(){
+      while(true){
+        boost::function<void ()> task;
+        {
+          boost::unique_lock<boost::mutex> lock(mutex_);
+          while(is_running_ && tasks_.empty())
+            condition_.wait(lock);
+          if(!is_running_) return;
+
+          task = tasks_.front();
+          tasks_.pop_front();
+        }
+        task();
+
+        {
+          boost::lock_guard<boost::mutex> lock(mutex_);
+          if(--unfinished_ > 0u) continue;
+        }
+        finished_condition_.notify_all();
+      }
+    }
+
+    bool is_running_;
+    // tasks posted and not finished yet
+    std::size_t unfinished_;
+    std::vector<boost::thread*> threads_;
+    std::deque<boost::function<void ()> > tasks_;
+    boost::mutex mutex_;
+    boost::condition_variable condition_, finished_condition_;
+  };
+}
+
+#endif // TORERO_WORKER_POOL_H
@@ -36,8 +36,7 @@ uniform vec3 u_light[4];
 uniform vec3 u_light_color[4];
 uniform vec3 u_sun;
 uniform vec3 u_sun_color;
-// Camera position
-uniform vec3 u_camera;
+#include "camera.glsl"
 
 //output color
 out vec4 frag_color;
@@ -123,7 +122,7 @@ void main()
 
   // input lighting data
   vec3 N = getNormalFromMap();
-  vec3 V = normalize(u_camera - o_position);
+  vec3 V = normalize(u_camera_position - o_position);
   vec3 R = reflect(-V, N);
 
   // calculate reflectance at normal incidence; if dia-electric (like plastic) use F0
@@ -15,10 +15,7 @@ out mat3 o_TBN;
 // translation, rotation and scale transformations for scene and object
 uniform mat4 u_scene_model;
 uniform mat4 u_object_model;
-// view matrix
-uniform mat4 u_view;
-// projection matrix
-uniform mat4 u_projection;
+#include "camera.glsl"
 
 void main()
 {
@@ -0,0 +1,9 @@
+// camera data shared by all the shaders, updated by Core (CAMERA_UNIFORM_BINDING);
+// Shader inserts it in place of the #include line of every shader that uses it
+layout(std140, binding = 0) uniform Camera{
+  mat4 u_pv;
+  mat4 u_view;
+  mat4 u_projection;
+  mat4 u_static_pv;
+  vec3 u_camera_position;
+};
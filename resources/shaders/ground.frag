@@ -3,7 +3,15 @@
 
 in vec3 f_position;
 in vec3 f_normal;
+// compiled with GROUND_TEXTURE for ground_texture.vert: the colors come from a texture
+// of the cells and the fog is calculated here
+#ifdef GROUND_TEXTURE
+in vec2 f_cell;
+layout(binding = 0) uniform sampler2D u_cells;
+uniform int u_fog;
+#else
 in vec4 f_color;
+#endif
 
 out vec4 frag_color;
 
@@ -13,8 +21,10 @@ uniform vec3 u_point_light_color[4];
 // directional light
 uniform vec3 u_directional_light;
 uniform vec3 u_directional_light_color;
-// camera positions
-uniform vec3 u_camera_position;
+#include "camera.glsl"
+
+// color of the fragment before the lights
+vec4 surface;
 
 const float shininess = 16.0;
 const float energy = (2.0 + shininess) / (2.0 * 3.14159265);
@@ -22,11 +32,11 @@ const float energy = (2.0 + shininess) / (2.0 * 3.14159265);
 vec3 calculate_point_light(const vec3 light, const vec3 color,
                            const vec3 viewDir){
   // ambient
-  vec3 ambient = 0.3 * f_color.rgb;
+  vec3 ambient = 0.3 * surface.rgb;
 
   vec3 lightDir = normalize(light - f_position);
   float diff = max(dot(lightDir, f_normal), 0.0);
-  vec3 diffuse = diff * f_color.rgb * 0.7;
+  vec3 diffuse = diff * surface.rgb * 0.7;
   // phong light
   vec3 reflectDir = reflect(-lightDir, f_normal);
   float spec = energy * pow(max(dot(viewDir, reflectDir), 0.0), shininess);
@@ -41,11 +51,11 @@ vec3 calculate_point_light(const vec3 light, const vec3 color,
 vec3 calculate_directional_light(const vec3 light, const vec3 color,
                                  const vec3 viewDir){
   // ambient
-  vec3 ambient = 0.3 * f_color.rgb;
+  vec3 ambient = 0.3 * surface.rgb;
 
   vec3 lightDir = normalize(light);
   float diff = max(dot(lightDir, f_normal), 0.0);
-  vec3 diffuse = diff * f_color.rgb * 0.7;
+  vec3 diffuse = diff * surface.rgb * 0.7;
   // phong light
   vec3 reflectDir = reflect(-lightDir, f_normal);
   float spec = energy * pow(max(dot(viewDir, reflectDir), 0.0), shininess);
@@ -55,8 +65,28 @@ vec3 calculate_directional_light(const vec3 light, const vec3 color,
   return (ambient + diffuse + specular);
 }
 
+#ifdef GROUND_TEXTURE
+// the same fog as ground.geom
+float calcule_fog(vec3 position, float alpha){
+  const float density = 0.010;
+  const float gradient = 3.0;
+
+  float distance = length((u_view * vec4(position, 1.0)).xyz);
+  float visibility = clamp(exp(-pow((distance * density), gradient)), 0.0, 1.0);
+
+  return alpha * visibility;
+}
+#endif
+
 void main()
 {
+#ifdef GROUND_TEXTURE
+  surface = texture(u_cells, f_cell);
+  if(u_fog == 1) surface.a = calcule_fog(f_position, surface.a);
+#else
+  surface = f_color;
+#endif
+
   vec3 color = vec3(0.0);
   // view direction
   vec3 viewDir = normalize(u_camera_position - f_position);
@@ -69,5 +99,5 @@ void main()
                                        u_directional_light_color,
                                        viewDir);
 
-  frag_color = vec4(color, f_color.a);
+  frag_color = vec4(color, surface.a);
 }
@@ -1,10 +1,11 @@
 #version 420 core
 // Ground vertex shader
 
-in vec3 i_position;
-in vec4 i_color;
-in vec2 i_dimension;
-in float i_height;
+// fixed locations: ground_instanced.vert uses the same vertex array
+layout(location = 0) in vec3 i_position;
+layout(location = 1) in vec4 i_color;
+layout(location = 2) in vec2 i_dimension;
+layout(location = 3) in float i_height;
 
 out vec4 g_color;
 out vec2 g_dimension;
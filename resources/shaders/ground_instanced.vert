@@ -0,0 +1,108 @@
+#version 420 core
+// Ground vertex shader of the instanced mode (see Toreo::Ground): the same cells as
+// ground.vert but every cell is an instance (per instance attributes) and its square or box
+// is built here from gl_VertexID, as ground.geom does, without a geometry shader
+
+// the same locations as ground.vert, both programs use the same vertex array
+layout(location = 0) in vec3 i_position;
+layout(location = 1) in vec4 i_color;
+layout(location = 2) in vec2 i_dimension;
+layout(location = 3) in float i_height;
+
+#include "camera.glsl"
+
+uniform mat4 u_primary_model;
+uniform mat4 u_secondary_model;
+
+uniform int u_fog;
+uniform int u_2D;
+uniform int u_free;
+uniform int u_polar;
+
+uniform float u_width;
+uniform float u_length;
+uniform vec3 u_position;
+
+// toroidal grid (see ground.geom)
+uniform int u_scrolling;
+uniform ivec4 u_scroll;
+uniform vec2 u_offset;
+
+out vec3 f_position;
+out vec3 f_normal;
+out vec4 f_color;
+
+// the faces of THE BOX of ground.geom as triangles: left, right, top, back and front;
+// corner bits: 1 = top, 2 = right (+x), 4 = back (-z); a 2D cell only draws the top face
+const int box_corners[30] = int[30](
+  4, 5, 0, 0, 5, 1,
+  2, 3, 6, 6, 3, 7,
+  3, 1, 7, 7, 1, 5,
+  6, 7, 4, 4, 7, 5,
+  0, 1, 2, 2, 1, 3
+);
+
+const vec3 box_normals[5] = vec3[5](
+  vec3(-1.0, 0.0, 0.0), // left
+  vec3( 1.0, 0.0, 0.0), // right
+  vec3( 0.0, 1.0, 0.0), // up
+  vec3( 0.0, 0.0,-1.0), // back
+  vec3( 0.0, 0.0, 1.0)  // front
+);
+
+// the same fog as ground.geom
+float calcule_fog(vec4 position, float alpha){
+  const float density = 0.010;
+  const float gradient = 3.0;
+
+  float distance = length((u_view * position).xyz);
+  float visibility = clamp(exp(-pow((distance * density), gradient)), 0.0, 1.0);
+
+  return alpha * visibility;
+}
+
+void main()
+{
+  mat4 model = u_primary_model * u_secondary_model;
+  mat3 rotation = mat3(model);
+
+  // ground.vert: the cell's position with y and z swapped
+  vec3 cell = i_position;
+  if(u_polar == 1)
+    cell = vec3(i_position.x * cos(i_position.y), i_position.x * sin(i_position.y), 0.0);
+  cell = cell.xzy;
+
+  vec4 center;
+  if(u_free == 1){
+    center = model * vec4(-cell.z, cell.y - 0.005, -cell.x, 1.0);
+  }else if(u_scrolling == 1){
+    ivec2 stored = ivec2(round(vec2(cell.z, cell.x)));
+    vec2 window = vec2((stored - u_scroll.xy + u_scroll.zw) % u_scroll.zw);
+    vec2 meters = u_offset + (window + 0.5) * vec2(u_length, u_width);
+    center = model * vec4(-meters.y, u_position.z - 0.005, -meters.x, 1.0);
+  }else{
+    center = model * vec4(-u_position.y + cell.x * u_width,
+                           u_position.z - 0.005,
+                          -u_position.x + cell.z * u_length,
+                           1.0);
+  }
+
+  vec4 color = i_color / 255.0;
+  f_color = vec4(color.rgb, mix(color.a, calcule_fog(center, color.a), u_fog));
+
+  // flat cells are squares: the sides of the box have no area
+  bool flat_cell = (i_height > -0.005 && i_height < 0.005) || u_2D == 1;
+  float height = flat_cell ? 0.0 : i_height;
+  float border = flat_cell ? 0.0 : 0.001;
+  vec2 size = mix(vec2(u_width, u_length), i_dimension, float(u_free)) / 2.0;
+
+  int corner = box_corners[gl_VertexID];
+  vec3 offset = vec3(((corner & 2) != 0) ? size.x - border : -size.x + border,
+                     ((corner & 1) != 0) ? height : 0.0,
+                     ((corner & 4) != 0) ? -size.y + border : size.y - border);
+
+  vec4 position = center + vec4(rotation * offset, 0.0);
+  f_position = position.xyz;
+  f_normal = normalize(rotation * box_normals[gl_VertexID / 6]);
+  gl_Position = u_pv * position;
+}
@@ -0,0 +1,81 @@
+#version 420 core
+// Ground vertex shader of the texture mode (see Toreo::Ground): a Ground2D grid is one
+// quad and a Ground3D grid is a heightfield with one quad per cell, the vertices are
+// generated from gl_VertexID (no vertex attributes) and the cells are read from textures
+
+#include "camera.glsl"
+
+uniform mat4 u_primary_model;
+uniform mat4 u_secondary_model;
+
+// size of the grid in meters
+uniform float u_width;
+uniform float u_length;
+// quads through the length and the width of the grid
+uniform ivec2 u_divisions;
+uniform int u_3D;
+// cube's height of every cell in meters (Ground3D), interpolated at the corners
+layout(binding = 1) uniform sampler2D u_heights;
+// toroidal grid (see Toreo::Ground::set_scrolling()): first cell of the window inside the
+// textures (x, y) and number of cells, the textures repeat
+uniform int u_scrolling;
+uniform ivec4 u_scroll;
+// first cell of the window relative to the navigation frame (x forward, y to the left)
+uniform vec2 u_offset;
+
+out vec3 f_position;
+out vec3 f_normal;
+out vec2 f_cell;
+
+// two triangles per quad
+const ivec2 corners[6] = ivec2[6](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1),
+                                  ivec2(0, 1), ivec2(1, 0), ivec2(1, 1));
+
+// texture coordinates of a point of the window (0 -> 1 through the length and the width)
+vec2 texel(const vec2 cell){
+  return (u_scrolling == 1)? cell + vec2(u_scroll.xy) / vec2(u_scroll.zw) : cell;
+}
+
+float height(const vec2 cell){
+  if(u_3D == 0) return 0.0;
+  // the borders of the window are not neighbours in a toroidal grid
+  if(u_scrolling == 1){
+    vec2 half_cell = 0.5 / vec2(u_scroll.zw);
+    return texture(u_heights, texel(clamp(cell, half_cell, 1.0 - half_cell))).r;
+  }
+  return texture(u_heights, cell).r;
+}
+
+void main()
+{
+  int quad = gl_VertexID / 6;
+  ivec2 corner = ivec2(quad % u_divisions.x, quad / u_divisions.x) + corners[gl_VertexID % 6];
+  // 0 -> 1 through the length and the width, the same coordinates as the textures
+  vec2 cell = vec2(corner) / vec2(u_divisions);
+  f_cell = texel(cell);
+
+  // the first cell is at the front left corner, as in ground.geom, or at the back right
+  // corner of a scrolling window (its cells increase with x and y)
+  float direction = (u_scrolling == 1)? -1.0 : 1.0;
+  float x = (u_scrolling == 1)? u_offset.x + u_length * cell.x : u_length * (0.5 - cell.x);
+  float y = (u_scrolling == 1)? u_offset.y + u_width * cell.y : u_width * (0.5 - cell.y);
+  float z = height(cell) - 0.005;
+
+  vec3 normal = vec3(0.0, 0.0, 1.0);
+  if(u_3D == 1){
+    vec2 step = 1.0 / vec2(u_divisions);
+    // x and y decrease when the texture coordinates increase (increase while scrolling)
+    float slope_x = (height(cell + vec2(step.x, 0.0)) - height(cell - vec2(step.x, 0.0))) /
+                    (2.0 * step.x * u_length);
+    float slope_y = (height(cell + vec2(0.0, step.y)) - height(cell - vec2(0.0, step.y))) /
+                    (2.0 * step.y * u_width);
+    normal = normalize(vec3(direction * slope_x, direction * slope_y, 1.0));
+  }
+
+  mat4 model = u_primary_model * u_secondary_model;
+  vec4 position = model * vec4(-y, z, -x, 1.0);
+
+  f_position = position.xyz;
+  f_normal = normalize(mat3(model) * vec3(-normal.y, normal.z, -normal.x));
+  gl_Position = u_pv * position;
+}
@@ -8,8 +8,7 @@ out vec4 f_color;
 
 uniform mat4 u_primary_model;
 uniform mat4 u_secondary_model;
-uniform mat4 u_view;
-uniform mat4 u_projection;
+#include "camera.glsl"
 uniform vec4 u_color;
 
 void main()
@@ -14,8 +14,7 @@ uniform vec3 u_point_light_color[4];
 // directional light
 uniform vec3 u_directional_light;
 uniform vec3 u_directional_light_color;
-// camera positions
-uniform vec3 u_camera_position;
+#include "camera.glsl"
 // ambient occlusion texture
 uniform sampler2D u_ao;
 // is it solid?
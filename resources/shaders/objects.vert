@@ -19,7 +19,7 @@ out vec2 f_uv;
 
 uniform mat4 u_primary_model;
 uniform mat4 u_secondary_model;
-uniform mat4 u_pv;
+#include "camera.glsl"
 
 // Rotate matrix by pitch, yaw, roll
 mat4 rotate_matrix(vec3 angles){
@@ -8,51 +8,73 @@ layout(location = 3) in float i_alpha;
 
 out vec4 o_color;
 
-uniform mat4 u_pv;
+// compiled variants (Visualizer::ColorMode): 0 = grayscale, 1 = monochrome, 2 = variable,
+// 3 = RGB(A); without COLOR_MODE the mode is chosen at runtime with u_color_mode
+#ifndef COLOR_MODE
+#define COLOR_MODE -1
+uniform float u_color_mode;
+#endif
+
+#include "camera.glsl"
 uniform mat4 u_primary_model;
 uniform mat4 u_secondary_model;
+// decoding of quantized positions (normalized integers), 1 and 0 for float positions
+uniform vec3 u_scale;
+uniform vec3 u_offset;
 
-uniform vec3 u_palette[10];       //this is the color palette
-uniform float u_color_size;       //this indicates the number of elements in the color palette
-uniform float u_color_mode;       //this is to turn all clouds in grayscale
+// palette interpolated in a lookup texture of 256 texels (see Toreo::Colormap)
+layout(binding = 0) uniform sampler1D u_colormap;
 uniform float u_intensity_range;
 uniform bool u_has_alpha;
+// accumulated scans: seconds since the newest scan and seconds until a scan disappears
+// (0 = no fading)
+uniform float u_age;
+uniform float u_fade_time;
+
+vec4 grayscale(){
+  return vec4(1.0, 1.0, 1.0, (i_intensity / u_intensity_range) * 0.9 + 0.1);
+}
+
+vec4 monochrome(){
+  return vec4(texelFetch(u_colormap, 0, 0).rgb, 1.0);
+}
+
+vec4 variable(){
+  float value = clamp(i_intensity / u_intensity_range, 0.0, 1.0);
+  return vec4(texture(u_colormap, value * (255.0 / 256.0) + 0.5 / 256.0).rgb, 1.0);
+}
+
+vec4 rgb(){
+  return vec4(i_color, (u_has_alpha)? i_alpha : 1.0);
+}
 
 void main()
 {
+  vec3 position = i_position * u_scale + u_offset;
   gl_Position = u_pv * u_primary_model * u_secondary_model *
-      vec4(-i_position.y, i_position.z, -i_position.x, 1.0f);
-
-  if(u_color_mode == 0.0f){
-    o_color.xyz = vec3(1.0, 1.0, 1.0);
-    o_color.a = (i_intensity / u_intensity_range) * 0.9 + 0.1;
-  }else if(u_color_mode == 1.0f){
-    o_color.xyz = u_palette[0];
-    o_color.a = 1.0;
-  }else if(u_color_mode == 2.0f){
-    o_color.a = i_intensity / u_intensity_range;
-
-    int idx1 = 0;// Our desired color will be between these two indexes in "color".
-    int idx2 = 0;
-    float fractBetween = 0.0f;// Fraction between "idx1" and "idx2" where our value is.
-
-    if(o_color.a <= 0.0){
-      idx1 = idx2 = 0;
-    }else if(o_color.a >= 1.0){
-      idx1 = idx2 = int(u_color_size) - 1;
-    }else{
-      o_color.a = o_color.a * (u_color_size - 1.0f);
-      idx1 = int(floor(o_color.a));// Our desired color will be after this index.
-      idx2 = idx1 + 1;// ... and before this index (inclusive).
-      fractBetween = o_color.a - float(idx1);// Distance between the two indexes (0-1).
-    }
-
-    o_color.xyz = (u_palette[idx2] - u_palette[idx1]) * fractBetween + u_palette[idx1];
-    o_color.a = 1.0;
-  }else if(u_color_mode == 3.0f){
-    o_color.xyz = i_color;
-    o_color.a = (u_has_alpha)? i_alpha : 1.0;
-  }else{
+      vec4(-position.y, position.z, -position.x, 1.0f);
+
+#if COLOR_MODE == 0
+  o_color = grayscale();
+#elif COLOR_MODE == 1
+  o_color = monochrome();
+#elif COLOR_MODE == 2
+  o_color = variable();
+#elif COLOR_MODE == 3
+  o_color = rgb();
+#else
+  if(u_color_mode == 0.0f)
+    o_color = grayscale();
+  else if(u_color_mode == 1.0f)
+    o_color = monochrome();
+  else if(u_color_mode == 2.0f)
+    o_color = variable();
+  else if(u_color_mode == 3.0f)
+    o_color = rgb();
+  else
     o_color = vec4(0.0);
-  }
-}
+#endif
+
+  if(u_fade_time > 0.0)
+    o_color.a *= clamp(1.0 - u_age / u_fade_time, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 420 core
+//batched point clouds vertex shader (see Toreo::PointCloudBatch)
+
+layout(location = 0) in vec3 i_position;
+layout(location = 1) in float i_intensity;
+layout(location = 2) in vec3 i_color;
+layout(location = 3) in float i_alpha;
+// index of the cloud's data, per instance: it is the baseInstance of the cloud's command
+layout(location = 4) in uint i_cloud;
+
+out vec4 o_color;
+
+#include "camera.glsl"
+// 6 texels per cloud: the 4 columns of its model matrix,
+// (color mode, intensity range, has alpha, point size) and (palette row, 0, 0, 0)
+layout(binding = 1) uniform samplerBuffer u_clouds;
+// one palette per row, 256 texels each (see Toreo::Colormap)
+layout(binding = 0) uniform sampler2D u_colormaps;
+
+void main()
+{
+  int base = int(i_cloud) * 6;
+  mat4 model = mat4(texelFetch(u_clouds, base), texelFetch(u_clouds, base + 1),
+                    texelFetch(u_clouds, base + 2), texelFetch(u_clouds, base + 3));
+  vec4 parameters = texelFetch(u_clouds, base + 4);
+  int row = int(texelFetch(u_clouds, base + 5).x);
+
+  gl_Position = u_pv * model * vec4(-i_position.y, i_position.z, -i_position.x, 1.0f);
+  gl_PointSize = parameters.w;
+
+  // the mode is the same for all the points of a command
+  float intensity = i_intensity / parameters.y;
+  if(parameters.x == 0.0f){
+    o_color = vec4(1.0, 1.0, 1.0, intensity * 0.9 + 0.1);
+  }else if(parameters.x == 1.0f){
+    o_color = vec4(texelFetch(u_colormaps, ivec2(0, row), 0).rgb, 1.0);
+  }else if(parameters.x == 2.0f){
+    vec2 coordinates = vec2(clamp(intensity, 0.0, 1.0) * (255.0 / 256.0) + 0.5 / 256.0,
+                            (float(row) + 0.5) / float(textureSize(u_colormaps, 0).y));
+    o_color = vec4(texture(u_colormaps, coordinates).rgb, 1.0);
+  }else if(parameters.x == 3.0f){
+    o_color = vec4(i_color, (parameters.z > 0.5)? i_alpha : 1.0);
+  }else{
+    o_color = vec4(0.0);
+  }
+}
@@ -0,0 +1,62 @@
+#version 420 core
+//range image vertex shader: every vertex is one pixel of the organized scan,
+//the point is reconstructed from its range and the beam angles (no vertex attributes)
+
+out vec4 o_color;
+
+#include "camera.glsl"
+uniform mat4 u_primary_model;
+uniform mat4 u_secondary_model;
+
+// rings x columns, ranges as 16 bits integers (0 = no return)
+layout(binding = 0) uniform usampler2D u_range;
+// rings x columns, intensities normalized to 0 -> 1
+layout(binding = 1) uniform sampler2D u_intensity;
+// one texel per ring: x = elevation angle, y = azimuth offset (radians)
+layout(binding = 2) uniform sampler2D u_beams;
+
+uniform float u_range_scale;      //meters per range unit
+uniform float u_azimuth_start;    //azimuth of the first column (radians)
+uniform float u_azimuth_step;     //azimuth between consecutive columns (radians)
+uniform int u_columns;
+
+// palette interpolated in a lookup texture of 256 texels (see Toreo::Colormap)
+layout(binding = 3) uniform sampler1D u_colormap;
+uniform float u_color_mode;       //this is to turn all clouds in grayscale
+
+void main()
+{
+  ivec2 pixel = ivec2(gl_VertexID % u_columns, gl_VertexID / u_columns);
+  float range = float(texelFetch(u_range, pixel, 0).r) * u_range_scale;
+
+  if(range <= 0.0){
+    // outside of the clipping volume, the point is discarded
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    o_color = vec4(0.0);
+    return;
+  }
+
+  vec2 beam = texelFetch(u_beams, ivec2(pixel.y, 0), 0).xy;
+  float azimuth = u_azimuth_start + float(pixel.x) * u_azimuth_step + beam.y;
+  float horizontal = range * cos(beam.x);
+  // sensor coordinates: x forward, y left, z up
+  vec3 position = vec3(horizontal * cos(azimuth), horizontal * sin(azimuth),
+                       range * sin(beam.x));
+
+  gl_Position = u_pv * u_primary_model * u_secondary_model *
+      vec4(-position.y, position.z, -position.x, 1.0f);
+
+  float intensity = texelFetch(u_intensity, pixel, 0).r;
+
+  if(u_color_mode == 0.0f){
+    o_color.xyz = vec3(1.0, 1.0, 1.0);
+    o_color.a = intensity * 0.9 + 0.1;
+  }else if(u_color_mode == 1.0f){
+    o_color.xyz = texelFetch(u_colormap, 0, 0).rgb;
+    o_color.a = 1.0;
+  }else{
+    float value = clamp(intensity, 0.0, 1.0);
+    o_color.xyz = texture(u_colormap, value * (255.0 / 256.0) + 0.5 / 256.0).rgb;
+    o_color.a = 1.0;
+  }
+}
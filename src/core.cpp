@@ -1,17 +1,35 @@
 #include "include/core.h"
 // Image loader
 #include "stb_image.h"
+#include "stb_image_write.h"
+
+#ifdef TORERO_EGL
+// headless context without display server
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 namespace Toreo {
-  Core::Core(int argc, char **argv) :
+  Core::Core(int argc, char **argv, const bool headless, const int width, const int height) :
     argc_(argc),
     argv_(argv),
     window_(nullptr),
-    width_(DEFAULT_WIDTH),
-    height_(DEFAULT_HEIGHT),
-    half_height_(DEFAULT_HEIGHT / 2),
+    headless_(headless),
+    egl_display_(nullptr),
+    egl_context_(nullptr),
+    framebuffer_(nullptr),
+    profiler_(nullptr),
+    camera_buffer_(0),
+    render_thread_(nullptr),
+    is_rendering_(false),
+    has_tasks_(false),
+    width_((width > 0)? width : DEFAULT_WIDTH),
+    height_((height > 0)? height : DEFAULT_HEIGHT),
+    half_height_(height_ / 2),
     position_x_(0),
     position_y_(0),
+    window_width_(width_),
+    window_height_(height_),
     error_log_(0),
     error_(false),
     is_left_click_(false),
@@ -21,6 +39,8 @@ namespace Toreo {
     old_y_(0),
     is_inversed_(false),
     has_changed_(true),
+    camera_changed_(false),
+    animations_(0),
     max_filtering_(0.0f),
     identity_matrix_(),
     fixed_frame_(&identity_matrix_),
@@ -28,83 +48,25 @@ namespace Toreo {
     navigation_frame_(&identity_matrix_),
     camera_(algebraica::vec3f(-12.0f, 0.0f, 5.0f), algebraica::vec3f(),
             algebraica::vec3f(0.0f, 0.0f, 1.0f), vehicle_frame_),
-    signal_draw_(9)
+    signal_draw_(Visualizer::ORDER_COUNT),
+    render_passes_(0),
+    next_render_pass_(0)
   {
-    // glfw: initialize and configure
-    // ------------------------------
-    if(!glfwInit()){
-      message_handler("GLFW initialization failed", Visualizer::ERROR);
-      error_log_ =  GLFW_NOT_LOADED;
-      error_ = true;
-    }else{
-      glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-      glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-      glfwWindowHint(GLFW_SAMPLES, 4);
-      glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-      glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-      glfwWindowHint(GLFW_DECORATED, GLFW_TRUE);
-      glfwWindowHint(GLFW_MAXIMIZED, GLFW_FALSE);
-      //glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-
-      // glfw window creation
-      // --------------------
-      const GLFWvidmode *screen{glfwGetVideoMode(glfwGetPrimaryMonitor())};
-      glfwWindowHint(GLFW_RED_BITS, screen->redBits);
-      glfwWindowHint(GLFW_GREEN_BITS, screen->greenBits);
-      glfwWindowHint(GLFW_BLUE_BITS, screen->blueBits);
-      glfwWindowHint(GLFW_REFRESH_RATE, screen->refreshRate);
-
-      window_ = glfwCreateWindow(width_, height_, "Torero", NULL, NULL);
-
-      if(!window_){
-        glfwTerminate();
-        message_handler("GLFW failed creating a window", Visualizer::ERROR);
-        error_log_ = WINDOW_NOT_LOADED;
-        error_ = true;
-      }else{
-        position_x_ = (screen->width - width_)/2;
-        position_y_ = (screen->height - height_)/2;
-        glfwSetWindowPos(window_, position_x_, position_y_);
-
-        // ------------------------------------------------------------------------------------ //
-        // ------------------------------- Loading window's icon ------------------------------ //
-        // ------------------------------------------------------------------------------------ //
-        load_window_icon();
-
-        glfwMakeContextCurrent(window_);
-
-        // glad: load all OpenGL function pointers
-        // ---------------------------------------
-        if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)){
-          glfwTerminate();
-          message_handler("Failed to initialize GLAD", Visualizer::ERROR);
-          error_log_ = GLAD_NOT_LOADED;
-          error_ = true;
-        }else{
-          glfwSwapInterval(1);
-
-          glfwSetFramebufferSizeCallback(window_, callback_resize);
-          glfwSetMouseButtonCallback(window_, callback_mouse_click);
-          glfwSetCursorPosCallback(window_, callback_mouse_move);
-          glfwSetScrollCallback(window_, callback_mouse_scroll);
-
-          signal_window_resize.connect(boost::bind(&Core::resize, this, _1, _2));
-          signal_mouse_click.connect(boost::bind(&Core::event_mouse_click, this, _1, _2));
-          signal_mouse_move.connect(boost::bind(&Core::event_mouse_move, this, _1, _2));
-          signal_mouse_scroll.connect(boost::bind(&Core::event_mouse_scroll, this, _1));
-
-          initialize();
-        }
-      }
-    }
+    if(headless_ ? create_headless_context() : create_window())
+      initialize();
   }
 
   boost::signals2::signal<void (int, int)> Core::signal_window_resize;
   boost::signals2::signal<void (int, int)> Core::signal_mouse_click;
   boost::signals2::signal<void (double, double)> Core::signal_mouse_move;
   boost::signals2::signal<void (double)> Core::signal_mouse_scroll;
+  boost::signals2::signal<void ()> Core::signal_window_refresh;
 
   Core::~Core(){
+    if(profiler_) delete profiler_;
+    if(framebuffer_) delete framebuffer_;
+    if(camera_buffer_) glDeleteBuffers(1, &camera_buffer_);
+    destroy_egl_context();
     if(window_){
       glfwDestroyWindow(window_);
       glfwTerminate();
@@ -163,6 +125,10 @@ namespace Toreo {
     return camera_.camera_position();
   }
 
+  const GLuint Core::camera_uniform_buffer(){
+    return camera_buffer_;
+  }
+
   const algebraica::mat4f *Core::fixed_frame() const{
     return fixed_frame_;
   }
@@ -176,10 +142,12 @@ namespace Toreo {
   }
 
   void Core::set_window_title(const std::string title){
-    glfwSetWindowTitle(window_, title.c_str());
+    if(window_ && !headless_)
+      glfwSetWindowTitle(window_, title.c_str());
   }
 
   void Core::set_window_size(const int width, const int height){
+    if(!window_ || headless_) return;
     const GLFWvidmode *screen{glfwGetVideoMode(glfwGetPrimaryMonitor())};
     width_ = (width <= 0)? screen->width : width;
     height_ = (height <= 0)? screen->height : height;
@@ -187,13 +155,23 @@ namespace Toreo {
     glfwSetWindowSize(window_, width_, height_);
   }
 
+  void Core::window_size(int *window_width, int *window_height,
+                         int *frame_width, int *frame_height){
+    if(window_width) *window_width = window_width_;
+    if(window_height) *window_height = window_height_;
+    if(frame_width) *frame_width = width_;
+    if(frame_height) *frame_height = height_;
+  }
+
   void Core::set_window_position(const int x, const int y){
     position_x_ = x;
     position_y_ = y;
-    glfwSetWindowPos(window_, x, y);
+    if(window_ && !headless_)
+      glfwSetWindowPos(window_, x, y);
   }
 
   void Core::maximize_window(const bool maximized){
+    if(!window_ || headless_) return;
     if(maximized)
       glfwMaximizeWindow(window_);
     else
@@ -201,6 +179,7 @@ namespace Toreo {
   }
 
   void Core::minimize_window(const bool minimized){
+    if(!window_ || headless_) return;
     if(minimized)
       glfwIconifyWindow(window_);
     else
@@ -208,6 +187,7 @@ namespace Toreo {
   }
 
   void Core::full_screen(const bool make_full){
+    if(!window_ || headless_) return;
     if(make_full){
       const GLFWvidmode *screen{glfwGetVideoMode(glfwGetPrimaryMonitor())};
       glfwSetWindowMonitor(window_, glfwGetPrimaryMonitor(), 0, 0,
@@ -221,48 +201,85 @@ namespace Toreo {
     paint();
   }
 
+  void Core::request_redraw(){
+    {
+      boost::lock_guard<boost::mutex> lock(redraw_mutex_);
+      has_changed_ = true;
+    }
+    redraw_condition_.notify_one();
+    // wakes up glfwWaitEvents() in the main thread
+    if(window_ && !headless_)
+      glfwPostEmptyEvent();
+  }
+
+  void Core::start_animation(){
+    ++animations_;
+    request_redraw();
+  }
+
+  void Core::stop_animation(){
+    if(animations_ > 0) --animations_;
+  }
+
   void Core::restart_viewport(){
-    glViewport(0, 0, width_, height_);
+    // cubemap's pre-computation releases its own framebuffer, the offscreen one
+    // must be bound again in headless mode
+    if(framebuffer_)
+      framebuffer_->bind();
+    else
+      glViewport(0, 0, width_, height_);
   }
 
   void Core::swap_buffers(){
-    glfwSwapBuffers(window_);
+    if(window_ && !headless_)
+      glfwSwapBuffers(window_);
   }
 
   void Core::wait_for_events(){
-    glfwWaitEvents();
+    if(window_) glfwWaitEvents();
   }
 
   void Core::wait_for_events(const double timeout){
-    glfwWaitEventsTimeout(timeout);
+    if(window_) glfwWaitEventsTimeout(timeout);
   }
 
   void Core::process_pending_events(){
-    glfwPollEvents();
+    if(window_) glfwPollEvents();
   }
 
   bool Core::window_visibility(){
+    if(!window_ || headless_) return false;
     return glfwGetWindowAttrib(window_, GLFW_VISIBLE);
   }
 
   bool Core::window_closing(){
+    if(!window_) return true;
     return glfwWindowShouldClose(window_);
   }
 
   int Core::execute(const bool infinite_loop){
-    if(!error_){
+    if(!error_ && headless_){
+      render_frame();
+      return EXIT_SUCCESS;
+    }else if(!error_){
       glfwShowWindow(window_);
       if(infinite_loop)
         while(!glfwWindowShouldClose(window_)){
-
-          if(glfwGetWindowAttrib(window_, GLFW_VISIBLE)){
+          // draws only if something changed, exchange() lets other threads request
+          // a new frame while this one is being drawn; a request made while the window
+          // is hidden or iconified is kept until it can be drawn
+          if(glfwGetWindowAttrib(window_, GLFW_VISIBLE) &&
+             !glfwGetWindowAttrib(window_, GLFW_ICONIFIED) &&
+             (has_changed_.exchange(false) || animations_ > 0)){
             paint();
 
             glfwSwapBuffers(window_);
           }
-          //glfwWaitEventsTimeout(0.1);
-          glfwWaitEvents();
-          //glfwPollEvents();
+
+          if(animations_ > 0)
+            glfwPollEvents();
+          else
+            glfwWaitEvents();
         }
       return EXIT_SUCCESS;
     }else{
@@ -272,7 +289,10 @@ namespace Toreo {
 
   int Core::execute(const int width, const int height, const std::string title,
                     const bool full_screen, const bool maximized, const bool infinite_loop){
-    if(!error_){
+    if(!error_ && headless_){
+      set_frame_size((width <= 0)? width_ : width, (height <= 0)? height_ : height);
+      return execute(infinite_loop);
+    }else if(!error_){
       if(maximized)
         glfwMaximizeWindow(window_);
 
@@ -290,12 +310,117 @@ namespace Toreo {
 
       glfwSetWindowPos(window_, (screen->width - width_)/2, (screen->height - height_)/2);
 
-      execute(infinite_loop);
+      return execute(infinite_loop);
     }else{
       return error_log_;
     }
   }
 
+  int Core::execute_concurrently(){
+    if(error_)
+      return error_log_;
+    else if(headless_)
+      return execute(false);
+
+    glfwShowWindow(window_);
+    // the context can only be current in one thread
+    glfwMakeContextCurrent(nullptr);
+
+    is_rendering_ = true;
+    render_thread_ = new boost::thread(boost::bind(&Core::render_loop, this));
+
+    while(!glfwWindowShouldClose(window_))
+      glfwWaitEvents();
+
+    is_rendering_ = false;
+    request_redraw();
+    render_thread_->join();
+    delete render_thread_;
+    render_thread_ = nullptr;
+
+    glfwMakeContextCurrent(window_);
+    run_tasks();
+    return EXIT_SUCCESS;
+  }
+
+  void Core::post(const boost::function<void ()> task){
+    {
+      boost::lock_guard<boost::mutex> lock(tasks_mutex_);
+      tasks_.push_back(task);
+      has_tasks_ = true;
+    }
+    request_redraw();
+  }
+
+  bool Core::is_headless() const{
+    return headless_;
+  }
+
+  bool Core::set_frame_size(const int width, const int height){
+    if(!headless_ || error_ || width <= 0 || height <= 0) return false;
+
+    if(!framebuffer_->create(width, height)){
+      message_handler(framebuffer_->error_log(), Visualizer::ERROR);
+      return false;
+    }
+    resize(width, height);
+    return true;
+  }
+
+  bool Core::render_frame(){
+    if(!headless_ || error_) return false;
+
+    framebuffer_->bind();
+    paint();
+    framebuffer_->release();
+    return true;
+  }
+
+  bool Core::read_frame(std::vector<unsigned char> *pixels, int *width, int *height){
+    if(!headless_ || error_) return false;
+
+    if(width) *width = framebuffer_->width();
+    if(height) *height = framebuffer_->height();
+    return framebuffer_->read_pixels(pixels);
+  }
+
+  bool Core::save_frame(const std::string path){
+    std::vector<unsigned char> pixels;
+    int width, height;
+
+    if(!read_frame(&pixels, &width, &height)) return false;
+
+    if(!stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4)){
+      message_handler("The frame could not be saved in: " + path, Visualizer::ERROR);
+      return false;
+    }
+    return true;
+  }
+
+  void Core::enable_profiling(const bool enable, const unsigned int history){
+    if(profiler_){
+      delete profiler_;
+      profiler_ = nullptr;
+    }
+    if(enable && !error_)
+      profiler_ = new FrameProfiler(signal_draw_.size(), history);
+  }
+
+  Visualizer::FrameTiming Core::frame_statistics(Visualizer::Order object){
+    if(profiler_)
+      return profiler_->statistics(object);
+    else
+      return Visualizer::FrameTiming();
+  }
+
+  void Core::reset_frame_statistics(){
+    if(profiler_) profiler_->reset();
+  }
+
+  Visualizer::StateChanges Core::state_statistics(){
+    return GLState::statistics();
+  }
+
   const GLfloat Core::max_anisotropic_filtering(){
     return max_filtering_;
   }
@@ -304,6 +429,29 @@ namespace Toreo {
     return &signal_draw_.at(object);
   }
 
+  int Core::add_render_pass(const Visualizer::Order order, const boost::function<void ()> pass){
+    Visualizer::RenderPass render_pass = { order, next_render_pass_++, pass };
+    std::vector<Visualizer::RenderPass>::iterator position{render_passes_.begin()};
+
+    while(position != render_passes_.end() && position->order <= order)
+      ++position;
+
+    render_passes_.insert(position, render_pass);
+    request_redraw();
+    return render_pass.id;
+  }
+
+  bool Core::remove_render_pass(const int id){
+    for(std::vector<Visualizer::RenderPass>::iterator pass = render_passes_.begin();
+        pass != render_passes_.end(); ++pass)
+      if(pass->id == id){
+        render_passes_.erase(pass);
+        request_redraw();
+        return true;
+      }
+    return false;
+  }
+
   boost::signals2::signal<void ()> *Core::signal_updated_camera(){
     return &signal_updated_camera_;
   }
@@ -333,40 +481,69 @@ namespace Toreo {
   void Core::initialize(){
     // configure global opengl state
     // -----------------------------
+    // new context: nothing is known about its state yet
+    GLState::invalidate();
     // setting the background color
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     // this line allows anti-aliasing to create fine edges
-    glEnable(GL_MULTISAMPLE);
+    GLState::enable(GL_MULTISAMPLE);
     // this line allows z-buffer to avoid rear objects to appear in front
-    glEnable(GL_DEPTH_TEST);
+    GLState::enable(GL_DEPTH_TEST);
     // set depth function to less than AND equal for skybox depth trick.
-    glDepthFunc(GL_LEQUAL);
+    GLState::depth_func(GL_LEQUAL);
     // enable seamless cubemap sampling for lower mip levels in the pre-filter map.
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-    glEnable(GL_PROGRAM_POINT_SIZE);
+    GLState::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    GLState::enable(GL_PROGRAM_POINT_SIZE);
     // these allow alpha transparency in the rendering
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::enable(GL_BLEND);
+    GLState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     // detects the maximum anisotropic filtering samples
     glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_filtering_);
     max_filtering_ = (max_filtering_ > 8.0f)? 8.0f : max_filtering_;
     // Avoiding the rendering of all back faces
     glCullFace(GL_BACK);
 
-    int window_width, window_height;
-    glfwGetWindowSize(window_, &window_width, &window_height);
-    camera_.set_resolution(window_width, window_height, width_, height_);
+    if(window_ && !headless_)
+      glfwGetWindowSize(window_, &window_width_, &window_height_);
+    // uniform buffer with the camera data: 4 matrices + 1 vec3 (padded to vec4 in std140)
+    glGenBuffers(1, &camera_buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, 4 * 16 * sizeof(GLfloat) + 4 * sizeof(GLfloat),
+                 nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, camera_buffer_);
+
+    camera_.set_resolution(window_width_, window_height_, width_, height_);
     camera_.set_function_callback(boost::bind(&Core::updated_camera, this));
+    update_camera_buffer();
   }
 
   void Core::paint(){
+    run_tasks();
+    // the camera could be modified from other threads, only this one has the context
+    if(camera_changed_.exchange(false)) update_camera_buffer();
+
     //clearing the screen of old information
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     signal_updated_screen_();
 
-    for(int i = 0; i < 9; ++i)
-      signal_draw_.at(i)();
+    GLState::begin_frame();
+    if(profiler_) profiler_->begin_frame();
+
+    const std::size_t passes{render_passes_.size()};
+    std::size_t pass{0};
+
+    for(int i = 0; i < Visualizer::ORDER_COUNT; ++i){
+      if(profiler_) profiler_->begin(i);
+
+      while(pass < passes && render_passes_[pass].order == i)
+        render_passes_[pass++].draw();
+      // user's code connected with syncronize()
+      signal_draw_[i]();
+
+      if(profiler_) profiler_->end(i);
+    }
   }
 
   void Core::resize(const int width, const int height){
@@ -375,14 +552,45 @@ namespace Toreo {
     height_ = height;
     half_height_ = height / 2;
 
+    if(!window_ || headless_){
+      window_width_ = width;
+      window_height_ = height;
+    }
+    camera_.set_resolution(window_width_, window_height_, width_, height_);
+
+    request_redraw();
+  }
+
+  void Core::event_resize(const int width, const int height){
+    // GLFW's window functions only work in the main thread
     int window_width, window_height;
     glfwGetWindowSize(window_, &window_width, &window_height);
-    camera_.set_resolution(window_width, window_height, width_, height_);
+    event_resized(width, height, window_width, window_height);
+  }
 
-    has_changed_ = true;
+  void Core::event_resized(const int width, const int height,
+                           const int window_width, const int window_height){
+    // the sizes are only written by the render thread
+    if(defer(boost::bind(&Core::event_resized, this, width, height, window_width,
+                         window_height)))
+      return;
+
+    window_width_ = window_width;
+    window_height_ = window_height;
+    resize(width, height);
   }
 
   void Core::event_mouse_click(int button, int action){
+    double posx, posy;
+    glfwGetCursorPos(window_, &posx, &posy);
+    event_mouse_clicked(button, action, posx, posy);
+  }
+
+  void Core::event_mouse_clicked(const int button, const int action,
+                                 const double posx, const double posy){
+    if(defer(boost::bind(&Core::event_mouse_clicked, this, button, action, posx, posy)))
+      return;
+
     if(button == GLFW_MOUSE_BUTTON_1)
       if(action == GLFW_PRESS)
         is_left_click_ = true;
@@ -399,8 +607,6 @@ namespace Toreo {
       else
         is_scroll_click_ = false;
 
-    double posx, posy;
-    glfwGetCursorPos(window_, &posx, &posy);
     old_x_ = floor(posx);
     old_y_ = floor(posy);
 
@@ -408,6 +614,8 @@ namespace Toreo {
   }
 
   void Core::event_mouse_move(double xpos, double ypos){
+    if(defer(boost::bind(&Core::event_mouse_move, this, xpos, ypos))) return;
+
     if(is_left_click_ || is_right_click_){
       int dx = (is_inversed_ && is_left_click_)? -xpos + old_x_ : xpos - old_x_;
       int dy = (is_inversed_ && is_left_click_)? -ypos + old_y_ : ypos - old_y_;
@@ -417,20 +625,286 @@ namespace Toreo {
       old_x_ = xpos;
       old_y_ = ypos;
 
-      has_changed_ = true;
     }
   }
 
   void Core::event_mouse_scroll(double yoffset){
+    if(defer(boost::bind(&Core::event_mouse_scroll, this, yoffset))) return;
+
     if(yoffset > 0.0)
       camera_.zooming();
     else
       camera_.zooming(false);
-    has_changed_ = true;
+  }
+
+  bool Core::defer(const boost::function<void ()> &task){
+    if(!render_thread_ || boost::this_thread::get_id() == render_thread_->get_id())
+      return false;
+
+    post(task);
+    return true;
+  }
+
+  void Core::run_tasks(){
+    if(!has_tasks_) return;
+
+    std::vector<boost::function<void ()> > tasks;
+    {
+      boost::lock_guard<boost::mutex> lock(tasks_mutex_);
+      tasks.swap(tasks_);
+      has_tasks_ = false;
+    }
+    for(const boost::function<void ()> &task : tasks)
+      task();
+  }
+
+  void Core::render_loop(){
+    glfwMakeContextCurrent(window_);
+
+    // the swap interval (v-sync) limits the frame rate
+    while(is_rendering_){
+      {
+        boost::unique_lock<boost::mutex> lock(redraw_mutex_);
+        while(is_rendering_ && !has_changed_ && animations_ == 0)
+          redraw_condition_.wait(lock);
+        has_changed_ = false;
+      }
+      if(!is_rendering_) break;
+
+      paint();
+      glfwSwapBuffers(window_);
+    }
+
+    glfwMakeContextCurrent(nullptr);
   }
 
   void Core::updated_camera(){
+    // the uniform buffer is updated by paint()
+    camera_changed_ = true;
     signal_updated_camera_();
+    request_redraw();
+  }
+
+  void Core::update_camera_buffer(){
+    if(!camera_buffer_) return;
+
+    const GLsizeiptr matrix{16 * sizeof(GLfloat)};
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_buffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, matrix, camera_.pv_matrix().data());
+    glBufferSubData(GL_UNIFORM_BUFFER, matrix, matrix, camera_.view_matrix().data());
+    glBufferSubData(GL_UNIFORM_BUFFER, 2 * matrix, matrix, camera_.perspective_matrix().data());
+    glBufferSubData(GL_UNIFORM_BUFFER, 3 * matrix, matrix,
+                    camera_.static_pv_matrix().data());
+    glBufferSubData(GL_UNIFORM_BUFFER, 4 * matrix, 3 * sizeof(GLfloat),
+                    camera_.camera_position().data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  bool Core::create_window(){
+    // glfw: initialize and configure
+    // ------------------------------
+    if(!glfwInit()){
+      message_handler("GLFW initialization failed", Visualizer::ERROR);
+      error_log_ =  GLFW_NOT_LOADED;
+      error_ = true;
+      return false;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_DECORATED, GLFW_TRUE);
+    glfwWindowHint(GLFW_MAXIMIZED, GLFW_FALSE);
+    //glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // glfw window creation
+    // --------------------
+    const GLFWvidmode *screen{glfwGetVideoMode(glfwGetPrimaryMonitor())};
+    glfwWindowHint(GLFW_RED_BITS, screen->redBits);
+    glfwWindowHint(GLFW_GREEN_BITS, screen->greenBits);
+    glfwWindowHint(GLFW_BLUE_BITS, screen->blueBits);
+    glfwWindowHint(GLFW_REFRESH_RATE, screen->refreshRate);
+
+    window_ = glfwCreateWindow(width_, height_, "Torero", NULL, NULL);
+
+    if(!window_){
+      glfwTerminate();
+      message_handler("GLFW failed creating a window", Visualizer::ERROR);
+      error_log_ = WINDOW_NOT_LOADED;
+      error_ = true;
+      return false;
+    }
+
+    position_x_ = (screen->width - width_)/2;
+    position_y_ = (screen->height - height_)/2;
+    glfwSetWindowPos(window_, position_x_, position_y_);
+
+    // ------------------------------------------------------------------------------------ //
+    // ------------------------------- Loading window's icon ------------------------------ //
+    // ------------------------------------------------------------------------------------ //
+    load_window_icon();
+
+    glfwMakeContextCurrent(window_);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)){
+      glfwDestroyWindow(window_);
+      window_ = nullptr;
+      glfwTerminate();
+      message_handler("Failed to initialize GLAD", Visualizer::ERROR);
+      error_log_ = GLAD_NOT_LOADED;
+      error_ = true;
+      return false;
+    }
+    // optional functions newer than OpenGL 4.2
+    GLExtensions::load((GLADloadproc) glfwGetProcAddress);
+
+    glfwSwapInterval(1);
+
+    glfwSetFramebufferSizeCallback(window_, callback_resize);
+    glfwSetMouseButtonCallback(window_, callback_mouse_click);
+    glfwSetCursorPosCallback(window_, callback_mouse_move);
+    glfwSetScrollCallback(window_, callback_mouse_scroll);
+    glfwSetWindowRefreshCallback(window_, callback_refresh);
+
+    signal_window_resize.connect(boost::bind(&Core::event_resize, this, _1, _2));
+    signal_mouse_click.connect(boost::bind(&Core::event_mouse_click, this, _1, _2));
+    signal_mouse_move.connect(boost::bind(&Core::event_mouse_move, this, _1, _2));
+    signal_mouse_scroll.connect(boost::bind(&Core::event_mouse_scroll, this, _1));
+    signal_window_refresh.connect(boost::bind(&Core::request_redraw, this));
+
+    return true;
+  }
+
+  bool Core::create_headless_context(){
+    // EGL surfaceless context: no display server needed (also works with llvmpipe)
+    // -----------------------------------------------------------------------------
+    bool has_context{create_egl_context()};
+
+    // fallback: an invisible GLFW window, it still needs a display (e.g. Xvfb)
+    // -------------------------------------------------------------------------
+    if(!has_context){
+      if(!glfwInit()){
+        message_handler("GLFW initialization failed", Visualizer::ERROR);
+        error_log_ = GLFW_NOT_LOADED;
+        error_ = true;
+        return false;
+      }
+
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+      glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+      glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+      glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+      window_ = glfwCreateWindow(1, 1, "Torero", NULL, NULL);
+
+      if(!window_){
+        glfwTerminate();
+        message_handler("GLFW failed creating a hidden window", Visualizer::ERROR);
+        error_log_ = WINDOW_NOT_LOADED;
+        error_ = true;
+        return false;
+      }
+
+      glfwMakeContextCurrent(window_);
+
+      if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)){
+        glfwDestroyWindow(window_);
+        window_ = nullptr;
+        glfwTerminate();
+        message_handler("Failed to initialize GLAD", Visualizer::ERROR);
+        error_log_ = GLAD_NOT_LOADED;
+        error_ = true;
+        return false;
+      }
+      GLExtensions::load((GLADloadproc) glfwGetProcAddress);
+    }
+
+    // offscreen framebuffer where everything will be drawn
+    // ----------------------------------------------------
+    framebuffer_ = new Framebuffer(0, 0, 4);
+    if(!framebuffer_->create(width_, height_)){
+      message_handler(framebuffer_->error_log(), Visualizer::ERROR);
+      error_log_ = FRAMEBUFFER_NOT_LOADED;
+      error_ = true;
+      return false;
+    }
+    framebuffer_->bind();
+
+    return true;
+  }
+
+  bool Core::create_egl_context(){
+#ifdef TORERO_EGL
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display{
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT")};
+
+    EGLDisplay display{EGL_NO_DISPLAY};
+    if(get_platform_display)
+      display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if(display == EGL_NO_DISPLAY)
+      display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)){
+      message_handler("EGL initialization failed, using a hidden window", Visualizer::WARNING);
+      error_log_ = EGL_NOT_LOADED;
+      return false;
+    }
+
+    const EGLint context_attributes[]{
+      EGL_CONTEXT_MAJOR_VERSION, 4,
+      EGL_CONTEXT_MINOR_VERSION, 2,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE
+    };
+
+    EGLContext context{EGL_NO_CONTEXT};
+    if(eglBindAPI(EGL_OPENGL_API))
+      context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attributes);
+
+    if(context == EGL_NO_CONTEXT
+       || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)){
+      if(context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+      eglTerminate(display);
+      message_handler("EGL failed creating a context, using a hidden window",
+                      Visualizer::WARNING);
+      error_log_ = EGL_NOT_LOADED;
+      return false;
+    }
+
+    egl_display_ = display;
+    egl_context_ = context;
+
+    if(!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)){
+      destroy_egl_context();
+      message_handler("Failed to initialize GLAD with EGL, using a hidden window",
+                      Visualizer::WARNING);
+      error_log_ = GLAD_NOT_LOADED;
+      return false;
+    }
+    GLExtensions::load((GLADloadproc) eglGetProcAddress);
+
+    error_log_ = 0;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void Core::destroy_egl_context(){
+#ifdef TORERO_EGL
+    if(egl_display_){
+      eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+      if(egl_context_) eglDestroyContext(egl_display_, egl_context_);
+      eglTerminate(egl_display_);
+    }
+#endif
+    egl_display_ = egl_context_ = nullptr;
   }
 
   void Core::load_window_icon(){
@@ -461,3 +935,7 @@ void callback_mouse_move(GLFWwindow *window, double xpos, double ypos){
 void callback_mouse_scroll(GLFWwindow *window, double xoffset, double yoffset){
   Toreo::Core::signal_mouse_scroll(yoffset);
 }
+
+void callback_refresh(GLFWwindow *window){
+  Toreo::Core::signal_window_refresh();
+}
@@ -47,9 +47,9 @@ namespace Toreo {
   }
 
   Cubemap::~Cubemap(){
-    glDeleteTextures(1, &irr_map_id_);
-    glDeleteTextures(1, &pfr_map_id_);
-    glDeleteTextures(1, &brdf_texture_id_);
+    GLState::delete_textures(1, &irr_map_id_);
+    GLState::delete_textures(1, &pfr_map_id_);
+    GLState::delete_textures(1, &brdf_texture_id_);
   }
 
   void Cubemap::bind_reflectance(){
@@ -57,12 +57,12 @@ namespace Toreo {
       load_ready();
 
     // bind pre-computed IBL data
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, irr_map_id_);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, pfr_map_id_);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, brdf_texture_id_);
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_CUBE_MAP, irr_map_id_);
+    GLState::active_texture(GL_TEXTURE1);
+    GLState::bind_texture(GL_TEXTURE_CUBE_MAP, pfr_map_id_);
+    GLState::active_texture(GL_TEXTURE2);
+    GLState::bind_texture(GL_TEXTURE_2D, brdf_texture_id_);
   }
 
   const bool Cubemap::is_ready(){
@@ -130,9 +130,9 @@ namespace Toreo {
 
         // pbr: setup cubemap to render to and attach to framebuffer
         // ---------------------------------------------------------
-        glActiveTexture(GL_TEXTURE0);
+        GLState::active_texture(GL_TEXTURE0);
         glGenTextures(1, &sky_texture_id_);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
 
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -178,9 +178,9 @@ namespace Toreo {
 
         // pbr: create an irradiance cubemap, and re-scale capture FBO to irradiance scale.
         // --------------------------------------------------------------------------------
-        glActiveTexture(GL_TEXTURE0);
+        GLState::active_texture(GL_TEXTURE0);
         glGenTextures(1, &irr_map_id_);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irr_map_id_);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, irr_map_id_);
 
         for(unsigned int i = 0; i < 6; ++i)
           glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0,
@@ -202,8 +202,8 @@ namespace Toreo {
         irradiance_shader_->set_value(irradiance_shader_->uniform_location("u_skybox"), 0);
         irradiance_shader_->set_value(irradiance_shader_->uniform_location("u_projection"),
                                       capture_projection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
+        GLState::active_texture(GL_TEXTURE0);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
 
         glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
         glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer_);
@@ -220,9 +220,9 @@ namespace Toreo {
 
         // pbr: create a pre-filter cubemap, and re-scale capture FBO to pre-filter scale.
         // --------------------------------------------------------------------------------
-        glActiveTexture(GL_TEXTURE1);
+        GLState::active_texture(GL_TEXTURE1);
         glGenTextures(1, &pfr_map_id_);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, pfr_map_id_);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, pfr_map_id_);
         for(unsigned int i = 0; i < 6; ++i)
           glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 128, 128, 0,
                        GL_RGB, GL_FLOAT, nullptr);
@@ -242,8 +242,8 @@ namespace Toreo {
         prefilter_shader_->set_value(prefilter_shader_->uniform_location("u_skybox"), 0);
         prefilter_shader_->set_value(prefilter_shader_->uniform_location("u_projection"),
                                      capture_projection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
+        GLState::active_texture(GL_TEXTURE0);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
 
         glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer_);
         unsigned int maxMipLevels = 5;
@@ -272,11 +272,11 @@ namespace Toreo {
 
         // pbr: generate a 2D LUT from the BRDF equations used.
         // ----------------------------------------------------
-        glActiveTexture(GL_TEXTURE2);
+        GLState::active_texture(GL_TEXTURE2);
         glGenTextures(1, &brdf_texture_id_);
 
         // pre-allocate enough memory for the LUT texture.
-        glBindTexture(GL_TEXTURE_2D, brdf_texture_id_);
+        GLState::bind_texture(GL_TEXTURE_2D, brdf_texture_id_);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -335,8 +335,8 @@ namespace Toreo {
         core_->restart_viewport();
 
         // Deleting skybox texture
-        glActiveTexture(GL_TEXTURE0);
-        glDeleteTextures(1, &sky_texture_id_);
+        GLState::active_texture(GL_TEXTURE0);
+        GLState::delete_textures(1, &sky_texture_id_);
         // Deleting extra texture buffers
         glDeleteFramebuffers(1, &frame_buffer_);
         glDeleteRenderbuffers(1, &render_buffer_);
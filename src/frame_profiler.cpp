@@ -0,0 +1,140 @@
+#include "include/frame_profiler.h"
+
+#include <algorithm>
+
+namespace Toreo {
+  FrameProfiler::FrameProfiler(const unsigned int passes, const unsigned int history) :
+    passes_(passes),
+    frame_(0u),
+    has_queries_(false),
+    queries_(frames_in_flight_ * passes, 0),
+    pending_(frames_in_flight_, false),
+    issued_(frames_in_flight_ * passes, false),
+    start_(passes),
+    cpu_(passes),
+    gpu_(passes)
+  {
+    for(unsigned int i = 0; i < passes_; ++i){
+      cpu_[i].values.resize(history > 0u ? history : 1u);
+      gpu_[i].values.resize(history > 0u ? history : 1u);
+    }
+  }
+
+  FrameProfiler::~FrameProfiler(){
+    if(has_queries_)
+      glDeleteQueries(queries_.size(), queries_.data());
+  }
+
+  void FrameProfiler::begin_frame(){
+    if(!has_queries_){
+      glGenQueries(queries_.size(), queries_.data());
+      has_queries_ = true;
+    }
+
+    // collecting every finished frame, the oldest one first
+    for(unsigned int i = 1; i <= frames_in_flight_; ++i)
+      collect((frame_ + i) % frames_in_flight_);
+
+    frame_ = (frame_ + 1u) % frames_in_flight_;
+
+    // if the GPU is still working on this frame's old queries they are not reused,
+    // this frame will only have CPU timing
+    if(!pending_[frame_])
+      for(unsigned int i = 0; i < passes_; ++i)
+        issued_[frame_ * passes_ + i] = false;
+  }
+
+  void FrameProfiler::begin(const unsigned int pass){
+    if(pass >= passes_) return;
+
+    start_[pass] = clock::now();
+
+    if(has_queries_ && !pending_[frame_]){
+      glBeginQuery(GL_TIME_ELAPSED, queries_[frame_ * passes_ + pass]);
+      issued_[frame_ * passes_ + pass] = true;
+    }
+  }
+
+  void FrameProfiler::end(const unsigned int pass){
+    if(pass >= passes_) return;
+
+    if(issued_[frame_ * passes_ + pass] && !pending_[frame_])
+      glEndQuery(GL_TIME_ELAPSED);
+
+    const std::chrono::duration<float, std::milli> elapsed{clock::now() - start_[pass]};
+    add_sample(&cpu_[pass], elapsed.count());
+
+    // the frame is pending after its last pass
+    if(pass == passes_ - 1u)
+      for(unsigned int i = 0; i < passes_; ++i)
+        if(issued_[frame_ * passes_ + i]){
+          pending_[frame_] = true;
+          break;
+        }
+  }
+
+  Visualizer::FrameTiming FrameProfiler::statistics(const unsigned int pass) const{
+    Visualizer::FrameTiming timing;
+    if(pass >= passes_) return timing;
+
+    calculate(cpu_[pass], &timing.cpu_minimum, &timing.cpu_average, &timing.cpu_p99);
+    calculate(gpu_[pass], &timing.gpu_minimum, &timing.gpu_average, &timing.gpu_p99);
+    timing.cpu_samples = cpu_[pass].size;
+    timing.gpu_samples = gpu_[pass].size;
+    return timing;
+  }
+
+  void FrameProfiler::reset(){
+    for(unsigned int i = 0; i < passes_; ++i){
+      cpu_[i].next = cpu_[i].size = 0u;
+      gpu_[i].next = gpu_[i].size = 0u;
+    }
+  }
+
+  void FrameProfiler::add_sample(Samples *samples, const float value){
+    samples->values[samples->next] = value;
+    samples->next = (samples->next + 1u) % samples->values.size();
+    if(samples->size < samples->values.size()) ++samples->size;
+  }
+
+  void FrameProfiler::collect(const unsigned int frame){
+    if(!pending_[frame]) return;
+
+    // the last query of the frame finishes last, if is not ready neither is the frame
+    for(unsigned int i = passes_; i > 0; --i)
+      if(issued_[frame * passes_ + i - 1]){
+        GLuint available{0};
+        glGetQueryObjectuiv(queries_[frame * passes_ + i - 1],
+                            GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) return;
+        break;
+      }
+
+    for(unsigned int i = 0; i < passes_; ++i)
+      if(issued_[frame * passes_ + i]){
+        GLuint64 nanoseconds{0};
+        glGetQueryObjectui64v(queries_[frame * passes_ + i], GL_QUERY_RESULT, &nanoseconds);
+        add_sample(&gpu_[i], nanoseconds / 1000000.0f);
+        issued_[frame * passes_ + i] = false;
+      }
+
+    pending_[frame] = false;
+  }
+
+  void FrameProfiler::calculate(const Samples &samples, float *minimum,
+                                float *average, float *p99){
+    if(samples.size == 0u) return;
+
+    std::vector<float> sorted(samples.values.begin(), samples.values.begin() + samples.size);
+
+    float sum{0.0f};
+    for(const float value : sorted) sum += value;
+
+    *average = sum / sorted.size();
+    *minimum = *std::min_element(sorted.begin(), sorted.end());
+
+    const std::size_t index{(sorted.size() * 99u) / 100u};
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    *p99 = sorted[index];
+  }
+}
@@ -0,0 +1,7 @@
+#include "include/gl_extensions.h"
+
+namespace Toreo {
+  GLExtensions::BufferStorageProc GLExtensions::buffer_storage = nullptr;
+  GLExtensions::MultiDrawArraysIndirectProc GLExtensions::multi_draw_arrays_indirect = nullptr;
+  GLExtensions::DispatchComputeProc GLExtensions::dispatch_compute = nullptr;
+}
@@ -0,0 +1,68 @@
+#include "include/gl_state.h"
+
+namespace Toreo {
+  GLState::State GLState::state_;
+
+  void GLState::delete_textures(const GLsizei n, const GLuint *textures){
+    glDeleteTextures(n, textures);
+    for(GLsizei i = 0; i < n; ++i)
+      for(unsigned int unit = 0; unit < texture_units_; ++unit){
+        if(state_.texture_1d[unit] == textures[i]) state_.texture_1d[unit] = unknown_;
+        if(state_.texture_2d[unit] == textures[i]) state_.texture_2d[unit] = unknown_;
+        if(state_.texture_cube_map[unit] == textures[i]) state_.texture_cube_map[unit] = unknown_;
+      }
+  }
+
+  void GLState::invalidate(){
+    state_.program = unknown_;
+    state_.vertex_array = unknown_;
+    state_.active_texture = unknown_;
+    for(unsigned int unit = 0; unit < texture_units_; ++unit)
+      state_.texture_1d[unit] = state_.texture_2d[unit] = state_.texture_cube_map[unit] = unknown_;
+
+    const GLenum capabilities[capabilities_] = {
+      GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_MULTISAMPLE, GL_PROGRAM_POINT_SIZE,
+      GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_TEXTURE_CUBE_MAP_SEAMLESS
+    };
+    for(unsigned int i = 0; i < capabilities_; ++i){
+      state_.capability[i] = capabilities[i];
+      state_.enabled[i] = -1;
+    }
+
+    state_.blend_source = state_.blend_destination = unknown_;
+    state_.depth_function = unknown_;
+    state_.depth_mask = -1;
+  }
+
+  void GLState::begin_frame(){
+    state_.last_frame.issued = state_.issued;
+    state_.last_frame.skipped = state_.skipped;
+    state_.issued = state_.skipped = 0u;
+  }
+
+  Visualizer::StateChanges GLState::statistics(){
+    return state_.last_frame;
+  }
+
+  void GLState::set_capability(const GLenum capability, const bool enable){
+    GLint *enabled{nullptr};
+    for(unsigned int i = 0; i < capabilities_; ++i)
+      if(state_.capability[i] == capability){
+        enabled = &state_.enabled[i];
+        break;
+      }
+
+    if(enabled && *enabled == static_cast<GLint>(enable)){
+      skip();
+      return;
+    }
+
+    if(enable)
+      glEnable(capability);
+    else
+      glDisable(capability);
+
+    if(enabled) *enabled = enable;
+    issue();
+  }
+}
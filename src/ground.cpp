@@ -1,6 +1,70 @@
 #include "include/ground.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TORERO_GROUND_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Toreo {
+  namespace {
+    // colors of the grounds go from 0 to 255
+    unsigned char channel(const float value){
+      return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+    }
+
+    bool same(const float a, const float b){
+      std::uint32_t x, y;
+      std::memcpy(&x, &a, sizeof(x));
+      std::memcpy(&y, &b, sizeof(y));
+      return x == y;
+    }
+
+    // first and last floats that are different in a and b (bits are compared, NaN == NaN),
+    // returns false if they are equal; 16 floats are compared at a time with SSE2
+    bool difference(const float *a, const float *b, const std::size_t size,
+                    std::size_t *first, std::size_t *last){
+      std::size_t i{0u};
+#ifdef TORERO_GROUND_SSE2
+      for(; i + 16u <= size; i += 16u){
+        __m128i equal{_mm_cmpeq_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)))};
+        for(std::size_t k = 4u; k < 16u; k += 4u)
+          equal = _mm_and_si128(equal, _mm_cmpeq_epi32(
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + k)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + k))));
+        if(_mm_movemask_epi8(equal) != 0xFFFF) break;
+      }
+#endif
+      while(i < size && same(a[i], b[i])) ++i;
+      if(i == size) return false;
+      *first = i;
+
+      std::size_t j{size};
+#ifdef TORERO_GROUND_SSE2
+      for(; j >= i + 16u; j -= 16u){
+        __m128i equal{_mm_cmpeq_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j - 16u)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j - 16u)))};
+        for(std::size_t k = 12u; k > 0u; k -= 4u)
+          equal = _mm_and_si128(equal, _mm_cmpeq_epi32(
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j - k)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j - k))));
+        if(_mm_movemask_epi8(equal) != 0xFFFF) break;
+      }
+#endif
+      while(same(a[j - 1u], b[j - 1u])) --j;
+      *last = j - 1u;
+      return true;
+    }
+  }
+
   Ground::Ground(Shader *ground_shader, const std::vector<Visualizer::Ground2D> *ground) :
     shader_(ground_shader),
     buffer_(true),
@@ -24,7 +88,21 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::Ground2DShader)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
@@ -52,7 +130,21 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::Ground3DShader)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
@@ -80,7 +172,21 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::FreeGround2D)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
@@ -108,7 +214,21 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::FreeGround3D)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
@@ -136,7 +256,21 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::FreePolarGround2D)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
@@ -164,13 +298,31 @@ namespace Toreo {
     secondary_model_(),
     identity_matrix_(),
     type_size_(sizeof(Visualizer::FreePolarGround3D)),
-    data_size_(0)
+    data_size_(0),
+    mode_(Visualizer::AUTOMATIC),
+    texture_shader_(nullptr),
+    cells_(),
+    colors_(0),
+    heights_(0),
+    texture_columns_(0u),
+    texture_rows_(0u),
+    uploaded_columns_(0u),
+    uploaded_rows_(0u),
+    snapshot_(0),
+    scrolling_frame_(nullptr),
+    scroll_x_(0),
+    scroll_y_(0),
+    instanced_shader_(nullptr)
   {
     initialize();
   }
 
+  Ground::~Ground(){
+    delete_textures();
+  }
+
   void Ground::change_input(const std::vector<Visualizer::Ground2D> *ground){
-    restart();
+    if(!ground_2D_) restart();
     ground_2D_ = ground;
     type_size_ = sizeof(Visualizer::Ground2DShader);
     is_free_ = 0;
@@ -178,7 +330,7 @@ namespace Toreo {
   }
 
   void Ground::change_input(const std::vector<Visualizer::Ground3D> *ground){
-    restart();
+    if(!ground_3D_) restart();
     ground_3D_ = ground;
     type_size_ = sizeof(Visualizer::Ground3DShader);
     is_free_ = 0;
@@ -186,7 +338,7 @@ namespace Toreo {
   }
 
   void Ground::change_input(const std::vector<Visualizer::FreeGround2D> *ground){
-    restart();
+    if(!free_ground_2D_) restart();
     free_ground_2D_ = ground;
     type_size_ = sizeof(Visualizer::FreeGround2D);
     is_free_ = 1;
@@ -194,7 +346,7 @@ namespace Toreo {
   }
 
   void Ground::change_input(const std::vector<Visualizer::FreeGround3D> *ground){
-    restart();
+    if(!free_ground_3D_) restart();
     free_ground_3D_ = ground;
     type_size_ = sizeof(Visualizer::FreeGround3D);
     is_free_ = 1;
@@ -202,7 +354,7 @@ namespace Toreo {
   }
 
   void Ground::change_input(const std::vector<Visualizer::FreePolarGround2D> *ground){
-    restart();
+    if(!polar_ground_2D_) restart();
     polar_ground_2D_ = ground;
     type_size_ = sizeof(Visualizer::FreePolarGround2D);
     is_free_ = 1;
@@ -210,7 +362,7 @@ namespace Toreo {
   }
 
   void Ground::change_input(const std::vector<Visualizer::FreePolarGround3D> *ground){
-    restart();
+    if(!polar_ground_3D_) restart();
     polar_ground_3D_ = ground;
     type_size_ = sizeof(Visualizer::FreePolarGround3D);
     is_free_ = 1;
@@ -238,6 +390,103 @@ namespace Toreo {
     fog_visibility_ = visible;
   }
 
+  void Ground::set_mode(const Visualizer::GroundMode mode){
+    if(mode_ == mode) return;
+
+    mode_ = mode;
+    uploaded_columns_ = uploaded_rows_ = 0u;
+    // the storage of the other mode is not needed anymore
+    if(is_textured()){
+      buffer_.vertex_bind();
+      buffer_.allocate_array(nullptr, 0, GL_DYNAMIC_DRAW);
+      buffer_.vertex_release();
+    }else
+      delete_textures();
+    update();
+  }
+
+  const Visualizer::GroundMode Ground::mode(){
+    return mode_;
+  }
+
+  void Ground::set_scrolling(const algebraica::mat4f *navigation_frame){
+    scrolling_frame_ = navigation_frame;
+    // the textures are created again with the new wrapping
+    delete_textures();
+    uploaded_columns_ = uploaded_rows_ = 0u;
+    update();
+  }
+
+  const bool Ground::is_scrolling(){
+    return scrolling_frame_ != nullptr && (ground_2D_ || ground_3D_);
+  }
+
+  void Ground::scrolling_window(int *x, int *y){
+    int first_x{0}, first_y{0};
+    if(scrolling_frame_){
+      // the navigation frame is in OpenGL axes: (-y, z, -x)
+      const float *frame{scrolling_frame_->data()};
+      first_x = static_cast<int>(std::floor(-frame[14] / element_length_)) -
+                static_cast<int>(quantity_length_ / 2u);
+      first_y = static_cast<int>(std::floor(-frame[12] / element_width_)) -
+                static_cast<int>(quantity_width_ / 2u);
+    }
+    if(x) *x = first_x;
+    if(y) *y = first_y;
+  }
+
+  bool Ground::scroll(){
+    if(!is_scrolling() || uploaded_columns_ != quantity_length_ ||
+       uploaded_rows_ != quantity_width_ || cells() < data_size_)
+      return update();
+
+    int x, y;
+    scrolling_window(&x, &y);
+    const int columns{static_cast<int>(quantity_length_)};
+    const int rows{static_cast<int>(quantity_width_)};
+    const int moved_x{x - scroll_x_}, moved_y{y - scroll_y_};
+
+    bool no_error{true};
+    if(std::abs(moved_x) >= columns || std::abs(moved_y) >= rows){
+      // nothing of the previous window is visible
+      scroll_x_ = x;
+      scroll_y_ = y;
+      no_error = update_region(0u, 0u, quantity_length_, quantity_width_);
+    }else{
+      // only the newly exposed columns (through the length) and rows (through the width)
+      if(moved_x != 0)
+        no_error = expose(moved_x > 0 ? scroll_x_ + columns : x, std::abs(moved_x), true);
+      if(moved_y != 0)
+        no_error = expose(moved_y > 0 ? scroll_y_ + rows : y, std::abs(moved_y), false) &&
+                   no_error;
+      scroll_x_ = x;
+      scroll_y_ = y;
+    }
+    return no_error;
+  }
+
+  void Ground::set_texture_shader(Shader *texture_shader){
+    texture_shader_ = texture_shader;
+    if(!texture_shader_) return;
+
+    texture_shader_->use();
+    u_texture_primary_model_   = texture_shader_->uniform_location("u_primary_model");
+    u_texture_secondary_model_ = texture_shader_->uniform_location("u_secondary_model");
+    u_texture_fog_             = texture_shader_->uniform_location("u_fog");
+    u_texture_width_           = texture_shader_->uniform_location("u_width");
+    u_texture_length_          = texture_shader_->uniform_location("u_length");
+    u_divisions_               = texture_shader_->uniform_location("u_divisions");
+    u_3D_                      = texture_shader_->uniform_location("u_3D");
+    u_texture_scrolling_       = texture_shader_->uniform_location("u_scrolling");
+    u_texture_scroll_          = texture_shader_->uniform_location("u_scroll");
+    u_texture_offset_          = texture_shader_->uniform_location("u_offset");
+  }
+  void Ground::set_instanced_shader(Shader *instanced_shader){
+    instanced_shader_ = instanced_shader;
+    if(instanced_shader_) cell_uniforms(instanced_shader_, &u_instanced_);
+  }
+
+
   void Ground::translate(const float x, const float y, const float z){
     secondary_model_.translate(x, y, z);
   }
@@ -263,33 +512,18 @@ namespace Toreo {
   }
 
   bool Ground::update(){
+    if(is_textured()) return update_textures();
+
     bool no_error{shader_->use()};
 
     if(no_error){
-      Visualizer::Ground2DShader ground_2d;
-      Visualizer::Ground3DShader ground_3d;
-      int o{0}, u{0};
-      float quantity_width{static_cast<float>(quantity_width_)};
-      float quantity_length{static_cast<float>(quantity_length_)};
-
       if(ground_2D_){
         data_size_ = quantity_width_ * quantity_length_;
 
         if(ground_2D_->size() >= data_size_){
-          std::vector<Visualizer::Ground2DShader> ground(data_size_);
-
-          for(float i = 0; i < quantity_width; ++i){
-            o = static_cast<int>(i * quantity_length);
-            for(float e = 0; e < quantity_length; ++e){
-              u = o + static_cast<int>(e);
-              ground_2d.position(i, e, 0.0f);
-              ground_2d.color(ground_2D_->at(u).r, ground_2D_->at(u).g,
-                              ground_2D_->at(u).b, ground_2D_->at(u).alpha);
-              ground.at(u) = ground_2d;
-            }
-          }
           buffer_.vertex_bind();
-          buffer_.allocate_array(ground.data(), data_size_ * type_size_, GL_DYNAMIC_DRAW);
+          buffer_.allocate_array(nullptr, data_size_ * type_size_, GL_DYNAMIC_DRAW);
+          upload_records(0u, 0u, quantity_length_, quantity_width_);
 
           buffer_.enable(i_position_);
           buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
@@ -301,6 +535,7 @@ namespace Toreo {
           buffer_.disable(i_height_);
 
           buffer_.vertex_release();
+          uploaded(quantity_length_, quantity_width_);
         }else
           std::cout << "Ground size does not matches, is:" << ground_2D_->size()
                     << ". Should be:" << data_size_ << std::endl;
@@ -308,21 +543,9 @@ namespace Toreo {
         data_size_ = quantity_width_ * quantity_length_;
 
         if(ground_3D_->size() >= data_size_){
-          std::vector<Visualizer::Ground3DShader> ground(data_size_);
-
-          for(float i = 0; i < quantity_width; ++i){
-            o = static_cast<int>(i * quantity_length);
-            for(float e = 0; e < quantity_length; ++e){
-              u = o + static_cast<int>(e);
-              ground_3d.position(i, e, 0.0f);
-              ground_3d.color(ground_3D_->at(u).r, ground_3D_->at(u).g,
-                              ground_3D_->at(u).b, ground_3D_->at(u).alpha);
-              ground_3d.height = ground_3D_->at(u).height;
-              ground.at(u) = ground_3d;
-            }
-          }
           buffer_.vertex_bind();
-          buffer_.allocate_array(ground.data(), data_size_ * type_size_, GL_DYNAMIC_DRAW);
+          buffer_.allocate_array(nullptr, data_size_ * type_size_, GL_DYNAMIC_DRAW);
+          upload_records(0u, 0u, quantity_length_, quantity_width_);
 
           GLint offset{0};
           buffer_.enable(i_position_);
@@ -339,6 +562,7 @@ namespace Toreo {
           buffer_.attributte_buffer(i_height_, _1D, offset, type_size_);
 
           buffer_.vertex_release();
+          uploaded(quantity_length_, quantity_width_);
         }else
           std::cout << "Ground size does not matches, is:" << ground_3D_->size()
                     << ". Should be:" << data_size_ << std::endl;
@@ -435,39 +659,423 @@ namespace Toreo {
       std::cout << "You have not yet defined the ground size." << std::endl;
       no_error = false;
     }
+    // one cell per instance in the instanced mode
+    if(no_error) set_divisors();
     return no_error;
   }
 
   bool Ground::draw(){
-    bool no_error{shader_->use()};
+    if(is_textured()) return draw_textures();
+
+    const bool instanced{is_instanced()};
+    Shader *shader{instanced ? instanced_shader_ : shader_};
+    bool no_error{shader->use()};
 
     if(no_error){
-      if(primary_model_)
-        shader_->set_value(u_primary_model_, *primary_model_);
+      set_cell_uniforms(shader, instanced ? u_instanced_ : u_geometry_);
+
+      buffer_.vertex_bind();
+      if(!instanced)
+        glDrawArrays(GL_POINTS, 0, data_size_);
+      else if(ground_2D_ || free_ground_2D_ || polar_ground_2D_)
+        // the top face of the box (vertices 12 to 17) is the square of a 2D cell
+        glDrawArraysInstanced(GL_TRIANGLES, 12, 6, data_size_);
       else
-        shader_->set_value(u_primary_model_, identity_matrix_);
-      shader_->set_value(u_secondary_model_, secondary_model_);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 30, data_size_);
+      buffer_.vertex_release();
+    }
 
-      if(ground_2D_ || free_ground_2D_ || polar_ground_2D_)
-        shader_->set_value(u_2D_, 1);
+    return no_error;
+  }
+
+  bool Ground::update_region(const unsigned int x, const unsigned int y,
+                             const unsigned int columns, const unsigned int rows){
+    // only grids with the same cells as the last update are written partially
+    if(!(ground_2D_ || ground_3D_) || uploaded_columns_ != quantity_length_ ||
+       uploaded_rows_ != quantity_width_ || cells() < data_size_)
+      return update();
+
+    bool no_error{is_textured() ? texture_shader_->use() : shader_->use()};
+
+    if(no_error && x < quantity_length_ && y < quantity_width_){
+      const unsigned int width{std::min(columns, quantity_length_ - x)};
+      const unsigned int height{std::min(rows, quantity_width_ - y)};
+
+      if(is_textured())
+        upload_cells(x, y, width, height);
       else
-        shader_->set_value(u_2D_, 0);
+        upload_records(x, y, width, height);
+
+      // the copy follows the uploaded cells
+      if(!snapshot_.empty()){
+        const std::size_t floats{cell_floats()};
+        const float *input{grid()};
+        for(unsigned int row = y; row < y + height; ++row){
+          const std::size_t first{(static_cast<std::size_t>(row) * quantity_length_ + x) *
+                                  floats};
+          std::copy(input + first, input + first + width * floats, snapshot_.data() + first);
+        }
+      }
+    }
+    return no_error;
+  }
 
-      shader_->set_value(u_fog_, fog_visibility_);
-      shader_->set_value(u_width_, element_width_);
-      shader_->set_value(u_length_, element_length_);
-      shader_->set_value(u_position_, ground_position_);
-      shader_->set_value(u_free_, is_free_);
-      shader_->set_value(u_polar_, is_polar_);
+  bool Ground::update_changes(){
+    const std::size_t floats{cell_floats()};
+    const std::size_t size{static_cast<std::size_t>(data_size_) * floats};
 
-      buffer_.vertex_bind();
-      glDrawArrays(GL_POINTS, 0, data_size_);
-      buffer_.vertex_release();
+    // the first time (or after a change of size) everything is uploaded and copied
+    if(!(ground_2D_ || ground_3D_) || uploaded_columns_ != quantity_length_ ||
+       uploaded_rows_ != quantity_width_ || cells() < data_size_ || snapshot_.size() != size){
+      if(ground_2D_ || ground_3D_) snapshot_.resize(1u);
+      return update();
     }
 
+    const float *input{grid()};
+    const std::size_t row_floats{quantity_length_ * floats};
+    // bounding rectangle of the changed cells of consecutive rows
+    unsigned int first_row{0u}, rows{0u}, first_column{0u}, last_column{0u};
+    bool no_error{true};
+
+    for(unsigned int row = 0u; row <= quantity_width_; ++row){
+      std::size_t first, last;
+      const bool changed{row < quantity_width_ &&
+                         difference(input + row * row_floats, snapshot_.data() + row * row_floats,
+                                    row_floats, &first, &last)};
+      if(changed){
+        const unsigned int first_cell{static_cast<unsigned int>(first / floats)};
+        const unsigned int last_cell{static_cast<unsigned int>(last / floats)};
+        if(rows == 0u){
+          first_row = row;
+          first_column = first_cell;
+          last_column = last_cell;
+        }else{
+          first_column = std::min(first_column, first_cell);
+          last_column = std::max(last_column, last_cell);
+        }
+        ++rows;
+      }else if(rows > 0u){
+        no_error = update_region(first_column, first_row, last_column - first_column + 1u, rows)
+                   && no_error;
+        rows = 0u;
+      }
+    }
     return no_error;
   }
 
+  std::size_t Ground::cell_floats(){
+    return (ground_3D_ ? sizeof(Visualizer::Ground3D) : sizeof(Visualizer::Ground2D)) /
+           sizeof(float);
+  }
+
+  const float *Ground::grid(){
+    if(ground_2D_) return &ground_2D_->data()->r;
+    if(ground_3D_) return &ground_3D_->data()->r;
+    return nullptr;
+  }
+
+  GLsizei Ground::cells(){
+    if(ground_2D_) return static_cast<GLsizei>(ground_2D_->size());
+    if(ground_3D_) return static_cast<GLsizei>(ground_3D_->size());
+    return 0;
+  }
+
+  void Ground::uploaded(const unsigned int columns, const unsigned int rows){
+    uploaded_columns_ = columns;
+    uploaded_rows_ = rows;
+    if(scrolling_frame_) scrolling_window(&scroll_x_, &scroll_y_);
+    // copy for update_changes(), only when it is used
+    if(!snapshot_.empty()){
+      const float *input{grid()};
+      snapshot_.assign(input, input + static_cast<std::size_t>(columns) * rows * cell_floats());
+    }
+  }
+
+  bool Ground::expose(const int first, const int count, const bool columns){
+    const unsigned int size{columns ? quantity_length_ : quantity_width_};
+    const int wrapped{static_cast<int>(size)};
+    const unsigned int start{static_cast<unsigned int>(((first % wrapped) + wrapped) % wrapped)};
+    // the cells could go over the border of the grid and continue at its beginning
+    const unsigned int head{std::min(static_cast<unsigned int>(count), size - start)};
+    const unsigned int tail{static_cast<unsigned int>(count) - head};
+
+    bool no_error{columns ? update_region(start, 0u, head, quantity_width_)
+                          : update_region(0u, start, quantity_length_, head)};
+    if(tail > 0u)
+      no_error = (columns ? update_region(0u, 0u, tail, quantity_width_)
+                          : update_region(0u, 0u, quantity_length_, tail)) && no_error;
+    return no_error;
+  }
+
+  void Ground::set_scrolling_uniforms(Shader *shader, const GLint scrolling,
+                                      const GLint scroll, const GLint offset){
+    const bool scrolls{is_scrolling()};
+    shader->set_value(scrolling, scrolls ? 1 : 0);
+    if(!scrolls) return;
+
+    const int columns{static_cast<int>(quantity_length_)};
+    const int rows{static_cast<int>(quantity_width_)};
+    // first cell of the window inside the grid, and the size of the grid
+    const GLint origin[4] = { ((scroll_x_ % columns) + columns) % columns,
+                              ((scroll_y_ % rows) + rows) % rows, columns, rows };
+    glUniform4iv(scroll, 1, origin);
+
+    // first cell relative to the navigation frame (x forward and y to the left)
+    const float *frame{scrolling_frame_->data()};
+    shader->set_value(offset, scroll_x_ * element_length_ + frame[14],
+                      scroll_y_ * element_width_ + frame[12]);
+  }
+
+  void Ground::upload_records(const unsigned int x, const unsigned int y,
+                              const unsigned int columns, const unsigned int rows){
+    if(columns == 0u || rows == 0u) return;
+
+    const std::size_t cells{static_cast<std::size_t>(columns) * rows};
+    std::vector<Visualizer::Ground2DShader> records_2D;
+    std::vector<Visualizer::Ground3DShader> records_3D;
+    const GLvoid *records;
+
+    if(ground_2D_){
+      records_2D.resize(cells);
+      Visualizer::Ground2DShader *record{records_2D.data()};
+      for(unsigned int i = y; i < y + rows; ++i){
+        const Visualizer::Ground2D *cell{ground_2D_->data() + i * quantity_length_ + x};
+        for(unsigned int e = x; e < x + columns; ++e, ++cell, ++record){
+          record->position(static_cast<float>(i), static_cast<float>(e), 0.0f);
+          record->color(cell->r, cell->g, cell->b, cell->alpha);
+        }
+      }
+      records = records_2D.data();
+    }else{
+      records_3D.resize(cells);
+      Visualizer::Ground3DShader *record{records_3D.data()};
+      for(unsigned int i = y; i < y + rows; ++i){
+        const Visualizer::Ground3D *cell{ground_3D_->data() + i * quantity_length_ + x};
+        for(unsigned int e = x; e < x + columns; ++e, ++cell, ++record){
+          record->position(static_cast<float>(i), static_cast<float>(e), 0.0f);
+          record->color(cell->r, cell->g, cell->b, cell->alpha);
+          record->height = cell->height;
+        }
+      }
+      records = records_3D.data();
+    }
+
+    // whole rows are contiguous in the buffer, otherwise one write per row
+    const GLsizeiptr row_size{static_cast<GLsizeiptr>(columns) * type_size_};
+    if(columns == quantity_length_){
+      buffer_.update_array(records, static_cast<GLintptr>(y) * quantity_length_ * type_size_,
+                           row_size * rows);
+    }else{
+      for(unsigned int row = 0u; row < rows; ++row)
+        buffer_.update_array(static_cast<const unsigned char*>(records) + row * row_size,
+                             (static_cast<GLintptr>(y + row) * quantity_length_ + x) * type_size_,
+                             row_size);
+    }
+  }
+
+  const bool Ground::is_textured(){
+    // the fastest path for every grid (see benchmark/ground_paths)
+    return (mode_ == Visualizer::TEXTURE || mode_ == Visualizer::AUTOMATIC) &&
+           (ground_2D_ || ground_3D_) && texture_shader_ && texture_shader_->is_created();
+  }
+
+  const bool Ground::is_instanced(){
+    return (mode_ == Visualizer::INSTANCED || mode_ == Visualizer::AUTOMATIC) &&
+           !is_textured() && instanced_shader_ && instanced_shader_->is_created();
+  }
+
+  void Ground::cell_uniforms(Shader *shader, CellUniforms *uniforms){
+    shader->use();
+    uniforms->primary_model   = shader->uniform_location("u_primary_model");
+    uniforms->secondary_model = shader->uniform_location("u_secondary_model");
+    uniforms->fog             = shader->uniform_location("u_fog");
+    uniforms->width           = shader->uniform_location("u_width");
+    uniforms->length          = shader->uniform_location("u_length");
+    uniforms->is_2D           = shader->uniform_location("u_2D");
+    uniforms->position        = shader->uniform_location("u_position");
+    uniforms->is_free         = shader->uniform_location("u_free");
+    uniforms->is_polar        = shader->uniform_location("u_polar");
+    uniforms->scrolling       = shader->uniform_location("u_scrolling");
+    uniforms->scroll          = shader->uniform_location("u_scroll");
+    uniforms->offset          = shader->uniform_location("u_offset");
+  }
+
+  void Ground::set_cell_uniforms(Shader *shader, const CellUniforms &uniforms){
+    // a scrolling grid is drawn around its navigation frame
+    if(is_scrolling())
+      shader->set_value(uniforms.primary_model, *scrolling_frame_);
+    else if(primary_model_)
+      shader->set_value(uniforms.primary_model, *primary_model_);
+    else
+      shader->set_value(uniforms.primary_model, identity_matrix_);
+    shader->set_value(uniforms.secondary_model, secondary_model_);
+
+    if(ground_2D_ || free_ground_2D_ || polar_ground_2D_)
+      shader->set_value(uniforms.is_2D, 1);
+    else
+      shader->set_value(uniforms.is_2D, 0);
+
+    shader->set_value(uniforms.fog, fog_visibility_);
+    shader->set_value(uniforms.width, element_width_);
+    shader->set_value(uniforms.length, element_length_);
+    shader->set_value(uniforms.position, ground_position_);
+    shader->set_value(uniforms.is_free, is_free_);
+    shader->set_value(uniforms.is_polar, is_polar_);
+    set_scrolling_uniforms(shader, uniforms.scrolling, uniforms.scroll, uniforms.offset);
+  }
+
+  void Ground::set_divisors(){
+    const GLuint divisor{is_instanced() ? 1u : 0u};
+    const GLint attributes[4] = { i_position_, i_color_, i_dimension_, i_height_ };
+
+    buffer_.vertex_bind();
+    for(const GLint attribute : attributes)
+      if(attribute >= 0) buffer_.divisor(attribute, divisor);
+    buffer_.vertex_release();
+  }
+
+  bool Ground::update_textures(){
+    bool no_error{texture_shader_->use()};
+
+    if(no_error){
+      data_size_ = quantity_width_ * quantity_length_;
+      const std::size_t size{ground_2D_ ? ground_2D_->size() : ground_3D_->size()};
+
+      if(size >= static_cast<std::size_t>(data_size_)){
+        // the textures are created again when the number of cells changes
+        if(texture_columns_ != quantity_length_ || texture_rows_ != quantity_width_ ||
+           (ground_3D_ && !heights_)){
+          delete_textures();
+          texture_columns_ = quantity_length_;
+          texture_rows_ = quantity_width_;
+          // a scrolling grid wraps around its borders (see set_scrolling())
+          const GLint wrap{scrolling_frame_ ? GL_REPEAT : GL_CLAMP_TO_EDGE};
+
+          glGenTextures(1, &colors_);
+          GLState::active_texture(GL_TEXTURE0);
+          GLState::bind_texture(GL_TEXTURE_2D, colors_);
+          glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texture_columns_, texture_rows_);
+          // one color per cell
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+          if(ground_3D_){
+            glGenTextures(1, &heights_);
+            GLState::bind_texture(GL_TEXTURE_2D, heights_);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16F, texture_columns_, texture_rows_);
+            // the heightfield's corners are between the cells
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+          }
+        }
+        upload_cells(0u, 0u, quantity_length_, quantity_width_);
+        uploaded(quantity_length_, quantity_width_);
+      }else
+        std::cout << "Ground size does not matches, is:" << size
+                  << ". Should be:" << data_size_ << std::endl;
+    }
+    return no_error;
+  }
+
+  bool Ground::draw_textures(){
+    bool no_error{texture_shader_->use() && colors_};
+
+    if(no_error){
+      // a scrolling grid is drawn around its navigation frame
+      if(is_scrolling())
+        texture_shader_->set_value(u_texture_primary_model_, *scrolling_frame_);
+      else if(primary_model_)
+        texture_shader_->set_value(u_texture_primary_model_, *primary_model_);
+      else
+        texture_shader_->set_value(u_texture_primary_model_, identity_matrix_);
+      texture_shader_->set_value(u_texture_secondary_model_, secondary_model_);
+
+      texture_shader_->set_value(u_texture_fog_, fog_visibility_);
+      texture_shader_->set_value(u_texture_width_, width_);
+      texture_shader_->set_value(u_texture_length_, length_);
+
+      // Ground2D is flat: one quad for all the cells
+      GLint divisions[2] = { 1, 1 };
+      if(ground_3D_){
+        divisions[0] = static_cast<GLint>(texture_columns_);
+        divisions[1] = static_cast<GLint>(texture_rows_);
+      }
+      glUniform2iv(u_divisions_, 1, divisions);
+      texture_shader_->set_value(u_3D_, ground_3D_ ? 1 : 0);
+      set_scrolling_uniforms(texture_shader_, u_texture_scrolling_, u_texture_scroll_,
+                             u_texture_offset_);
+
+      GLState::active_texture(GL_TEXTURE0);
+      GLState::bind_texture(GL_TEXTURE_2D, colors_);
+      if(ground_3D_){
+        GLState::active_texture(GL_TEXTURE1);
+        GLState::bind_texture(GL_TEXTURE_2D, heights_);
+      }
+
+      cells_.vertex_bind();
+      glDrawArrays(GL_TRIANGLES, 0, 6 * divisions[0] * divisions[1]);
+      cells_.vertex_release();
+    }
+
+    return no_error;
+  }
+
+  void Ground::upload_cells(const unsigned int x, const unsigned int y,
+                            const unsigned int columns, const unsigned int rows){
+    if(columns == 0u || rows == 0u) return;
+
+    const std::size_t cells{static_cast<std::size_t>(columns) * rows};
+    color_texels_.resize(cells * 4u);
+    if(ground_3D_) height_texels_.resize(cells);
+
+    unsigned char *texel{color_texels_.data()};
+    float *height{height_texels_.data()};
+    for(unsigned int row = y; row < y + rows; ++row){
+      const std::size_t first{static_cast<std::size_t>(row) * quantity_length_ + x};
+      if(ground_2D_){
+        for(const Visualizer::Ground2D *cell = ground_2D_->data() + first,
+            *end = cell + columns; cell < end; ++cell, texel += 4){
+          texel[0] = channel(cell->r);
+          texel[1] = channel(cell->g);
+          texel[2] = channel(cell->b);
+          texel[3] = channel(cell->alpha);
+        }
+      }else{
+        for(const Visualizer::Ground3D *cell = ground_3D_->data() + first,
+            *end = cell + columns; cell < end; ++cell, texel += 4){
+          texel[0] = channel(cell->r);
+          texel[1] = channel(cell->g);
+          texel[2] = channel(cell->b);
+          texel[3] = channel(cell->alpha);
+          *height++ = cell->height;
+        }
+      }
+    }
+
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_2D, colors_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, columns, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                    color_texels_.data());
+    if(ground_3D_){
+      GLState::bind_texture(GL_TEXTURE_2D, heights_);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, columns, rows, GL_RED, GL_FLOAT,
+                      height_texels_.data());
+    }
+  }
+
+  void Ground::delete_textures(){
+    if(colors_) GLState::delete_textures(1, &colors_);
+    if(heights_) GLState::delete_textures(1, &heights_);
+    colors_ = heights_ = 0;
+    texture_columns_ = texture_rows_ = 0u;
+    std::vector<unsigned char>().swap(color_texels_);
+    std::vector<float>().swap(height_texels_);
+  }
+
   void Ground::initialize(){
     shader_->use();
     // GLSL attribute locations
@@ -476,15 +1084,7 @@ namespace Toreo {
     i_dimension_       = shader_->attribute_location("i_dimension");
     i_height_          = shader_->attribute_location("i_height");
     // GLSL uniform locations
-    u_primary_model_   = shader_->uniform_location("u_primary_model");
-    u_secondary_model_ = shader_->uniform_location("u_secondary_model");
-    u_fog_             = shader_->uniform_location("u_fog");
-    u_width_           = shader_->uniform_location("u_width");
-    u_length_          = shader_->uniform_location("u_length");
-    u_2D_              = shader_->uniform_location("u_2D");
-    u_position_        = shader_->uniform_location("u_position");
-    u_free_            = shader_->uniform_location("u_free");
-    u_polar_           = shader_->uniform_location("u_polar");
+    cell_uniforms(shader_, &u_geometry_);
   }
 
   void Ground::restart(){
@@ -495,5 +1095,7 @@ namespace Toreo {
     polar_ground_2D_ = nullptr;
     polar_ground_3D_ = nullptr;
     data_size_ = 0;
+    uploaded_columns_ = uploaded_rows_ = 0u;
+    std::vector<float>().swap(snapshot_);
   }
 }
@@ -9,47 +9,46 @@ namespace Toreo {
     ground_shader_(new Shader("resources/shaders/ground.vert",
                               "resources/shaders/ground.frag",
                               "resources/shaders/ground.geom")),
-    u_projection_ground_(ground_shader_->uniform_location("u_projection")),
-    u_view_ground_(ground_shader_->uniform_location("u_view")),
+    ground_texture_shader_(new Shader("resources/shaders/ground_texture.vert",
+                                      "resources/shaders/ground.frag", "",
+                                      "#define GROUND_TEXTURE 1")),
+    ground_instanced_shader_(new Shader("resources/shaders/ground_instanced.vert",
+                                        "resources/shaders/ground.frag")),
     u_point_light_ground_(ground_shader_->uniform_location("u_point_light")),
     u_point_light_color_ground_(ground_shader_->uniform_location("u_point_light_color")),
     u_directional_light_ground_(ground_shader_->uniform_location("u_directional_light")),
     u_directional_light_color_ground_(ground_shader_->uniform_location("u_directional_light_color")),
-    u_camera_position_ground_(ground_shader_->uniform_location("u_camera_position")),
     grounds_(0),
     grid_(nullptr),
     line_shader_(new Shader("resources/shaders/lines.vert",
                             "resources/shaders/lines.frag")),
-    u_view_line_(line_shader_->uniform_location("u_view")),
-    u_perspective_line_(line_shader_->uniform_location("u_projection")),
     grid_visibility_(true),
-    signal_updated_camera_(core->signal_updated_camera()->
-                           connect(boost::bind(&GroundManager::updated_camera, this))),
-    signal_draw_all_(core->syncronize(Visualizer::GROUND)->
-                     connect(boost::bind(&GroundManager::draw_all, this)))
+    render_pass_(core->add_render_pass(Visualizer::GROUND,
+                                       boost::bind(&GroundManager::draw_all, this)))
   {
     initialize();
   }
 
   GroundManager::~GroundManager(){
-    for(Visualizer::GroundElement ground : grounds_)
+    for(Visualizer::GroundElement &ground : grounds_)
       if(ground.ground != nullptr){
         if(ground.connection.connected())
           ground.connection.disconnect();
         delete ground.ground;
-      }
-
-    if(signal_updated_camera_.connected())
-      signal_updated_camera_.disconnect();
+      }else if(ground.tiles != nullptr)
+        delete ground.tiles;
 
     if(signal_updated_all_.connected())
       signal_updated_all_.disconnect();
 
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
     if(ground_shader_)
       delete ground_shader_;
+    if(ground_texture_shader_)
+      delete ground_texture_shader_;
+    if(ground_instanced_shader_)
+      delete ground_instanced_shader_;
 
     if(grid_)
       delete grid_;
@@ -67,7 +66,9 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     groundy.ground->set_ground_size(width, length, number_of_elements_through_width,
                                     number_of_elements_through_length);
     if(transformation_matrix != nullptr)
@@ -76,6 +77,7 @@ namespace Toreo {
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
@@ -88,7 +90,9 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     groundy.ground->set_ground_size(width, length, number_of_elements_through_width,
                                     number_of_elements_through_length);
     if(transformation_matrix != nullptr)
@@ -97,6 +101,7 @@ namespace Toreo {
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
@@ -105,13 +110,16 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     if(transformation_matrix != nullptr)
       groundy.ground->set_transformation_matrix(transformation_matrix);
 
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
@@ -120,13 +128,16 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     if(transformation_matrix != nullptr)
       groundy.ground->set_transformation_matrix(transformation_matrix);
 
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
@@ -135,13 +146,16 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     if(transformation_matrix != nullptr)
       groundy.ground->set_transformation_matrix(transformation_matrix);
 
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
@@ -150,16 +164,64 @@ namespace Toreo {
                           const algebraica::mat4f *transformation_matrix,
                           const bool ground_visible){
     Visualizer::GroundElement groundy = { new Ground(ground_shader_, ground),
-                                          name, ground_visible };
+                                          name, ground_visible, {}, {} };
+    groundy.ground->set_texture_shader(ground_texture_shader_);
+    groundy.ground->set_instanced_shader(ground_instanced_shader_);
     if(transformation_matrix != nullptr)
       groundy.ground->set_transformation_matrix(transformation_matrix);
 
     groundy.ground->update();
 
     grounds_.push_back(groundy);
+    core_->request_redraw();
+    return grounds_.size() - 1;
+  }
+
+  GMid GroundManager::add_tiles(const GroundTiles::Loader &loader,
+                                const std::string name,
+                                const float minimum_x,
+                                const float minimum_y,
+                                const float size,
+                                const unsigned int levels,
+                                const unsigned int resolution,
+                                const algebraica::mat4f *transformation_matrix,
+                                const bool ground_visible){
+    Visualizer::GroundElement groundy = { nullptr, name, ground_visible, {}, {} };
+    groundy.tiles = new GroundTiles(ground_shader_, ground_texture_shader_,
+                                    ground_instanced_shader_, loader,
+                                    minimum_x, minimum_y, size, levels, resolution);
+    if(transformation_matrix != nullptr)
+      groundy.tiles->set_transformation_matrix(transformation_matrix);
+    groundy.tiles->set_notifier(boost::bind(&GroundManager::request_redraw, this));
+
+    grounds_.push_back(groundy);
+    core_->request_redraw();
     return grounds_.size() - 1;
   }
 
+  bool GroundManager::set_tiles_cache_size(GMid id, const std::size_t bytes){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).tiles != nullptr){
+        grounds_.at(id).tiles->set_cache_size(bytes);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::set_tiles_pixel_error(GMid id, const float pixel_error){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).tiles != nullptr){
+        grounds_.at(id).tiles->set_pixel_error(pixel_error);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
   bool GroundManager::change_input(GMid id, const std::vector<Visualizer::Ground2D> *ground){
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
@@ -228,10 +290,66 @@ namespace Toreo {
       return false;
   }
 
+  bool GroundManager::set_mode(GMid id, const Visualizer::GroundMode mode){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr){
+        grounds_.at(id).ground->set_mode(mode);
+        core_->request_redraw();
+        return true;
+      }else if(grounds_.at(id).tiles != nullptr){
+        grounds_.at(id).tiles->set_mode(mode);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::set_scrolling(GMid id, const algebraica::mat4f *navigation_frame){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr){
+        grounds_.at(id).ground->set_scrolling(navigation_frame);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::scrolling_window(GMid id, int *x, int *y){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr){
+        grounds_.at(id).ground->scrolling_window(x, y);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::scroll(GMid id){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr && grounds_.at(id).visibility){
+        grounds_.at(id).ground->scroll();
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
   bool GroundManager::fog_visibility(GMid id, const bool visible){
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->fog_visibility(visible);
+        core_->request_redraw();
+        return true;
+      }else if(grounds_.at(id).tiles != nullptr){
+        grounds_.at(id).tiles->fog_visibility(visible);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -314,6 +432,7 @@ namespace Toreo {
         grounds_.at(id).ground->set_ground_size(width, length,
                                                 number_of_elements_through_width,
                                                 number_of_elements_through_length);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -324,6 +443,7 @@ namespace Toreo {
   bool GroundManager::set_visibility(GMid id, const bool visible){
     if(grounds_.size() > id){
       grounds_.at(id).visibility = visible;
+      core_->request_redraw();
       return true;
     }else
       return false;
@@ -334,6 +454,11 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
+        return true;
+      }else if(grounds_.at(id).tiles != nullptr){
+        grounds_.at(id).tiles->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -345,6 +470,7 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->translate(-y, z, -x);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -356,6 +482,7 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->rotate(-pitch, yaw, -roll);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -367,6 +494,7 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->rotate_in_z(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -378,6 +506,7 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->rotate_in_x(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -389,6 +518,7 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr){
         grounds_.at(id).ground->rotate_in_y(angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -400,6 +530,32 @@ namespace Toreo {
     if(grounds_.size() > id)
       if(grounds_.at(id).ground != nullptr && grounds_.at(id).visibility){
         grounds_.at(id).ground->update();
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::update_region(GMid id, const unsigned int x, const unsigned int y,
+                                    const unsigned int columns, const unsigned int rows){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr && grounds_.at(id).visibility){
+        grounds_.at(id).ground->update_region(x, y, columns, rows);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool GroundManager::update_changes(GMid id){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr && grounds_.at(id).visibility){
+        grounds_.at(id).ground->update_changes();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -408,9 +564,10 @@ namespace Toreo {
   }
 
   void GroundManager::update_all(){
-    for(Visualizer::GroundElement ground : grounds_)
+    for(Visualizer::GroundElement &ground : grounds_)
       if(ground.ground != nullptr && ground.visibility)
         ground.ground->update();
+    core_->request_redraw();
   }
 
   bool GroundManager::draw(GMid id){
@@ -427,9 +584,13 @@ namespace Toreo {
   void GroundManager::draw_all(){
     if(grid_ && grid_visibility_)
       grid_->draw();
-    for(Visualizer::GroundElement ground : grounds_)
-      if(ground.ground != nullptr && ground.visibility)
+    for(Visualizer::GroundElement &ground : grounds_)
+      if(ground.ground != nullptr && ground.visibility){
+        if(ground.refresh) ground.refresh();
         ground.ground->draw();
+      }else if(ground.tiles != nullptr && ground.visibility)
+        ground.tiles->draw(core_->camera_matrix_perspective_view(), core_->camera_position(),
+                           screen_factor());
   }
 
   bool GroundManager::delete_ground(GMid id){
@@ -439,6 +600,13 @@ namespace Toreo {
           grounds_.at(id).connection.disconnect();
         delete grounds_.at(id).ground;
         grounds_.at(id).ground = nullptr;
+        grounds_.at(id).refresh.clear();
+        core_->request_redraw();
+        return true;
+      }else if(grounds_.at(id).tiles != nullptr){
+        delete grounds_.at(id).tiles;
+        grounds_.at(id).tiles = nullptr;
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -447,13 +615,15 @@ namespace Toreo {
   }
 
   void GroundManager::purge(){
-    for(Visualizer::GroundElement ground : grounds_)
+    for(Visualizer::GroundElement &ground : grounds_)
       if(ground.ground != nullptr){
         if(ground.connection.connected())
           ground.connection.disconnect();
         delete ground.ground;
-      }
+      }else if(ground.tiles != nullptr)
+        delete ground.tiles;
     grounds_.clear();
+    core_->request_redraw();
   }
 
   bool GroundManager::connect(GMid id, boost::signals2::signal<void ()> *signal){
@@ -476,14 +646,26 @@ namespace Toreo {
     signal_updated_all_ = signal->connect(boost::bind(&GroundManager::update_all, this));
   }
 
-  void GroundManager::updated_camera(){
-    ground_shader_->use();
-    ground_shader_->set_value(u_view_ground_, core_->camera_matrix_view());
-    ground_shader_->set_value(u_projection_ground_, core_->camera_matrix_perspective());
-    ground_shader_->set_value(u_camera_position_ground_, core_->camera_position());
-    line_shader_->use();
-    line_shader_->set_value(u_view_line_, core_->camera_matrix_view());
-    line_shader_->set_value(u_perspective_line_, core_->camera_matrix_perspective());
+  void GroundManager::request_redraw(){
+    core_->request_redraw();
+  }
+
+  float GroundManager::screen_factor(){
+    // pixels per unit at distance 1: viewport height / (2 * tan(fov / 2))
+    int height;
+    core_->window_size(nullptr, nullptr, nullptr, &height);
+    return height * core_->camera_matrix_perspective().data()[5] * 0.5f;
+  }
+
+  bool GroundManager::unsubscribe(GMid id){
+    if(grounds_.size() > id)
+      if(grounds_.at(id).ground != nullptr){
+        grounds_.at(id).refresh.clear();
+        return true;
+      }else
+        return false;
+    else
+      return false;
   }
 
   void GroundManager::initialize(){
@@ -512,9 +694,17 @@ namespace Toreo {
     ground_shader_->set_values(u_point_light_ground_, &lightPositions[0], 4);
     ground_shader_->set_values(u_point_light_color_ground_, &lightColors[0], 4);
 
+    // the texture and instanced modes use the same lights
+    for(Shader *shader : { ground_texture_shader_, ground_instanced_shader_ }){
+      if(!shader->use())
+        std::cout << shader->error_log() << std::endl;
+      shader->set_value(shader->uniform_location("u_directional_light"), sun_direction);
+      shader->set_value(shader->uniform_location("u_directional_light_color"), sun_color);
+      shader->set_values(shader->uniform_location("u_point_light"), &lightPositions[0], 4);
+      shader->set_values(shader->uniform_location("u_point_light_color"), &lightColors[0], 4);
+    }
+
     if(!line_shader_->use())
       std::cout << line_shader_->error_log() << std::endl;
-
-    updated_camera();
   }
 }
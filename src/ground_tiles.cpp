@@ -0,0 +1,329 @@
+#include "include/ground_tiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Toreo {
+  namespace {
+    // the tile coordinates are packed in 28 bits each
+    const unsigned int tiles_maximum_levels = 28u;
+    // the tiles are flat, their bounding boxes have this height (meters) for the culling
+    const float tiles_thickness = 1.0f;
+  }
+
+  GroundTiles::GroundTiles(Shader *ground_shader, Shader *texture_shader,
+                           Shader *instanced_shader, const Loader &loader,
+                           const float minimum_x, const float minimum_y, const float size,
+                           const unsigned int levels, const unsigned int resolution) :
+    shader_(ground_shader),
+    texture_shader_(texture_shader),
+    instanced_shader_(instanced_shader),
+    loader_(loader),
+    minimum_x_(minimum_x),
+    minimum_y_(minimum_y),
+    size_(size),
+    levels_(std::min(std::max(levels, 1u), tiles_maximum_levels)),
+    resolution_(std::max(resolution, 1u)),
+    tiles_(),
+    cache_(),
+    missing_(),
+    cache_bytes_(0u),
+    cache_size_(268435456u),
+    pixel_error_(2.0f),
+    frame_(0u),
+    primary_model_(nullptr),
+    identity_matrix_(),
+    mode_(Visualizer::AUTOMATIC),
+    fog_visibility_(true),
+    loaded_(),
+    workers_(new WorkerPool(2u))
+  {}
+
+  GroundTiles::~GroundTiles(){
+    // no worker may write into loaded_ after this
+    delete workers_;
+
+    for(std::pair<const std::uint64_t, Tile> &tile : tiles_)
+      if(tile.second.ground) delete tile.second.ground;
+  }
+
+  void GroundTiles::set_transformation_matrix(const algebraica::mat4f *transformation_matrix){
+    primary_model_ = transformation_matrix;
+    for(std::pair<const std::uint64_t, Tile> &tile : tiles_)
+      if(tile.second.ground) tile.second.ground->set_transformation_matrix(primary_model_);
+  }
+
+  void GroundTiles::set_mode(const Visualizer::GroundMode mode){
+    if(mode_ == mode) return;
+
+    mode_ = mode;
+    // the grounds do not keep their cells, the tiles are loaded again
+    for(TileMap::iterator tile = tiles_.begin(); tile != tiles_.end();)
+      if(tile->second.state == LOADED)
+        tile = free_tile(tile);
+      else
+        ++tile;
+    cache_.clear();
+    cache_bytes_ = 0u;
+  }
+
+  void GroundTiles::fog_visibility(const bool visible){
+    fog_visibility_ = visible;
+    for(std::pair<const std::uint64_t, Tile> &tile : tiles_)
+      if(tile.second.ground) tile.second.ground->fog_visibility(fog_visibility_);
+  }
+
+  void GroundTiles::set_cache_size(const std::size_t bytes){
+    cache_size_ = bytes;
+  }
+
+  void GroundTiles::set_pixel_error(const float pixel_error){
+    pixel_error_ = std::max(pixel_error, 0.01f);
+  }
+
+  void GroundTiles::set_notifier(const boost::function<void ()> &notifier){
+    notifier_ = notifier;
+  }
+
+  std::size_t GroundTiles::draw(const algebraica::mat4f &pv, const algebraica::vec3f &camera,
+                                const float screen_factor){
+    ++frame_;
+    upload_tiles();
+
+    const algebraica::mat4f model{primary_model_ ? *primary_model_ : identity_matrix_};
+    const algebraica::mat4f mvp{pv * model};
+
+    std::vector<Tile*> visible;
+    select(0u, 0u, 0u, mvp.data(), model.data(), camera, screen_factor, &visible);
+
+    for(Tile *tile : visible){
+      tile->ground->draw();
+      cache_.splice(cache_.begin(), cache_, tile->cached);
+      tile->frame = frame_;
+    }
+
+    evict_tiles();
+    return visible.size();
+  }
+
+  std::uint64_t GroundTiles::key(const unsigned int level, const unsigned int x,
+                                 const unsigned int y){
+    return (static_cast<std::uint64_t>(level) << 56) | (static_cast<std::uint64_t>(x) << 28) |
+           static_cast<std::uint64_t>(y);
+  }
+
+  Visualizer::GroundTile GroundTiles::area(const unsigned int level, const unsigned int x,
+                                           const unsigned int y){
+    const float size{size_ / static_cast<float>(1u << level)};
+    return Visualizer::GroundTile{ level, x, y, minimum_x_ + x * size, minimum_y_ + y * size,
+                                   size };
+  }
+
+  void GroundTiles::select(const unsigned int level, const unsigned int x, const unsigned int y,
+                           const float *mvp, const float *model,
+                           const algebraica::vec3f &camera, const float screen_factor,
+                           std::vector<Tile*> *visible){
+    const Visualizer::GroundTile tile_area{area(level, x, y)};
+    if(!is_visible(tile_area, mvp)) return;
+
+    // the entries are only created by request(), iterators are not kept because the
+    // requests of the children could rehash tiles_
+    const TileMap::iterator found{tiles_.find(key(level, x, y))};
+    Tile *tile{found == tiles_.end() ? nullptr : &found->second};
+
+    if(level + 1u < levels_ &&
+       screen_error(tile_area, model, camera, screen_factor) > pixel_error_){
+      // the children replace this tile when all the visible ones are ready
+      bool is_ready{true};
+      for(unsigned int child = 0u; child < 4u; ++child){
+        const unsigned int child_x{x * 2u + (child & 1u)}, child_y{y * 2u + (child >> 1)};
+        if(!is_visible(area(level + 1u, child_x, child_y), mvp)) continue;
+
+        const TileMap::iterator child_tile{tiles_.find(key(level + 1u, child_x, child_y))};
+        if(child_tile == tiles_.end()){
+          request(level + 1u, child_x, child_y);
+          is_ready = false;
+        }else if(child_tile->second.state == LOADING)
+          is_ready = false;
+        else if(child_tile->second.state == MISSING)
+          keep_missing(child_tile->second);
+      }
+
+      if(is_ready){
+        for(unsigned int child = 0u; child < 4u; ++child)
+          select(level + 1u, x * 2u + (child & 1u), y * 2u + (child >> 1), mvp, model,
+                 camera, screen_factor, visible);
+        return;
+      }
+    }
+
+    if(!tile)
+      request(level, x, y);
+    else if(tile->state == LOADED)
+      visible->push_back(tile);
+    else if(tile->state == MISSING)
+      keep_missing(*tile);
+  }
+
+  bool GroundTiles::is_visible(const Visualizer::GroundTile &area, const float *mvp){
+    const float minimum[3] = { area.minimum_x, area.minimum_y, -tiles_thickness * 0.5f };
+    const float maximum[3] = { area.minimum_x + area.size, area.minimum_y + area.size,
+                               tiles_thickness * 0.5f };
+    // number of corners outside of each clipping plane: -x, +x, -y, +y, -z, +z
+    int outside[6] = {0, 0, 0, 0, 0, 0};
+
+    for(int corner = 0; corner < 8; ++corner){
+      const float x{(corner & 1) ? maximum[0] : minimum[0]};
+      const float y{(corner & 2) ? maximum[1] : minimum[1]};
+      const float z{(corner & 4) ? maximum[2] : minimum[2]};
+      // OpenGL coordinates
+      const float vertex[4] = { -y, z, -x, 1.0f };
+
+      float clip[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+      for(int row = 0; row < 4; ++row)
+        for(int column = 0; column < 4; ++column)
+          clip[row] += mvp[column * 4 + row] * vertex[column];
+
+      for(int axis = 0; axis < 3; ++axis){
+        if(clip[axis] < -clip[3]) ++outside[axis * 2];
+        if(clip[axis] > clip[3]) ++outside[axis * 2 + 1];
+      }
+    }
+
+    for(const int corners : outside)
+      if(corners == 8) return false;
+    return true;
+  }
+
+  float GroundTiles::screen_error(const Visualizer::GroundTile &area, const float *model,
+                                  const algebraica::vec3f &camera, const float screen_factor){
+    const float half_size{area.size * 0.5f};
+    const float center[4] = { -(area.minimum_y + half_size), 0.0f,
+                              -(area.minimum_x + half_size), 1.0f };
+
+    float world[3] = { 0.0f, 0.0f, 0.0f };
+    for(int row = 0; row < 3; ++row)
+      for(int column = 0; column < 4; ++column)
+        world[row] += model[column * 4 + row] * center[column];
+
+    const float dx{world[0] - camera.x}, dy{world[1] - camera.y}, dz{world[2] - camera.z};
+    // the camera is above (or very close to) the tile
+    const float distance{std::max(std::sqrt(dx * dx + dy * dy + dz * dz) -
+                                  half_size * 1.41421356f, 0.01f)};
+
+    // size of one cell in pixels
+    return area.size / static_cast<float>(resolution_) * screen_factor / distance;
+  }
+
+  void GroundTiles::request(const unsigned int level, const unsigned int x,
+                            const unsigned int y){
+    const std::uint64_t tile_key{key(level, x, y)};
+    tiles_[tile_key].state = LOADING;
+    workers_->post(boost::bind(&GroundTiles::load_tile, this, tile_key, area(level, x, y)));
+  }
+
+  void GroundTiles::keep_missing(Tile &tile){
+    missing_.splice(missing_.begin(), missing_, tile.cached);
+    tile.frame = frame_;
+  }
+
+  void GroundTiles::load_tile(const std::uint64_t key, const Visualizer::GroundTile area){
+    LoadedTile loaded;
+    loaded.key = key;
+    loaded.area = area;
+    loaded.exists = loader_ && loader_(area, &loaded.cells) &&
+                    loaded.cells.size() >= static_cast<std::size_t>(resolution_) * resolution_;
+
+    {
+      boost::lock_guard<boost::mutex> lock(loaded_mutex_);
+      loaded_.push_back(std::move(loaded));
+    }
+    if(notifier_) notifier_();
+  }
+
+  void GroundTiles::upload_tiles(){
+    std::vector<LoadedTile> loaded;
+    {
+      boost::lock_guard<boost::mutex> lock(loaded_mutex_);
+      loaded.swap(loaded_);
+    }
+
+    for(LoadedTile &new_tile : loaded){
+      const TileMap::iterator found{tiles_.find(new_tile.key)};
+      if(found == tiles_.end() || found->second.state != LOADING) continue;
+
+      Tile &tile = found->second;
+      if(!new_tile.exists){
+        tile.state = MISSING;
+        missing_.push_front(new_tile.key);
+        tile.cached = missing_.begin();
+        tile.frame = frame_;
+        continue;
+      }
+
+      tile.cells.swap(new_tile.cells);
+      create_ground(new_tile.area, tile);
+      tile.state = LOADED;
+
+      cache_.push_front(new_tile.key);
+      tile.cached = cache_.begin();
+      cache_bytes_ += tile_bytes();
+    }
+  }
+
+  void GroundTiles::create_ground(const Visualizer::GroundTile &area, Tile &tile){
+    tile.ground = new Ground(shader_, &tile.cells);
+    tile.ground->set_texture_shader(texture_shader_);
+    tile.ground->set_instanced_shader(instanced_shader_);
+    tile.ground->set_transformation_matrix(primary_model_);
+    tile.ground->fog_visibility(fog_visibility_);
+    tile.ground->set_ground_size(area.size, area.size, resolution_, resolution_);
+    // the ground is centered at its origin, OpenGL axes: (-y, z, -x)
+    tile.ground->translate(-(area.minimum_y + area.size * 0.5f), 0.0f,
+                           -(area.minimum_x + area.size * 0.5f));
+
+    // set_mode() uploads the cells when the mode changes
+    if(tile.ground->mode() == mode_)
+      tile.ground->update();
+    else
+      tile.ground->set_mode(mode_);
+
+    // the ground only reads its cells when it is updated, it will not be updated again
+    std::vector<Visualizer::Ground2D>().swap(tile.cells);
+  }
+
+  GroundTiles::TileMap::iterator GroundTiles::free_tile(TileMap::iterator tile){
+    if(tile->second.ground) delete tile->second.ground;
+    return tiles_.erase(tile);
+  }
+
+  void GroundTiles::evict_tiles(){
+    while(cache_bytes_ > cache_size_ && !cache_.empty()){
+      const TileMap::iterator tile{tiles_.find(cache_.back())};
+      // the rest of the list was also used in this frame
+      if(tile->second.frame == frame_) break;
+
+      free_tile(tile);
+      cache_bytes_ -= tile_bytes();
+      cache_.pop_back();
+    }
+
+    // the loader is asked again if a forgotten tile becomes visible
+    while(!missing_.empty()){
+      const TileMap::iterator tile{tiles_.find(missing_.back())};
+      if(tile->second.frame == frame_) break;
+
+      tiles_.erase(tile);
+      missing_.pop_back();
+    }
+  }
+
+  std::size_t GroundTiles::tile_bytes(){
+    // 4 bytes per texel with textures (Ground2D), one vertex per cell otherwise
+    const bool is_textured{texture_shader_ &&
+                           (mode_ == Visualizer::TEXTURE || mode_ == Visualizer::AUTOMATIC)};
+    const std::size_t cells{static_cast<std::size_t>(resolution_) * resolution_};
+    return cells * (is_textured ? 4u : sizeof(Visualizer::Ground2DShader));
+  }
+}
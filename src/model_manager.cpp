@@ -8,12 +8,9 @@ namespace Toreo {
                              "resources/shaders/PBR.frag")),
     m_u_scene_model_(model_shader_->uniform_location("u_scene_model")),
     m_u_object_model_(model_shader_->uniform_location("u_object_model")),
-    m_u_view_(model_shader_->uniform_location("u_view")),
-    m_u_projection_(model_shader_->uniform_location("u_projection")),
     m_u_light_(model_shader_->uniform_location("u_light")),
     m_u_light_color_(model_shader_->uniform_location("u_light_color")),
     m_u_light_size_(model_shader_->uniform_location("u_light_size")),
-    m_u_camera_(model_shader_->uniform_location("u_camera")),
     m_u_sun_(model_shader_->uniform_location("u_sun")),
     m_u_sun_color_(model_shader_->uniform_location("u_sun_color")),
     m_u_pbr_(model_shader_->uniform_location("u_pbr")),
@@ -35,7 +32,6 @@ namespace Toreo {
     if(!model_shader_->use())
       std::cout << model_shader_->error_log() << std::endl;
 
-    update_camera();
     update_vehicle_model();
 
     model_shader_->set_value(model_shader_->uniform_location("u_irradiance"), 0);
@@ -76,10 +72,8 @@ namespace Toreo {
     model_shader_->set_values(m_u_light_color_, &lightColors[0], 4);
     model_shader_->set_value(m_u_light_size_, 4);
 
-    signal_updated_camera_ = core->signal_updated_camera()
-                             ->connect(boost::bind(&ModelManager::update_camera, this));
-    signal_draw_all_ = core->syncronize(Visualizer::MODELS)
-                       ->connect(boost::bind(&ModelManager::draw_all, this));
+    render_pass_ = core->add_render_pass(Visualizer::MODELS,
+                                         boost::bind(&ModelManager::draw_all, this));
   }
 
   ModelManager::~ModelManager(){
@@ -87,10 +81,7 @@ namespace Toreo {
       if(model.model)
         delete model.model;
 
-    if(signal_updated_camera_.connected())
-      signal_updated_camera_.disconnect();
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
     delete model_shader_;
     delete cubemap_;
@@ -135,6 +126,7 @@ namespace Toreo {
           break;
         }
         models_.at(id).elements.push_back(new_element);
+        core_->request_redraw();
         return models_.at(id).elements.size() - 1;
       }else
         return -1;
@@ -152,6 +144,7 @@ namespace Toreo {
           models_.at(model_id).elements.at(element_id).G = G;
           models_.at(model_id).elements.at(element_id).B = B;
           models_.at(model_id).elements.at(element_id).A = Alpha;
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -168,6 +161,7 @@ namespace Toreo {
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).metallize = metallize;
           models_.at(model_id).elements.at(element_id).metallic = metallic_value;
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -184,6 +178,7 @@ namespace Toreo {
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).roughen = roughen;
           models_.at(model_id).elements.at(element_id).roughness = roughness_value;
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -198,6 +193,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).visibility = visible;
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -212,6 +208,7 @@ namespace Toreo {
     if(models_.size() > model_id)
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         models_.at(model_id).elements.at(element_id).main = transformation_matrix;
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -225,6 +222,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).secondary.translate(-y, z, -x);
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -240,6 +238,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).secondary.rotate(-pitch, yaw, -roll);
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -254,6 +253,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).secondary.rotate_z(-angle);
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -268,6 +268,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).secondary.rotate_x(-angle);
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -282,6 +283,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         if(models_.at(model_id).elements.at(element_id).main){
           models_.at(model_id).elements.at(element_id).secondary.rotate_y(angle);
+          core_->request_redraw();
           return true;
         }else
           return false;
@@ -298,9 +300,11 @@ namespace Toreo {
           if(models_.at(model_id).elements.at(element_id).visibility){
             model_shader_->use();
             cubemap_->bind_reflectance();
+            GLState::enable(GL_CULL_FACE);
             models_.at(model_id).model->pre_drawing();
             draw(&models_.at(model_id), &models_.at(model_id).elements.at(element_id));
             models_.at(model_id).model->post_drawing();
+            GLState::disable(GL_CULL_FACE);
           }
           return true;
         }else
@@ -316,12 +320,14 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > 0){
         model_shader_->use();
         cubemap_->bind_reflectance();
+        GLState::enable(GL_CULL_FACE);
         models_.at(model_id).model->pre_drawing();
         for(Visualizer::Model3DElement &element : models_.at(model_id).elements)
           if(element.main && element.visibility)
             draw(&models_.at(model_id), &element);
 
         models_.at(model_id).model->post_drawing();
+        GLState::disable(GL_CULL_FACE);
         return true;
       }else
         return false;
@@ -332,6 +338,8 @@ namespace Toreo {
   void ModelManager::draw_all(){
     model_shader_->use();
     cubemap_->bind_reflectance();
+    // back faces are culled only for the 3D models, once for all their elements
+    GLState::enable(GL_CULL_FACE);
     for(Visualizer::Model3D &model : models_){
       if(model.model && model.elements.size() > 0){
         model.model->pre_drawing();
@@ -342,6 +350,8 @@ namespace Toreo {
         model.model->post_drawing();
       }
     }
+    GLState::disable(GL_CULL_FACE);
+
     if(skybox_visibility_)
       skybox_->draw();
   }
@@ -351,6 +361,7 @@ namespace Toreo {
       if(models_.at(model_id).model && models_.at(model_id).elements.size() > element_id){
         models_.at(model_id).elements.at(element_id).main = nullptr;
         models_.at(model_id).elements.at(element_id).visibility = false;
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -364,6 +375,7 @@ namespace Toreo {
         delete models_.at(id).model;
         models_.at(id).model = nullptr;
         models_.at(id).elements.clear();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -379,6 +391,7 @@ namespace Toreo {
       }
     }
     models_.clear();
+    core_->request_redraw();
   }
 
   bool ModelManager::skybox(const std::string up, const std::string down,
@@ -426,7 +439,6 @@ namespace Toreo {
   }
 
   void ModelManager::draw(Visualizer::Model3D *model, Visualizer::Model3DElement *element){
-    glEnable(GL_CULL_FACE);
     model_shader_->set_value(m_u_colored_, element->colorize);
     if(element->colorize)
       model_shader_->set_value(m_u_color_,
@@ -450,14 +462,6 @@ namespace Toreo {
     model_shader_->set_value(m_u_object_model_, element->secondary);
 
     model->model->draw();
-    glDisable(GL_CULL_FACE);
-  }
-
-  void ModelManager::update_camera(){
-    model_shader_->use();
-    model_shader_->set_value(m_u_view_, core_->camera_matrix_view());
-    model_shader_->set_value(m_u_projection_, core_->camera_matrix_perspective());
-    model_shader_->set_value(m_u_camera_, core_->camera_position());
   }
 
   void ModelManager::update_vehicle_model(){
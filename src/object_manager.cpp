@@ -17,8 +17,6 @@ namespace Toreo {
     hollow_circle_(new Buffer(true)),
     solid_circle_(new Buffer(true)),
     solid_arrow_(new Buffer(true)),
-    u_pv_(shader_->uniform_location("u_pv")),
-    u_camera_position_(shader_->uniform_location("u_camera_position")),
     u_point_light_(shader_->uniform_location("u_point_light")),
     u_point_light_color_(shader_->uniform_location("u_point_light_color")),
     u_directional_light_(shader_->uniform_location("u_directional_light")),
@@ -30,17 +28,12 @@ namespace Toreo {
     ao_square_(nullptr),
     ao_circle_(nullptr),
     ao_arrow_(nullptr),
-    signal_updated_camera_(core->signal_updated_camera()->
-                           connect(boost::bind(&ObjectManager::updated_camera, this))),
-    signal_draw_all_(core->syncronize(Visualizer::OBJECTS)->
-                     connect(boost::bind(&ObjectManager::draw_all, this)))
+    render_pass_(core->add_render_pass(Visualizer::OBJECTS,
+                                       boost::bind(&ObjectManager::draw_all, this)))
   {
     if(!shader_->use())
       std::cout << shader_->error_log() << std::endl;
 
-    shader_->set_value(u_pv_, core->camera_matrix_perspective_view());
-    shader_->set_value(u_camera_position_, core_->camera_position());
-
     // lights
     // ------
     algebraica::vec3f lightPositions[4] = {
@@ -75,7 +68,7 @@ namespace Toreo {
   }
 
   ObjectManager::~ObjectManager(){
-    for(Visualizer::ObjectElement object : objects_)
+    for(Visualizer::ObjectElement &object : objects_)
       if(object.object != nullptr){
         if(object.connection.connected())
           object.connection.disconnect();
@@ -88,11 +81,7 @@ namespace Toreo {
     if(ao_circle_) delete ao_circle_;
     if(ao_arrow_) delete ao_arrow_;
 
-    if(signal_updated_camera_.connected())
-      signal_updated_camera_.disconnect();
-
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
     if(signal_updated_all_.connected())
       signal_updated_all_.disconnect();
@@ -117,11 +106,12 @@ namespace Toreo {
                                 const bool visible){
     Visualizer::ObjectElement object = { new Objects(shader_, objects, hollow_box_,
                                          ao_box_, solid_box_, solid_arrow_, ao_arrow_,
-                                         Visualizer::BOX), name, visible };
+                                         Visualizer::BOX), name, visible, {}, {} };
     if(transformation_matrix != nullptr)
       object.object->set_transformation_matrix(transformation_matrix);
 
     objects_.push_back(object);
+    core_->request_redraw();
     return objects_.size() - 1;
   }
 
@@ -131,11 +121,12 @@ namespace Toreo {
                                   const bool visible){
     Visualizer::ObjectElement object = { new Objects(shader_, objects, hollow_circle_,
                                          ao_circle_, solid_circle_, solid_arrow_, ao_arrow_,
-                                         Visualizer::CIRCLE), name, visible };
+                                         Visualizer::CIRCLE), name, visible, {}, {} };
     if(transformation_matrix != nullptr)
       object.object->set_transformation_matrix(transformation_matrix);
 
     objects_.push_back(object);
+    core_->request_redraw();
     return objects_.size() - 1;
   }
 
@@ -145,11 +136,12 @@ namespace Toreo {
                                     const bool visible){
     Visualizer::ObjectElement object = { new Objects(shader_, objects, hollow_cylinder_,
                                          ao_cylinder_, solid_cylinder_, solid_arrow_, ao_arrow_,
-                                         Visualizer::CYLINDER), name, visible };
+                                         Visualizer::CYLINDER), name, visible, {}, {} };
     if(transformation_matrix != nullptr)
       object.object->set_transformation_matrix(transformation_matrix);
 
     objects_.push_back(object);
+    core_->request_redraw();
     return objects_.size() - 1;
   }
 
@@ -159,11 +151,12 @@ namespace Toreo {
                                   const bool visible){
     Visualizer::ObjectElement object = { new Objects(shader_, objects, hollow_square_,
                                          ao_square_, solid_square_, solid_arrow_, ao_arrow_,
-                                         Visualizer::SQUARE), name, visible };
+                                         Visualizer::SQUARE), name, visible, {}, {} };
     if(transformation_matrix != nullptr)
       object.object->set_transformation_matrix(transformation_matrix);
 
     objects_.push_back(object);
+    core_->request_redraw();
     return objects_.size() - 1;
   }
 
@@ -183,6 +176,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -193,6 +187,7 @@ namespace Toreo {
   bool ObjectManager::set_visibility(OMid id, const bool visible){
     if(objects_.size() > id){
       objects_[id].visibility = visible;
+      core_->request_redraw();
       return true;
     }else
       return false;
@@ -202,6 +197,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->translate(-y, z, -x);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -213,6 +209,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->rotate(-pitch, yaw, -roll);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -224,6 +221,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->rotate_in_z(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -235,6 +233,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->rotate_in_x(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -246,6 +245,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr){
         objects_[id].object->rotate_in_y(angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -257,6 +257,7 @@ namespace Toreo {
     if(objects_.size() > id)
       if(objects_[id].object != nullptr && objects_[id].visibility){
         objects_[id].object->update();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -265,9 +266,10 @@ namespace Toreo {
   }
 
   void ObjectManager::update_all(){
-    for(Visualizer::ObjectElement object : objects_)
+    for(Visualizer::ObjectElement &object : objects_)
       if(object.object != nullptr && object.visibility)
         object.object->update();
+    core_->request_redraw();
   }
 
   bool ObjectManager::draw(OMid id){
@@ -282,9 +284,12 @@ namespace Toreo {
   }
 
   void ObjectManager::draw_all(){
-    for(Visualizer::ObjectElement object : objects_)
-      if(object.object != nullptr && object.visibility)
+    for(Visualizer::ObjectElement &object : objects_)
+      if(object.object != nullptr && object.visibility){
+        if(object.refresh && object.refresh())
+          object.object->update();
         object.object->draw();
+      }
   }
 
   bool ObjectManager::delete_object(OMid id){
@@ -294,6 +299,8 @@ namespace Toreo {
           objects_[id].connection.disconnect();
         delete objects_[id].object;
         objects_[id].object = nullptr;
+        objects_[id].refresh.clear();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -302,13 +309,14 @@ namespace Toreo {
   }
 
   void ObjectManager::purge(){
-    for(Visualizer::ObjectElement object : objects_)
+    for(Visualizer::ObjectElement &object : objects_)
       if(object.object != nullptr){
         if(object.connection.connected())
           object.connection.disconnect();
         delete object.object;
       }
     objects_.clear();
+    core_->request_redraw();
   }
 
   bool ObjectManager::connect(OMid id, boost::signals2::signal<void ()> *signal){
@@ -331,6 +339,21 @@ namespace Toreo {
     signal_updated_all_ = signal->connect(boost::bind(&ObjectManager::update_all, this));
   }
 
+  void ObjectManager::request_redraw(){
+    core_->request_redraw();
+  }
+
+  bool ObjectManager::unsubscribe(OMid id){
+    if(objects_.size() > id)
+      if(objects_[id].object != nullptr){
+        objects_[id].refresh.clear();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
   void ObjectManager::prepare_hollow_cylinder(){
     Visualizer::ObjectBuffer data[672] = {
       //  position x, y, z...          normal x, y, z...      uv coordinates...   scales..
@@ -2120,10 +2143,4 @@ namespace Toreo {
     ao_arrow_ = new Texture(7, core_->max_anisotropic_filtering(), &ao_solid_arrow);
     stbi_image_free(ao_solid_arrow.data);
   }
-
-  void ObjectManager::updated_camera(){
-    shader_->use();
-    shader_->set_value(u_pv_, core_->camera_matrix_perspective_view());
-    shader_->set_value(u_camera_position_, core_->camera_position());
-  }
 }
@@ -0,0 +1,748 @@
+#include "include/octree_cloud.h"
+#include "include/point_cloud_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+
+namespace Toreo {
+  namespace {
+    const char octree_magic[4] = {'T', 'O', 'C', 'T'};
+    const std::uint32_t octree_version = 1u;
+    // the cell coordinates are packed in 21 bits each, the root has 128 cells per side
+    const unsigned int octree_maximum_depth = 14u;
+    // points read or converted in one step by OctreeCloud::convert()
+    const std::size_t octree_block_points = 1000000u;
+
+    struct BuildNode{
+      OctreeCloud::OctreeNode data;
+      std::vector<std::uint32_t> points;
+    };
+
+    void initialize(OctreeCloud::OctreeNode *data, const float *minimum, const float *maximum,
+                    const float spacing){
+      std::memcpy(data->minimum, minimum, sizeof(data->minimum));
+      std::memcpy(data->maximum, maximum, sizeof(data->maximum));
+      data->spacing = spacing;
+      data->count = 0u;
+      data->offset = 0u;
+      std::fill(data->children, data->children + 8, -1);
+    }
+
+    // bounding box of the octant of a node
+    void octant_box(const int octant, const float *minimum, const float *maximum,
+                    const float *center, float *child_minimum, float *child_maximum){
+      for(int axis = 0; axis < 3; ++axis)
+        if(octant & (1 << axis)){
+          child_minimum[axis] = center[axis];
+          child_maximum[axis] = maximum[axis];
+        }else{
+          child_minimum[axis] = minimum[axis];
+          child_maximum[axis] = center[axis];
+        }
+    }
+
+    template<typename T>
+    T read_value(const unsigned char *data, const unsigned int index){
+      T value;
+      std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+      return value;
+    }
+
+    template<typename T>
+    float integer_value(const unsigned char *data, const unsigned int index,
+                        const bool normalized){
+      const float value{static_cast<float>(read_value<T>(data, index))};
+      return normalized ? std::max(value / std::numeric_limits<T>::max(), -1.0f) : value;
+    }
+
+    // component number index of a field of the point (see Visualizer::PointField)
+    float component(const unsigned char *point, const Visualizer::PointField &field,
+                    const unsigned int index){
+      const unsigned char *data{point + field.offset};
+      switch(field.type){
+      case GL_FLOAT:
+        return read_value<float>(data, index);
+      case GL_DOUBLE:
+        return static_cast<float>(read_value<double>(data, index));
+      case GL_BYTE:
+        return integer_value<std::int8_t>(data, index, field.normalized);
+      case GL_UNSIGNED_BYTE:
+        return integer_value<std::uint8_t>(data, index, field.normalized);
+      case GL_SHORT:
+        return integer_value<std::int16_t>(data, index, field.normalized);
+      case GL_UNSIGNED_SHORT:
+        return integer_value<std::uint16_t>(data, index, field.normalized);
+      case GL_INT:
+        return integer_value<std::int32_t>(data, index, field.normalized);
+      case GL_UNSIGNED_INT:
+        return integer_value<std::uint32_t>(data, index, field.normalized);
+      default:
+        return 0.0f;
+      }
+    }
+
+    int subdivide(const std::vector<Visualizer::pointXYZI> &points,
+                  std::vector<std::uint32_t> *indices, const float *minimum,
+                  const float *maximum, const float spacing, const unsigned int capacity,
+                  const unsigned int depth, std::vector<BuildNode> *nodes){
+      const int index{static_cast<int>(nodes->size())};
+      nodes->push_back(BuildNode());
+
+      initialize(&nodes->back().data, minimum, maximum, spacing);
+
+      if(indices->size() <= capacity || depth >= octree_maximum_depth){
+        nodes->back().points.swap(*indices);
+        return index;
+      }
+
+      // the first point of every cell (with size = spacing) stays in this node,
+      // the rest goes to the children
+      const float center[3] = { (minimum[0] + maximum[0]) * 0.5f,
+                                (minimum[1] + maximum[1]) * 0.5f,
+                                (minimum[2] + maximum[2]) * 0.5f };
+      std::unordered_set<std::uint64_t> cells;
+      std::vector<std::uint32_t> kept, octants[8];
+
+      for(const std::uint32_t i : *indices){
+        const Visualizer::pointXYZI &point = points[i];
+        const std::uint64_t x{static_cast<std::uint64_t>((point.x - minimum[0]) / spacing)};
+        const std::uint64_t y{static_cast<std::uint64_t>((point.y - minimum[1]) / spacing)};
+        const std::uint64_t z{static_cast<std::uint64_t>((point.z - minimum[2]) / spacing)};
+
+        if(cells.insert((x << 42) | (y << 21) | z).second)
+          kept.push_back(i);
+        else
+          octants[(point.x >= center[0] ? 1 : 0) | (point.y >= center[1] ? 2 : 0) |
+                  (point.z >= center[2] ? 4 : 0)].push_back(i);
+      }
+      std::vector<std::uint32_t>().swap(*indices);
+      (*nodes)[index].points.swap(kept);
+
+      for(int octant = 0; octant < 8; ++octant){
+        if(octants[octant].empty()) continue;
+
+        float child_minimum[3], child_maximum[3];
+        octant_box(octant, minimum, maximum, center, child_minimum, child_maximum);
+
+        const int child{subdivide(points, &octants[octant], child_minimum, child_maximum,
+                                  spacing * 0.5f, capacity, depth + 1, nodes)};
+        (*nodes)[index].data.children[octant] = child;
+      }
+      return index;
+    }
+
+    // out-of-core construction of an octree (see OctreeCloud::convert()), the points of every
+    // node are appended to a data file as soon as the node is complete
+    class Converter{
+    public:
+      Converter(const std::string temporary, const unsigned int capacity,
+                const std::size_t chunk_points, std::ofstream *data) :
+        nodes(0),
+        temporary_(temporary),
+        capacity_(capacity),
+        chunk_points_(chunk_points),
+        files_(0u),
+        data_(data),
+        data_size_(0u)
+      {}
+
+      // new temporary file name
+      std::string temporary_file(){
+        return temporary_ + std::to_string(files_++);
+      }
+
+      // creates the node and subtree of the count points of the file path (it is deleted),
+      // returns the node index or -1 if a file could not be read or written
+      int node(const std::string path, const std::uint64_t count, const float *minimum,
+               const float *maximum, const float spacing, const unsigned int depth){
+        if(count <= chunk_points_ || depth >= octree_maximum_depth)
+          return subtree(path, count, minimum, maximum, spacing, depth);
+
+        const int index{static_cast<int>(nodes.size())};
+        nodes.push_back(BuildNode());
+        initialize(&nodes.back().data, minimum, maximum, spacing);
+
+        // the first point of every cell stays in this node (like subdivide()),
+        // the rest is streamed into the file of its octant
+        const float center[3] = { (minimum[0] + maximum[0]) * 0.5f,
+                                  (minimum[1] + maximum[1]) * 0.5f,
+                                  (minimum[2] + maximum[2]) * 0.5f };
+        std::string paths[8];
+        std::ofstream octants[8];
+        std::uint64_t counts[8] = {0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u};
+        bool good{true};
+        {
+          std::unordered_set<std::uint64_t> cells;
+          std::vector<Visualizer::pointXYZI> kept, block;
+          std::ifstream file(path, std::ios::binary);
+
+          for(std::uint64_t read = 0u; read < count && good; read += block.size()){
+            block.resize(std::min<std::uint64_t>(count - read, octree_block_points));
+            good = file.read(reinterpret_cast<char*>(block.data()),
+                             block.size() * sizeof(Visualizer::pointXYZI)).good();
+            if(!good) break;
+
+            for(const Visualizer::pointXYZI &point : block){
+              const std::uint64_t x{static_cast<std::uint64_t>((point.x - minimum[0]) / spacing)};
+              const std::uint64_t y{static_cast<std::uint64_t>((point.y - minimum[1]) / spacing)};
+              const std::uint64_t z{static_cast<std::uint64_t>((point.z - minimum[2]) / spacing)};
+
+              if(cells.insert((x << 42) | (y << 21) | z).second){
+                kept.push_back(point);
+                continue;
+              }
+
+              const int octant{(point.x >= center[0] ? 1 : 0) | (point.y >= center[1] ? 2 : 0) |
+                               (point.z >= center[2] ? 4 : 0)};
+              if(!octants[octant].is_open()){
+                paths[octant] = temporary_file();
+                octants[octant].open(paths[octant], std::ios::binary | std::ios::trunc);
+              }
+              octants[octant].write(reinterpret_cast<const char*>(&point),
+                                    sizeof(Visualizer::pointXYZI));
+              ++counts[octant];
+            }
+          }
+          file.close();
+          std::remove(path.c_str());
+
+          good = good && append(kept.data(), kept.size(), &nodes[index].data);
+        }
+
+        for(int octant = 0; octant < 8; ++octant)
+          if(octants[octant].is_open()){
+            octants[octant].close();
+            good = good && !octants[octant].fail();
+          }
+
+        for(int octant = 0; octant < 8; ++octant){
+          if(counts[octant] == 0u) continue;
+
+          if(!good){
+            std::remove(paths[octant].c_str());
+            continue;
+          }
+
+          float child_minimum[3], child_maximum[3];
+          octant_box(octant, minimum, maximum, center, child_minimum, child_maximum);
+
+          const int child{node(paths[octant], counts[octant], child_minimum, child_maximum,
+                               spacing * 0.5f, depth + 1)};
+          nodes[index].data.children[octant] = child;
+          good = child >= 0;
+        }
+        return good ? index : -1;
+      }
+
+      std::vector<BuildNode> nodes;
+
+    private:
+      // builds the subtree of a node that fits in memory
+      int subtree(const std::string path, const std::uint64_t count, const float *minimum,
+                  const float *maximum, const float spacing, const unsigned int depth){
+        std::vector<Visualizer::pointXYZI> points(count);
+        std::ifstream file(path, std::ios::binary);
+        const bool read{file.read(reinterpret_cast<char*>(points.data()),
+                                  count * sizeof(Visualizer::pointXYZI)).good()};
+        file.close();
+        std::remove(path.c_str());
+        if(!read) return -1;
+
+        std::vector<std::uint32_t> indices(count);
+        for(std::size_t i = 0; i < indices.size(); ++i)
+          indices[i] = static_cast<std::uint32_t>(i);
+
+        const std::size_t first{nodes.size()};
+        const int index{subdivide(points, &indices, minimum, maximum, spacing, capacity_, depth,
+                                  &nodes)};
+
+        std::vector<Visualizer::pointXYZI> block;
+        for(std::size_t i = first; i < nodes.size(); ++i){
+          BuildNode &node = nodes[i];
+          block.resize(node.points.size());
+          for(std::size_t j = 0; j < node.points.size(); ++j)
+            block[j] = points[node.points[j]];
+          std::vector<std::uint32_t>().swap(node.points);
+
+          if(!append(block.data(), block.size(), &node.data)) return -1;
+        }
+        return index;
+      }
+
+      bool append(const Visualizer::pointXYZI *points, const std::size_t count,
+                  OctreeCloud::OctreeNode *data){
+        data->count = static_cast<std::uint32_t>(count);
+        data->offset = data_size_;
+        data_size_ += count * sizeof(Visualizer::pointXYZI);
+
+        data_->write(reinterpret_cast<const char*>(points), count * sizeof(Visualizer::pointXYZI));
+        return data_->good();
+      }
+
+      std::string temporary_;
+      unsigned int capacity_;
+      std::size_t chunk_points_;
+      unsigned int files_;
+      std::ofstream *data_;
+      std::uint64_t data_size_;
+    };
+  }
+
+  OctreeCloud::OctreeCloud(Shader *shader_program, const std::string path,
+                           const Visualizer::ColorMode color_mode, const float point_size,
+                           const float maximum_intensity_value) :
+    shader_(shader_program),
+    path_(path),
+    error_log_(),
+    is_loaded_(false),
+    point_count_(0u),
+    nodes_(0),
+    cache_(),
+    cache_points_(0u),
+    cache_size_(15000000u),
+    frame_(0u),
+    primary_model_(nullptr),
+    secondary_model_(),
+    identity_matrix_(),
+    color_mode_(color_mode),
+    point_size_(point_size),
+    maximum_intensity_value_(maximum_intensity_value),
+    colormap_(),
+    workers_(new WorkerPool(2u))
+  {
+    is_loaded_ = open();
+
+    const algebraica::vec3f palette[4]{algebraica::vec3f(0.2, 0.5, 0.7),
+                                       algebraica::vec3f(0, 1, 0), algebraica::vec3f(1, 1, 0),
+                                       algebraica::vec3f(1, 0, 0)};
+    colormap_.set(palette, 4u);
+
+    shader_->use();
+    // GLSL attribute locations
+    i_position_         = shader_->attribute_location("i_position");
+    i_intensity_        = shader_->attribute_location("i_intensity");
+    // GLSL uniform locations
+    u_primary_model_    = shader_->uniform_location("u_primary_model");
+    u_secondary_model_  = shader_->uniform_location("u_secondary_model");
+    u_color_mode_       = shader_->uniform_location("u_color_mode");
+    u_intensity_range_  = shader_->uniform_location("u_intensity_range");
+    u_scale_            = shader_->uniform_location("u_scale");
+    u_offset_           = shader_->uniform_location("u_offset");
+  }
+
+  OctreeCloud::~OctreeCloud(){
+    // no worker may write into loaded_ after this
+    delete workers_;
+
+    for(Node &node : nodes_)
+      if(node.buffer) delete node.buffer;
+  }
+
+  bool OctreeCloud::build(const std::string path, const std::vector<Visualizer::pointXYZI> &points,
+                          const unsigned int node_capacity){
+    if(points.empty()) return false;
+
+    // cubic bounding box, the spacing is the same in every axis
+    float minimum[3] = { points[0].x, points[0].y, points[0].z };
+    float maximum[3] = { points[0].x, points[0].y, points[0].z };
+    for(const Visualizer::pointXYZI &point : points)
+      for(int axis = 0; axis < 3; ++axis){
+        minimum[axis] = std::min(minimum[axis], point.data[axis]);
+        maximum[axis] = std::max(maximum[axis], point.data[axis]);
+      }
+
+    float size{std::max(maximum[0] - minimum[0],
+                        std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]))};
+    size = (size > 0.0f)? size * 1.001f : 1.0f;
+    for(int axis = 0; axis < 3; ++axis)
+      maximum[axis] = minimum[axis] + size;
+
+    std::vector<std::uint32_t> indices(points.size());
+    for(std::size_t i = 0; i < points.size(); ++i)
+      indices[i] = static_cast<std::uint32_t>(i);
+
+    std::vector<BuildNode> nodes;
+    subdivide(points, &indices, minimum, maximum, size / 128.0f,
+              node_capacity > 0u ? node_capacity : 1u, 0u, &nodes);
+
+    OctreeHeader header;
+    std::memcpy(header.magic, octree_magic, sizeof(header.magic));
+    header.version = octree_version;
+    header.node_count = static_cast<std::uint32_t>(nodes.size());
+    header.point_type = POINT_XYZI;
+    header.point_count = points.size();
+
+    std::uint64_t offset{sizeof(OctreeHeader) + nodes.size() * sizeof(OctreeNode)};
+    for(BuildNode &node : nodes){
+      node.data.count = static_cast<std::uint32_t>(node.points.size());
+      node.data.offset = offset;
+      offset += node.points.size() * sizeof(Visualizer::pointXYZI);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(OctreeHeader));
+    for(const BuildNode &node : nodes)
+      file.write(reinterpret_cast<const char*>(&node.data), sizeof(OctreeNode));
+
+    std::vector<Visualizer::pointXYZI> block;
+    for(const BuildNode &node : nodes){
+      block.resize(node.points.size());
+      for(std::size_t i = 0; i < node.points.size(); ++i)
+        block[i] = points[node.points[i]];
+      file.write(reinterpret_cast<const char*>(block.data()),
+                 block.size() * sizeof(Visualizer::pointXYZI));
+    }
+    return file.good();
+  }
+
+  bool OctreeCloud::convert(const std::string path, const std::string source_path,
+                            const unsigned int node_capacity, const std::size_t chunk_points){
+    PointCloudFile source(source_path);
+    const Visualizer::PointLayout &layout = source.layout();
+    if(!source.is_loaded() || source.size() == 0u || layout.position.count < 3u) return false;
+
+    const unsigned int capacity{node_capacity > 0u ? node_capacity : 1u};
+    const std::string temporary{path + ".tmp"};
+    std::ofstream data(temporary, std::ios::binary | std::ios::trunc);
+    Converter converter(temporary, capacity, std::max<std::size_t>(chunk_points, capacity), &data);
+
+    // the points are converted into Visualizer::pointXYZI in the file of the root while
+    // the bounding box is computed
+    const std::string root_path{converter.temporary_file()};
+    std::ofstream root(root_path, std::ios::binary | std::ios::trunc);
+
+    const float scale[3] = { source.scale().x, source.scale().y, source.scale().z };
+    const float offset[3] = { source.offset().x, source.offset().y, source.offset().z };
+    float minimum[3], maximum[3];
+    std::fill(minimum, minimum + 3, std::numeric_limits<float>::max());
+    std::fill(maximum, maximum + 3, std::numeric_limits<float>::lowest());
+
+    bool good{data.is_open() && root.is_open()};
+    std::vector<Visualizer::pointXYZI> block;
+    for(std::uint64_t first = 0u; first < source.size() && good; first += block.size()){
+      block.resize(std::min<std::uint64_t>(source.size() - first, octree_block_points));
+      const unsigned char *points{source.map(first, block.size())};
+      if(points == nullptr){
+        good = false;
+        break;
+      }
+
+      for(std::size_t i = 0; i < block.size(); ++i){
+        const unsigned char *point{points + i * layout.stride};
+        Visualizer::pointXYZI &converted = block[i];
+
+        for(unsigned int axis = 0; axis < 3u; ++axis){
+          converted.data[axis] = component(point, layout.position, axis) * scale[axis] +
+                                 offset[axis];
+          minimum[axis] = std::min(minimum[axis], converted.data[axis]);
+          maximum[axis] = std::max(maximum[axis], converted.data[axis]);
+        }
+        converted.intensity = (layout.intensity.count > 0u)?
+                                component(point, layout.intensity, 0u) : 0.0f;
+      }
+      good = root.write(reinterpret_cast<const char*>(block.data()),
+                        block.size() * sizeof(Visualizer::pointXYZI)).good();
+    }
+    source.unmap();
+    root.close();
+
+    // cubic bounding box like build()
+    float size{std::max(maximum[0] - minimum[0],
+                        std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]))};
+    size = (size > 0.0f)? size * 1.001f : 1.0f;
+    for(int axis = 0; axis < 3; ++axis)
+      maximum[axis] = minimum[axis] + size;
+
+    if(good)
+      good = converter.node(root_path, source.size(), minimum, maximum, size / 128.0f, 0u) == 0;
+    else
+      std::remove(root_path.c_str());
+    data.close();
+
+    if(good){
+      OctreeHeader header;
+      std::memcpy(header.magic, octree_magic, sizeof(header.magic));
+      header.version = octree_version;
+      header.node_count = static_cast<std::uint32_t>(converter.nodes.size());
+      header.point_type = POINT_XYZI;
+      header.point_count = source.size();
+
+      // the points follow the node table
+      const std::uint64_t table{sizeof(OctreeHeader) +
+                                converter.nodes.size() * sizeof(OctreeNode)};
+
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(OctreeHeader));
+      for(const BuildNode &node : converter.nodes){
+        OctreeNode node_data{node.data};
+        node_data.offset += table;
+        file.write(reinterpret_cast<const char*>(&node_data), sizeof(OctreeNode));
+      }
+
+      std::ifstream points(temporary, std::ios::binary);
+      file << points.rdbuf();
+      good = file.good();
+    }
+
+    std::remove(temporary.c_str());
+    return good;
+  }
+
+  bool OctreeCloud::is_loaded(){
+    return is_loaded_;
+  }
+
+  const std::string OctreeCloud::error_log(){
+    return error_log_;
+  }
+
+  std::uint64_t OctreeCloud::size(){
+    return point_count_;
+  }
+
+  void OctreeCloud::set_color_mode(const Visualizer::ColorMode color_mode){
+    color_mode_ = color_mode;
+  }
+
+  void OctreeCloud::set_transformation_matrix(const algebraica::mat4f *transformation_matrix){
+    primary_model_ = transformation_matrix;
+  }
+
+  void OctreeCloud::set_point_size(const float point_size){
+    point_size_ = point_size;
+  }
+
+  void OctreeCloud::set_maximum_intensity_value(const float maximum_intensity_value){
+    maximum_intensity_value_ = maximum_intensity_value;
+  }
+
+  void OctreeCloud::set_cache_size(const std::size_t points){
+    cache_size_ = points;
+  }
+
+  void OctreeCloud::set_notifier(const boost::function<void ()> &notifier){
+    notifier_ = notifier;
+  }
+
+  std::size_t OctreeCloud::draw(const algebraica::mat4f &pv, const algebraica::vec3f &camera,
+                                const float screen_factor, const std::size_t point_budget){
+    if(!is_loaded_ || nodes_.empty() || !shader_->use()) return 0u;
+
+    ++frame_;
+    upload_nodes();
+
+    const algebraica::mat4f model{(primary_model_ ? *primary_model_ : identity_matrix_) *
+                                  secondary_model_};
+    const algebraica::mat4f mvp{pv * model};
+
+    // nodes with the biggest error (spacing in pixels) first
+    std::priority_queue<std::pair<float, int> > queue;
+    std::vector<int> visible;
+    std::size_t points{0u};
+
+    if(is_visible(nodes_[0], mvp.data()))
+      queue.push(std::make_pair(screen_error(nodes_[0], model.data(), camera, screen_factor), 0));
+
+    while(!queue.empty()){
+      const int index{queue.top().second};
+      queue.pop();
+
+      const OctreeNode &data = nodes_[index].data;
+      if(points + data.count > point_budget) break;
+      points += data.count;
+      visible.push_back(index);
+
+      for(const std::int32_t child : data.children)
+        if(child >= 0 && is_visible(nodes_[child], mvp.data())){
+          const float error{screen_error(nodes_[child], model.data(), camera, screen_factor)};
+          // the points of the child would be closer than one pixel to its parent's points
+          if(error > 1.0f)
+            queue.push(std::make_pair(error, child));
+        }
+    }
+
+    shader_->set_value(u_primary_model_, primary_model_ ? *primary_model_ : identity_matrix_);
+    shader_->set_value(u_secondary_model_, secondary_model_);
+    shader_->set_value(u_color_mode_, static_cast<float>(color_mode_));
+    shader_->set_value(u_intensity_range_, maximum_intensity_value_);
+    shader_->set_value(u_scale_, algebraica::vec3f(1.0f, 1.0f, 1.0f));
+    shader_->set_value(u_offset_, algebraica::vec3f());
+    colormap_.bind();
+
+    glPointSize(point_size_);
+
+    std::size_t drawn{0u};
+    for(const int index : visible){
+      Node &node = nodes_[index];
+      if(node.buffer){
+        node.buffer->vertex_bind();
+        glDrawArrays(GL_POINTS, 0, node.data.count);
+        node.buffer->vertex_release();
+
+        cache_.splice(cache_.begin(), cache_, node.cached);
+        node.frame = frame_;
+        drawn += node.data.count;
+      }else if(!node.is_loading){
+        node.is_loading = true;
+        workers_->post(boost::bind(&OctreeCloud::load_node, this, index,
+                                   node.data.offset, node.data.count));
+      }
+    }
+
+    glPointSize(1.0f);
+
+    evict_nodes();
+    return drawn;
+  }
+
+  bool OctreeCloud::open(){
+    std::ifstream file(path_, std::ios::binary);
+    if(!file.is_open()){
+      error_log_ = "The file: " + path_ + " was not found.\n";
+      return false;
+    }
+
+    OctreeHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(OctreeHeader));
+    if(!file.good() || std::memcmp(header.magic, octree_magic, sizeof(header.magic)) != 0 ||
+       header.version != octree_version || header.point_type != POINT_XYZI){
+      error_log_ = "The file: " + path_ + " is not a valid octree.\n";
+      return false;
+    }
+
+    std::vector<OctreeNode> table(header.node_count);
+    file.read(reinterpret_cast<char*>(table.data()), table.size() * sizeof(OctreeNode));
+    if(!file.good()){
+      error_log_ = "The file: " + path_ + " is incomplete.\n";
+      return false;
+    }
+
+    nodes_.resize(table.size());
+    for(std::size_t i = 0; i < table.size(); ++i)
+      nodes_[i].data = table[i];
+
+    point_count_ = header.point_count;
+    return true;
+  }
+
+  void OctreeCloud::load_node(const int node, const std::uint64_t offset,
+                              const std::uint32_t count){
+    LoadedNode loaded;
+    loaded.node = node;
+    loaded.points.resize(count);
+
+    std::ifstream file(path_, std::ios::binary);
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(loaded.points.data()),
+              count * sizeof(Visualizer::pointXYZI));
+    if(!file.good()) loaded.points.clear();
+
+    {
+      boost::lock_guard<boost::mutex> lock(loaded_mutex_);
+      loaded_.push_back(std::move(loaded));
+    }
+    if(notifier_) notifier_();
+  }
+
+  void OctreeCloud::upload_nodes(){
+    std::vector<LoadedNode> loaded;
+    {
+      boost::lock_guard<boost::mutex> lock(loaded_mutex_);
+      loaded.swap(loaded_);
+    }
+
+    const GLsizei type_size{sizeof(Visualizer::pointXYZI)};
+    for(LoadedNode &new_node : loaded){
+      Node &node = nodes_[new_node.node];
+      node.is_loading = false;
+      // reading error: the node stays empty
+      if(new_node.points.size() != node.data.count) continue;
+
+      node.buffer = new Buffer(true);
+      node.buffer->vertex_bind();
+      node.buffer->allocate_array(new_node.points.data(), node.data.count * type_size,
+                                  GL_STATIC_DRAW);
+      node.buffer->enable(i_position_);
+      node.buffer->attributte_buffer(i_position_, _3D, 0, type_size);
+      node.buffer->enable(i_intensity_);
+      node.buffer->attributte_buffer(i_intensity_, _1D, sizeof(algebraica::vec3f), type_size);
+      node.buffer->vertex_release();
+
+      cache_.push_front(new_node.node);
+      node.cached = cache_.begin();
+      cache_points_ += node.data.count;
+    }
+  }
+
+  void OctreeCloud::evict_nodes(){
+    while(cache_points_ > cache_size_ && !cache_.empty()){
+      Node &node = nodes_[cache_.back()];
+      // the rest of the list was also used in this frame
+      if(node.frame == frame_) break;
+
+      delete node.buffer;
+      node.buffer = nullptr;
+      cache_points_ -= node.data.count;
+      cache_.pop_back();
+    }
+  }
+
+  bool OctreeCloud::is_visible(const Node &node, const float *mvp){
+    const float *minimum{node.data.minimum}, *maximum{node.data.maximum};
+    // number of corners outside of each clipping plane: -x, +x, -y, +y, -z, +z
+    int outside[6] = {0, 0, 0, 0, 0, 0};
+
+    for(int corner = 0; corner < 8; ++corner){
+      const float x{(corner & 1) ? maximum[0] : minimum[0]};
+      const float y{(corner & 2) ? maximum[1] : minimum[1]};
+      const float z{(corner & 4) ? maximum[2] : minimum[2]};
+      // OpenGL coordinates
+      const float vertex[4] = { -y, z, -x, 1.0f };
+
+      float clip[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+      for(int row = 0; row < 4; ++row)
+        for(int column = 0; column < 4; ++column)
+          clip[row] += mvp[column * 4 + row] * vertex[column];
+
+      for(int axis = 0; axis < 3; ++axis){
+        if(clip[axis] < -clip[3]) ++outside[axis * 2];
+        if(clip[axis] > clip[3]) ++outside[axis * 2 + 1];
+      }
+    }
+
+    for(const int corners : outside)
+      if(corners == 8) return false;
+    return true;
+  }
+
+  float OctreeCloud::screen_error(const Node &node, const float *model,
+                                  const algebraica::vec3f &camera, const float screen_factor){
+    const float *minimum{node.data.minimum}, *maximum{node.data.maximum};
+    const float center[4] = { -(minimum[1] + maximum[1]) * 0.5f, (minimum[2] + maximum[2]) * 0.5f,
+                              -(minimum[0] + maximum[0]) * 0.5f, 1.0f };
+
+    float world[3] = { 0.0f, 0.0f, 0.0f };
+    for(int row = 0; row < 3; ++row)
+      for(int column = 0; column < 4; ++column)
+        world[row] += model[column * 4 + row] * center[column];
+
+    const float dx{world[0] - camera.x}, dy{world[1] - camera.y}, dz{world[2] - camera.z};
+    const float size[3] = { maximum[0] - minimum[0], maximum[1] - minimum[1],
+                            maximum[2] - minimum[2] };
+    const float radius{0.5f * std::sqrt(size[0] * size[0] + size[1] * size[1] +
+                                        size[2] * size[2])};
+    // the camera is inside (or very close to) the node
+    const float distance{std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - radius, 0.01f)};
+
+    return node.data.spacing * screen_factor / distance;
+  }
+}
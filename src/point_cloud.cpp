@@ -1,6 +1,24 @@
 #include "include/point_cloud.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
 namespace Toreo {
+  namespace {
+    bool same_field(const Visualizer::PointField &a, const Visualizer::PointField &b){
+      return a.offset == b.offset && a.type == b.type && a.count == b.count &&
+             a.normalized == b.normalized;
+    }
+
+    bool same_layout(const Visualizer::PointLayout &a, const Visualizer::PointLayout &b){
+      return a.stride == b.stride && same_field(a.position, b.position) &&
+             same_field(a.intensity, b.intensity) && same_field(a.color, b.color) &&
+             same_field(a.alpha, b.alpha);
+    }
+  }
+
   PointCloud::PointCloud(Shader *shader_program,
                          const std::vector<Visualizer::pointXYZ> *point_cloud,
                          const algebraica::vec3f rgb_color, const float point_size,
@@ -11,6 +29,11 @@ namespace Toreo {
     point_cloud_xyzi_(nullptr),
     point_cloud_rgb_(nullptr),
     point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
     primary_model_(nullptr),
     secondary_model_(),
     color_mode_(Visualizer::MONOCHROME),
@@ -21,8 +44,14 @@ namespace Toreo {
     color_size_(1),
     type_size_(sizeof(Visualizer::pointXYZ)),
     data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
     offset_(sizeof(algebraica::vec3f)),
-    offset_x2_(offset_ + offset_)
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(1.0f, 1.0f, 1.0f),
+    quantization_offset_()
   {
     initialize();
   }
@@ -37,6 +66,11 @@ namespace Toreo {
     point_cloud_xyzi_(point_cloud),
     point_cloud_rgb_(nullptr),
     point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
     primary_model_(nullptr),
     secondary_model_(),
     color_mode_(color_mode),
@@ -48,8 +82,14 @@ namespace Toreo {
     color_size_(4),
     type_size_(sizeof(Visualizer::pointXYZI)),
     data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
     offset_(sizeof(algebraica::vec3f)),
-    offset_x2_(offset_ + offset_)
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(1.0f, 1.0f, 1.0f),
+    quantization_offset_()
   {
     initialize();
   }
@@ -63,6 +103,11 @@ namespace Toreo {
     point_cloud_xyzi_(nullptr),
     point_cloud_rgb_(point_cloud),
     point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
     primary_model_(nullptr),
     secondary_model_(),
     color_mode_(Visualizer::NONE),
@@ -73,8 +118,14 @@ namespace Toreo {
     color_size_(0),
     type_size_(sizeof(Visualizer::pointXYZRGB)),
     data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
     offset_(sizeof(algebraica::vec3f)),
-    offset_x2_(offset_ + offset_)
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(1.0f, 1.0f, 1.0f),
+    quantization_offset_()
   {
     initialize();
   }
@@ -88,6 +139,11 @@ namespace Toreo {
     point_cloud_xyzi_(nullptr),
     point_cloud_rgb_(nullptr),
     point_cloud_rgba_(point_cloud),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
     primary_model_(nullptr),
     secondary_model_(),
     color_mode_(Visualizer::NONE),
@@ -98,33 +154,212 @@ namespace Toreo {
     color_size_(0),
     type_size_(sizeof(Visualizer::pointXYZRGBA)),
     data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
+    offset_(sizeof(algebraica::vec3f)),
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(1.0f, 1.0f, 1.0f),
+    quantization_offset_()
+  {
+    initialize();
+  }
+
+  PointCloud::PointCloud(Shader *shader_program,
+                         const std::vector<Visualizer::pointXYZIq16> *point_cloud,
+                         const algebraica::vec3f scale, const algebraica::vec3f offset,
+                         const Visualizer::ColorMode color_mode, const float point_size,
+                         const float maximum_intensity_value) :
+    shader_(shader_program),
+    buffer_(true),
+    point_cloud_xyz_(nullptr),
+    point_cloud_xyzi_(nullptr),
+    point_cloud_rgb_(nullptr),
+    point_cloud_rgba_(nullptr),
+    point_cloud_q16_(point_cloud),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
+    primary_model_(nullptr),
+    secondary_model_(),
+    color_mode_(color_mode),
+    point_size_(point_size),
+    maximum_intensity_value_(maximum_intensity_value),
+    color_palette_{algebraica::vec3f(0.2, 0.5, 0.7), algebraica::vec3f(0, 1, 0),
+                   algebraica::vec3f(1, 1, 0), algebraica::vec3f(1, 0, 0)},
+    type_(POINT_XYZI_Q16),
+    color_size_(4),
+    type_size_(sizeof(Visualizer::pointXYZIq16)),
+    data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
     offset_(sizeof(algebraica::vec3f)),
-    offset_x2_(offset_ + offset_)
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(scale),
+    quantization_offset_(offset)
   {
     initialize();
   }
 
+  PointCloud::PointCloud(Shader *shader_program,
+                         const std::vector<Visualizer::pointXYZRGB8> *point_cloud,
+                         const algebraica::vec3f scale, const algebraica::vec3f offset,
+                         const float point_size, const float maximum_intensity_value) :
+    shader_(shader_program),
+    buffer_(true),
+    point_cloud_xyz_(nullptr),
+    point_cloud_xyzi_(nullptr),
+    point_cloud_rgb_(nullptr),
+    point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(point_cloud),
+    point_cloud_raw_(nullptr),
+    file_(nullptr),
+    layout_(),
+    primary_model_(nullptr),
+    secondary_model_(),
+    color_mode_(Visualizer::NONE),
+    point_size_(point_size),
+    maximum_intensity_value_(maximum_intensity_value),
+    color_palette_{},
+    type_(POINT_XYZRGB8),
+    color_size_(0),
+    type_size_(sizeof(Visualizer::pointXYZRGB8)),
+    data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
+    offset_(sizeof(algebraica::vec3f)),
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(scale),
+    quantization_offset_(offset)
+  {
+    initialize();
+  }
+
+  PointCloud::PointCloud(Shader *shader_program, PointCloudFile *file,
+                         const Visualizer::ColorMode color_mode, const float point_size,
+                         const float maximum_intensity_value) :
+    shader_(shader_program),
+    buffer_(true),
+    point_cloud_xyz_(nullptr),
+    point_cloud_xyzi_(nullptr),
+    point_cloud_rgb_(nullptr),
+    point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(nullptr),
+    file_(file),
+    layout_(file->layout()),
+    primary_model_(nullptr),
+    secondary_model_(),
+    color_mode_(color_mode),
+    point_size_(point_size),
+    maximum_intensity_value_(maximum_intensity_value),
+    color_palette_{algebraica::vec3f(0.2, 0.5, 0.7), algebraica::vec3f(0, 1, 0),
+                   algebraica::vec3f(1, 1, 0), algebraica::vec3f(1, 0, 0)},
+    type_(POINT_LAYOUT),
+    color_size_(4),
+    type_size_(file->layout().stride),
+    data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
+    offset_(sizeof(algebraica::vec3f)),
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(file->scale()),
+    quantization_offset_(file->offset())
+  {
+    initialize();
+  }
+
+  PointCloud::PointCloud(Shader *shader_program, const std::vector<unsigned char> *point_cloud,
+                         const Visualizer::PointLayout layout,
+                         const Visualizer::ColorMode color_mode, const float point_size,
+                         const float maximum_intensity_value) :
+    shader_(shader_program),
+    buffer_(true),
+    point_cloud_xyz_(nullptr),
+    point_cloud_xyzi_(nullptr),
+    point_cloud_rgb_(nullptr),
+    point_cloud_rgba_(nullptr),
+    point_cloud_q16_(nullptr),
+    point_cloud_rgb8_(nullptr),
+    point_cloud_raw_(point_cloud),
+    file_(nullptr),
+    layout_(layout),
+    primary_model_(nullptr),
+    secondary_model_(),
+    color_mode_(color_mode),
+    point_size_(point_size),
+    maximum_intensity_value_(maximum_intensity_value),
+    color_palette_{algebraica::vec3f(0.2, 0.5, 0.7), algebraica::vec3f(0, 1, 0),
+                   algebraica::vec3f(1, 1, 0), algebraica::vec3f(1, 0, 0)},
+    type_(POINT_LAYOUT),
+    color_size_(4),
+    type_size_(layout.stride),
+    data_size_(0),
+    first_(0),
+    stream_(),
+    is_streaming_(false),
+    region_(0),
+    offset_(sizeof(algebraica::vec3f)),
+    offset_x2_(offset_ + offset_),
+    quantization_scale_(1.0f, 1.0f, 1.0f),
+    quantization_offset_()
+  {
+    initialize();
+  }
+
+  PointCloud::~PointCloud(){
+    // waits for the running filter, it uses voxel_grid_
+    if(filter_worker_) delete filter_worker_;
+    if(file_) delete file_;
+    clear_scans();
+    if(batch_) batch_->leave(batch_handle_);
+    if(index_) delete index_;
+    if(processor_) delete processor_;
+  }
+
   void PointCloud::change_input(const std::vector<Visualizer::pointXYZ> *point_cloud){
     point_cloud_xyz_ = point_cloud;
     if(type_ != POINT_XYZ){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
       point_cloud_xyzi_ = nullptr;
       point_cloud_rgb_ = nullptr;
       point_cloud_rgba_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
       color_mode_ = Visualizer::MONOCHROME;
       type_ = POINT_XYZ;
       color_size_ = 1;
       type_size_ = sizeof(Visualizer::pointXYZ);
+      update_colormap();
+      restart();
     }
+    buffered_ = false;
     data_size_ = 0;
-    restart();
   }
 
   void PointCloud::change_input(const std::vector<Visualizer::pointXYZI> *point_cloud){
     point_cloud_xyzi_ = point_cloud;
     if(type_ != POINT_XYZI){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
       point_cloud_xyz_ = nullptr;
       point_cloud_rgb_ = nullptr;
       point_cloud_rgba_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
       color_mode_ = Visualizer::VARIABLE;
       color_palette_[0] = algebraica::vec3f(0.2, 0.5, 0.7); //grayish blue
       color_palette_[1] = algebraica::vec3f(0, 1, 0);       //green
@@ -133,55 +368,160 @@ namespace Toreo {
       type_ = POINT_XYZI;
       color_size_ = 4;
       type_size_ = sizeof(Visualizer::pointXYZI);
+      update_colormap();
+      restart();
     }
+    buffered_ = false;
     data_size_ = 0;
-    restart();
   }
 
   void PointCloud::change_input(const std::vector<Visualizer::pointXYZRGB> *point_cloud){
     point_cloud_rgb_ = point_cloud;
     if(type_ != POINT_XYZRGB){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
       point_cloud_xyz_ = nullptr;
       point_cloud_xyzi_ = nullptr;
       point_cloud_rgba_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
       color_mode_ = Visualizer::NONE;
       type_ = POINT_XYZRGB;
       color_size_ = 0;
       type_size_ = sizeof(Visualizer::pointXYZRGB);
+      restart();
     }
+    buffered_ = false;
     data_size_ = 0;
-    restart();
   }
 
   void PointCloud::change_input(const std::vector<Visualizer::pointXYZRGBA> *point_cloud){
     point_cloud_rgba_ = point_cloud;
     if(type_ != POINT_XYZRGBA){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
       point_cloud_xyz_ = nullptr;
       point_cloud_xyzi_ = nullptr;
       point_cloud_rgb_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
       color_mode_ = Visualizer::NONE;
       type_ = POINT_XYZRGBA;
       color_size_ = 0;
       type_size_ = sizeof(Visualizer::pointXYZRGBA);
+      restart();
     }
+    buffered_ = false;
     data_size_ = 0;
-    restart();
+  }
+
+  void PointCloud::change_input(const std::vector<Visualizer::pointXYZIq16> *point_cloud){
+    point_cloud_q16_ = point_cloud;
+    if(type_ != POINT_XYZI_Q16){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
+      point_cloud_xyz_ = nullptr;
+      point_cloud_xyzi_ = nullptr;
+      point_cloud_rgb_ = nullptr;
+      point_cloud_rgba_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
+      color_mode_ = Visualizer::VARIABLE;
+      color_palette_[0] = algebraica::vec3f(0.2, 0.5, 0.7); //grayish blue
+      color_palette_[1] = algebraica::vec3f(0, 1, 0);       //green
+      color_palette_[2] = algebraica::vec3f(1, 1, 0);       //yellow
+      color_palette_[3] = algebraica::vec3f(1, 0, 0);       //red
+      type_ = POINT_XYZI_Q16;
+      color_size_ = 4;
+      type_size_ = sizeof(Visualizer::pointXYZIq16);
+      update_colormap();
+      restart();
+    }
+    buffered_ = false;
+    data_size_ = 0;
+  }
+
+  void PointCloud::change_input(const std::vector<Visualizer::pointXYZRGB8> *point_cloud){
+    point_cloud_rgb8_ = point_cloud;
+    if(type_ != POINT_XYZRGB8){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_raw_ = nullptr;
+      point_cloud_xyz_ = nullptr;
+      point_cloud_xyzi_ = nullptr;
+      point_cloud_rgb_ = nullptr;
+      point_cloud_rgba_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      color_mode_ = Visualizer::NONE;
+      type_ = POINT_XYZRGB8;
+      color_size_ = 0;
+      type_size_ = sizeof(Visualizer::pointXYZRGB8);
+      restart();
+    }
+    buffered_ = false;
+    data_size_ = 0;
+  }
+
+  void PointCloud::change_input(const std::vector<unsigned char> *point_cloud){
+    change_input(point_cloud, layout_);
+  }
+
+  void PointCloud::change_input(const std::vector<unsigned char> *point_cloud,
+                                const Visualizer::PointLayout layout){
+    point_cloud_raw_ = point_cloud;
+    const bool reshaped{type_ != POINT_LAYOUT || file_ || !same_layout(layout_, layout)};
+    if(type_ != POINT_LAYOUT || file_){
+      if(file_) delete file_;
+      file_ = nullptr;
+      point_cloud_xyz_ = nullptr;
+      point_cloud_xyzi_ = nullptr;
+      point_cloud_rgb_ = nullptr;
+      point_cloud_rgba_ = nullptr;
+      point_cloud_q16_ = nullptr;
+      point_cloud_rgb8_ = nullptr;
+      color_palette_[0] = algebraica::vec3f(0.2, 0.5, 0.7); //grayish blue
+      color_palette_[1] = algebraica::vec3f(0, 1, 0);       //green
+      color_palette_[2] = algebraica::vec3f(1, 1, 0);       //yellow
+      color_palette_[3] = algebraica::vec3f(1, 0, 0);       //red
+      type_ = POINT_LAYOUT;
+      color_size_ = 4;
+      update_colormap();
+    }
+    layout_ = layout;
+    type_size_ = layout.stride;
+    if(reshaped) restart();
+    buffered_ = false;
+    data_size_ = 0;
+  }
+
+  void PointCloud::set_quantization(const algebraica::vec3f scale, const algebraica::vec3f offset){
+    quantization_scale_ = scale;
+    quantization_offset_ = offset;
   }
 
   void PointCloud::set_colormap(const algebraica::vec3f *colors, const unsigned int quantity){
-    color_size_ = (quantity > 10)? 9 : quantity - 1;
+    // the maximum readable size is 10 colors
+    color_size_ = std::min(quantity, 10u);
 
     for(uint i = 0; i < 10; i++)
       if(i < quantity)
         color_palette_[i] = algebraica::vec3f(*(colors + i)) / 255.0f;
       else
         color_palette_[i] = algebraica::vec3f();
+
+    update_colormap();
   }
 
   void PointCloud::set_color_mode(const Visualizer::ColorMode color_mode){
     color_mode_ = color_mode;
   }
 
+  void PointCloud::set_shader_variants(Shader *const *variants){
+    variants_ = variants;
+  }
+
   void PointCloud::set_transformation_matrix(const algebraica::mat4f *transformation_matrix){
     primary_model_ = transformation_matrix;
   }
@@ -196,116 +536,630 @@ namespace Toreo {
 
   void PointCloud::translate(const float x, const float y, const float z){
     secondary_model_.translate(x, y, z);
+    processed_ = false;
   }
 
   void PointCloud::translate(const algebraica::vec3f translation){
     secondary_model_.translate(translation.x, translation.y, translation.z);
+    processed_ = false;
   }
 
   void PointCloud::rotate(const float pitch, const float yaw, const float roll){
     secondary_model_.rotate(pitch, yaw, roll);
+    processed_ = false;
   }
 
   void PointCloud::rotate(const algebraica::vec3f rotation){
     secondary_model_.rotate(rotation.x, rotation.y, rotation.z);
+    processed_ = false;
   }
 
   void PointCloud::rotate_in_x(const float angle){
     secondary_model_.rotate_x(angle);
+    processed_ = false;
   }
 
   void PointCloud::rotate_in_y(const float angle){
     secondary_model_.rotate_y(angle);
+    processed_ = false;
   }
 
   void PointCloud::rotate_in_z(const float angle){
     secondary_model_.rotate_z(angle);
+    processed_ = false;
   }
 
   bool PointCloud::update(){
     bool no_error{shader_->use()};
 
     if(no_error){
+      // the points reduced since the last update are drawn while the new input is reduced
+      if(is_filtered_) upload_filtered();
       buffer_.vertex_bind();
-      switch(type_){
-      case POINT_XYZ:
-        data_size_ = point_cloud_xyz_->size();
-        buffer_.allocate_array(point_cloud_xyz_->data(),
-                               data_size_ * type_size_, GL_DYNAMIC_DRAW);
-        buffer_.enable(i_position_);
-        buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
-        break;
-      case POINT_XYZRGB:
-        data_size_ = point_cloud_rgb_->size();
-        buffer_.allocate_array(point_cloud_rgb_->data(),
-                               data_size_ * type_size_, GL_DYNAMIC_DRAW);
-        buffer_.enable(i_position_);
-        buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
-        buffer_.enable(i_color_);
-        buffer_.attributte_buffer(i_color_, _3D, offset_, type_size_);
-        buffer_.enable(i_alpha_);
-        break;
-      case POINT_XYZRGBA:
-        data_size_ = point_cloud_rgba_->size();
-        buffer_.allocate_array(point_cloud_rgba_->data(),
-                               data_size_ * type_size_, GL_DYNAMIC_DRAW);
-        buffer_.enable(i_position_);
-        buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
-        buffer_.enable(i_color_);
-        buffer_.attributte_buffer(i_color_, _3D, offset_, type_size_);
-        buffer_.enable(i_alpha_);
-        buffer_.attributte_buffer(i_alpha_, _1D, offset_x2_, type_size_);
-        break;
-      default:
-        data_size_ = point_cloud_xyzi_->size();
-        buffer_.allocate_array(point_cloud_xyzi_->data(),
-                               data_size_ * type_size_, GL_DYNAMIC_DRAW);
-        buffer_.enable(i_position_);
-        buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
-        buffer_.enable(i_intensity_);
-        buffer_.attributte_buffer(i_intensity_, _1D, offset_, type_size_);
-        break;
+
+      // the file does not change, it is uploaded only once
+      if(file_){
+        if(!file_uploaded_) upload_file();
+        buffer_.vertex_release();
+        return no_error;
       }
+
+      GLsizei size;
+      const GLvoid *data{input(&size)};
+
+      // the index is created again from the whole input by the next query
+      if(index_) index_outdated_ = true;
+      // positions must be floats, the points are reduced by a worker thread and draw()
+      // uploads them when they are ready, the last uploaded points are drawn meanwhile
+      if(downsampling_ != Visualizer::NO_DOWNSAMPLING && float_positions() && size > 0)
+        downsample(data, size);
+      else
+        upload(data, size);
       buffer_.vertex_release();
     }
     return no_error;
   }
 
-  bool PointCloud::draw(){
+  void PointCloud::upload(const GLvoid *data, const GLsizei points){
+    data_size_ = points;
+    const GLsizeiptr size{static_cast<GLsizeiptr>(data_size_) * type_size_};
+    buffered_ = false;
+    processed_ = false;
+
+    if(!scans_.empty()){
+      // the oldest scan is replaced by the new one
+      newest_scan_ = (newest_scan_ + 1u) % scans_.size();
+      Scan &scan = scans_[newest_scan_];
+      if(!scan.buffer) scan.buffer = new Buffer(true);
+
+      scan.buffer->vertex_bind();
+      scan.buffer->allocate_array(data, size, GL_DYNAMIC_DRAW);
+      set_attributes();
+      scan.buffer->vertex_release();
+
+      scan.size = data_size_;
+      scan.pose = scan_pose_;
+      if(scan_timestamp_ >= 0.0)
+        scan.timestamp = scan_timestamp_;
+      else
+        scan.timestamp = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+      scan_timestamp_ = -1.0;
+    }else if(is_streaming_){
+      // the storage grows 50% over the needed size to avoid reallocating it every time
+      // the number of points changes a little; the regions and their fences are kept
+      // while the inputs have the same type (see restart())
+      if(!stream_.is_created() || stream_.region_size() < size){
+        stream_.reserve((data_size_ + data_size_ / 2 + 1) * type_size_);
+        set_attributes();
+      }
+      region_ = stream_.next_region();
+      stream_.write(region_, data, size);
+      first_ = stream_.offset(region_) / type_size_;
+    }else if(batch_handle_ >= 0){
+      batch_->upload(batch_handle_, data, data_size_);
+    }else{
+      // the storage grows 50% over the needed size, update_range() and append() write
+      // into it without reallocating; it shrinks when less than a quarter is used
+      if(size > capacity_ || size < capacity_ / 4){
+        capacity_ = size + size / 2 + type_size_;
+        buffer_.allocate_array(nullptr, capacity_, GL_DYNAMIC_DRAW);
+      }
+      buffer_.update_array(data, 0, size);
+      set_attributes();
+      first_ = 0;
+      buffered_ = true;
+    }
+  }
+
+  void PointCloud::downsample(const GLvoid *data, const GLsizei points){
+    // the input could change while the worker filters it
+    const unsigned char *begin{static_cast<const unsigned char*>(data)};
+    boost::shared_ptr<std::vector<unsigned char> > copy(
+      new std::vector<unsigned char>(begin, begin + static_cast<std::size_t>(points) * type_size_));
+
+    if(!filter_worker_) filter_worker_ = new WorkerPool(1u);
+    // only the newest input is filtered
+    filter_worker_->clear();
+    filter_worker_->post(boost::bind(&PointCloud::filter, this, copy, type_size_,
+                                     (type_ == POINT_LAYOUT)? layout_.position.offset : 0u,
+                                     downsampling_, downsampling_value_));
+  }
+
+  void PointCloud::filter(const boost::shared_ptr<std::vector<unsigned char> > points,
+                          const GLsizei stride, const GLuint position,
+                          const Visualizer::Downsampling downsampling, const float value){
+    std::vector<unsigned char> filtered;
+    const std::size_t count{points->size() / stride};
+    if(downsampling == Visualizer::VOXEL_GRID)
+      voxel_grid_.filter(points->data(), count, stride, &filtered, position);
+    else
+      voxel_grid_.random_subset(points->data(), count, stride, value, &filtered);
+
+    {
+      boost::lock_guard<boost::mutex> lock(filtered_mutex_);
+      filtered_.swap(filtered);
+      filtered_stride_ = stride;
+      is_filtered_ = true;
+    }
+    if(notifier_) notifier_();
+  }
+
+  void PointCloud::upload_filtered(){
+    {
+      boost::lock_guard<boost::mutex> lock(filtered_mutex_);
+      downsampled_.swap(filtered_);
+      is_filtered_ = false;
+      // the type of the points changed while they were filtered
+      if(filtered_stride_ != type_size_) return;
+    }
+
+    buffer_.vertex_bind();
+    upload(downsampled_.data(), downsampled_.size() / type_size_);
+    buffer_.vertex_release();
+  }
+
+  bool PointCloud::update_range(const std::size_t first, const std::size_t count){
+    // only a whole copy of the input in buffer_ can be written partially
+    if(!buffered_ || file_ || is_streaming_ || !scans_.empty() || batch_handle_ >= 0 ||
+       downsampling_ != Visualizer::NO_DOWNSAMPLING)
+      return update();
+
     bool no_error{shader_->use()};
 
+    if(no_error){
+      GLsizei size;
+      const unsigned char *data{static_cast<const unsigned char*>(input(&size))};
+      // the input grew over the storage, it is reallocated with space to grow
+      if(static_cast<GLsizeiptr>(size) * type_size_ > capacity_) return update();
+
+      if(first < static_cast<std::size_t>(size)){
+        const std::size_t points{std::min<std::size_t>(count, size - first)};
+        buffer_.update_array(data + first * type_size_,
+                             static_cast<GLintptr>(first) * type_size_,
+                             static_cast<GLsizeiptr>(points) * type_size_);
+      }
+      // removed points at the end are not drawn anymore
+      data_size_ = size;
+      processed_ = false;
+
+      if(index_) index_outdated_ = true;
+    }
+    return no_error;
+  }
+
+  bool PointCloud::append(){
+    return update_range(static_cast<std::size_t>(data_size_),
+                        std::numeric_limits<std::size_t>::max());
+  }
+
+  bool PointCloud::draw(){
+    // the cloud is not always updated again (see downsample())
+    if(is_filtered_) upload_filtered();
+    // the points processed by the GPU replace the uploaded ones, they are processed again
+    // after every update or transformation
+    bool processing{processor_ != nullptr && buffered_ && scans_.empty()};
+    if(processing && !processed_){
+      processing = processed_ = process();
+      // it would fail again every frame: the processing stays disabled until set_processing()
+      if(!processing){
+        std::cout << "The point cloud could not be processed by the GPU (its fields are not "
+                     "floats or the compute program failed), the processing was disabled."
+                  << std::endl;
+        delete processor_;
+        processor_ = nullptr;
+      }
+    }
+    // the colors computed by the GPU are drawn as RGB(A)
+    const Visualizer::ColorMode color_mode{(processing && processor_->is_coloring())?
+                                             Visualizer::NONE : color_mode_};
+
+    // the program specialized for the color mode, the uniforms are located again only
+    // when the mode changes
+    Shader *program{shader_};
+    if(variants_ && color_mode <= Visualizer::NONE && variants_[color_mode] &&
+       variants_[color_mode]->is_created())
+      program = variants_[color_mode];
+    if(program != program_){
+      program_ = program;
+      locate_uniforms();
+    }
+
+    if(batch_handle_ >= 0 && scans_.empty() && !is_streaming_){
+      batch_->queue(batch_handle_,
+                    (primary_model_ ? *primary_model_ : identity_matrix_) * secondary_model_,
+                    color_mode_, maximum_intensity_value_, type_ == POINT_XYZRGBA, point_size_);
+      return true;
+    }
+
+    bool no_error{program_->use()};
+
     if(no_error){
       buffer_.vertex_bind();
 
       if(primary_model_)
-        shader_->set_value(u_primary_model_, *primary_model_);
+        program_->set_value(u_primary_model_, *primary_model_);
       else
-        shader_->set_value(u_primary_model_, identity_matrix_);
-
-      shader_->set_value(u_secondary_model_, secondary_model_);
-      shader_->set_value(u_color_mode_, static_cast<float>(color_mode_));
-      shader_->set_value(u_intensity_range_, maximum_intensity_value_);
-
-      if(type_ == POINT_XYZ){
-        shader_->set_values(u_palette_, &color_palette_[0], color_size_);
-        shader_->set_value(u_color_size_, static_cast<float>(color_size_));
-      }else if(type_ == POINT_XYZI){
-        shader_->set_values(u_palette_, &color_palette_[0], color_size_);
-        shader_->set_value(u_color_size_, static_cast<float>(color_size_));
-      }else if(type_ == POINT_XYZRGB)
-        shader_->set_value(u_has_alpha_, false);
-      else if(type_ == POINT_XYZRGBA)
-        shader_->set_value(u_has_alpha_, true);
+        program_->set_value(u_primary_model_, identity_matrix_);
+
+      program_->set_value(u_secondary_model_, secondary_model_);
+      program_->set_value(u_intensity_range_, maximum_intensity_value_);
+      // only the program without variants has a color mode uniform
+      if(u_color_mode_ >= 0)
+        program_->set_value(u_color_mode_, static_cast<float>(color_mode));
+
+      if(color_mode == Visualizer::NONE){
+        // every processed point has alpha (1 if the input does not have it)
+        if(processing)
+          program_->set_value(u_has_alpha_, true);
+        else if(type_ == POINT_XYZRGB)
+          program_->set_value(u_has_alpha_, false);
+        else if(type_ == POINT_XYZRGBA || type_ == POINT_XYZRGB8)
+          program_->set_value(u_has_alpha_, true);
+        else if(type_ == POINT_LAYOUT)
+          program_->set_value(u_has_alpha_, layout_.alpha.count > 0u);
+      }else if(color_mode != Visualizer::GRAYSCALE)
+        colormap_.bind();
+
+      if(type_ == POINT_XYZI_Q16 || type_ == POINT_XYZRGB8 || type_ == POINT_LAYOUT){
+        program_->set_value(u_scale_, quantization_scale_);
+        program_->set_value(u_offset_, quantization_offset_);
+      }else{
+        program_->set_value(u_scale_, algebraica::vec3f(1.0f, 1.0f, 1.0f));
+        program_->set_value(u_offset_, algebraica::vec3f());
+      }
 
       glPointSize(point_size_);
-      glDrawArrays(GL_POINTS, 0, data_size_);
+      if(!scans_.empty()){
+        const algebraica::mat4f &primary{primary_model_ ? *primary_model_ : identity_matrix_};
+        const double newest{scans_[newest_scan_].timestamp};
+        program_->set_value(u_fade_time_, fade_time_);
+
+        // from the oldest to the newest scan
+        for(std::size_t i = 1; i <= scans_.size(); ++i){
+          const Scan &scan = scans_[(newest_scan_ + i) % scans_.size()];
+          const float age{static_cast<float>(newest - scan.timestamp)};
+          if(!scan.buffer || scan.size <= 0 || (fade_time_ > 0.0f && age >= fade_time_))
+            continue;
+
+          scan.buffer->vertex_bind();
+          program_->set_value(u_primary_model_, primary * scan.pose);
+          program_->set_value(u_age_, age);
+          glDrawArrays(GL_POINTS, 0, scan.size);
+        }
+        // the shader is shared with clouds without fading
+        program_->set_value(u_fade_time_, 0.0f);
+      }else if(processing)
+        processor_->draw();
+      else
+        glDrawArrays(GL_POINTS, first_, data_size_);
       glPointSize(1.0f);
 
+      if(is_streaming_ && scans_.empty()) stream_.fence(region_);
+
       buffer_.vertex_release();
     }
     return no_error;
   }
 
+  void PointCloud::set_streaming(const bool streaming){
+    // files are uploaded only once into a static buffer
+    if(is_streaming_ == streaming || file_) return;
+
+    is_streaming_ = streaming;
+    stream_.destroy();
+    restart();
+    update();
+  }
+
+  const bool PointCloud::is_streaming(){
+    return is_streaming_;
+  }
+
+  bool PointCloud::file_origin(double *origin){
+    if(!file_) return false;
+    std::copy(file_->origin(), file_->origin() + 3, origin);
+    return true;
+  }
+
+  void PointCloud::set_accumulation(const unsigned int scans, const float fade_time){
+    fade_time_ = fade_time;
+    if(scans == scans_.size()) return;
+
+    clear_scans();
+    scans_.resize(scans);
+    newest_scan_ = 0u;
+  }
+
+  void PointCloud::set_scan_pose(const algebraica::mat4f &pose, const double timestamp){
+    scan_pose_ = pose;
+    scan_timestamp_ = timestamp;
+  }
+
+  void PointCloud::set_batch(PointCloudBatch *batch){
+    if(batch_) batch_->leave(batch_handle_);
+    batch_ = batch;
+    batch_handle_ = (batch_ && !file_)? batch_->join(type_) : -1;
+    update_colormap();
+    update();
+  }
+
+  void PointCloud::set_indexing(const bool indexing){
+    if(indexing == (index_ != nullptr)) return;
+
+    if(indexing){
+      index_ = new PointIndex();
+      index_outdated_ = true;
+    }else{
+      delete index_;
+      index_ = nullptr;
+    }
+  }
+
+  const bool PointCloud::is_indexing(){
+    return index_ != nullptr;
+  }
+
+  bool PointCloud::nearest_point(const algebraica::mat4f &pv, const float x, const float y,
+                                 const float radius, std::uint32_t *index,
+                                 algebraica::vec3f *position, float *depth){
+    if(!index_) return false;
+
+    // same matrices as draw(), the accumulated scans are drawn with their own pose
+    algebraica::mat4f model{primary_model_ ? *primary_model_ : identity_matrix_};
+    if(!scans_.empty()) model = model * scans_[newest_scan_].pose;
+    const algebraica::mat4f mvp{pv * model * secondary_model_};
+
+    update_index();
+    float point[3];
+    if(!index_->nearest(mvp.data(), x, y, radius, index, point, depth)) return false;
+    if(position) *position = algebraica::vec3f(point[0], point[1], point[2]);
+    return true;
+  }
+
+  std::size_t PointCloud::points_in_radius(const algebraica::vec3f &center, const float radius,
+                                           std::vector<std::uint32_t> *indices){
+    if(!index_){
+      indices->clear();
+      return 0u;
+    }
+    update_index();
+    const float point[3]{center.x, center.y, center.z};
+    return index_->in_radius(point, radius, indices);
+  }
+
+  std::size_t PointCloud::points_in_box(const algebraica::vec3f &minimum,
+                                        const algebraica::vec3f &maximum,
+                                        std::vector<std::uint32_t> *indices){
+    if(!index_){
+      indices->clear();
+      return 0u;
+    }
+    const float lower[3]{minimum.x, minimum.y, minimum.z};
+    const float upper[3]{maximum.x, maximum.y, maximum.z};
+    update_index();
+    return index_->in_box(lower, upper, indices);
+  }
+
+  bool PointCloud::set_processing(Shader *compute_program,
+                                  const Visualizer::PointProcessing *processing){
+    if(!processing){
+      if(processor_) delete processor_;
+      processor_ = nullptr;
+      return true;
+    }
+    if(!PointProcessor::is_supported() || !compute_program || !compute_program->is_created() ||
+       file_)
+      return false;
+
+    if(!processor_)
+      processor_ = new PointProcessor(compute_program, i_position_, i_intensity_, i_color_,
+                                      i_alpha_);
+    processor_->set_processing(*processing);
+    processed_ = false;
+    return true;
+  }
+
+  void PointCloud::set_downsampling(const Visualizer::Downsampling downsampling,
+                                    const float value){
+    // the running filter uses voxel_grid_
+    if(filter_worker_) filter_worker_->wait();
+
+    downsampling_ = downsampling;
+    downsampling_value_ = value;
+    if(downsampling_ == Visualizer::VOXEL_GRID)
+      voxel_grid_.set_leaf_size(value);
+    // frees the memory of the last filtered cloud
+    if(downsampling_ == Visualizer::NO_DOWNSAMPLING){
+      std::vector<unsigned char>().swap(downsampled_);
+      boost::lock_guard<boost::mutex> lock(filtered_mutex_);
+      std::vector<unsigned char>().swap(filtered_);
+      is_filtered_ = false;
+    }
+  }
+
+  void PointCloud::set_notifier(const boost::function<void ()> &notifier){
+    notifier_ = notifier;
+  }
+
+  void PointCloud::set_attributes(){
+    switch(type_){
+    case POINT_XYZ:
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
+      break;
+    case POINT_XYZRGB:
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
+      buffer_.enable(i_color_);
+      buffer_.attributte_buffer(i_color_, _3D, offset_, type_size_);
+      buffer_.enable(i_alpha_);
+      break;
+    case POINT_XYZRGBA:
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
+      buffer_.enable(i_color_);
+      buffer_.attributte_buffer(i_color_, _3D, offset_, type_size_);
+      buffer_.enable(i_alpha_);
+      buffer_.attributte_buffer(i_alpha_, _1D, offset_x2_, type_size_);
+      break;
+    case POINT_XYZI_Q16:
+      // normalized positions: -32767 -> 32767 becomes -1.0 -> 1.0 (see u_scale)
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_, GL_SHORT, GL_TRUE);
+      buffer_.enable(i_intensity_);
+      buffer_.attributte_buffer(i_intensity_, _1D, 3 * sizeof(short), type_size_,
+                                GL_UNSIGNED_BYTE);
+      break;
+    case POINT_XYZRGB8:
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_, GL_SHORT, GL_TRUE);
+      // normalized colors: 0 -> 255 becomes 0.0 -> 1.0
+      buffer_.enable(i_color_);
+      buffer_.attributte_buffer(i_color_, _3D, 4 * sizeof(short), type_size_,
+                                GL_UNSIGNED_BYTE, GL_TRUE);
+      buffer_.enable(i_alpha_);
+      buffer_.attributte_buffer(i_alpha_, _1D, 4 * sizeof(short) + 3, type_size_,
+                                GL_UNSIGNED_BYTE, GL_TRUE);
+      break;
+    case POINT_LAYOUT:{
+      const GLint attributes[4] = { i_position_, i_intensity_, i_color_, i_alpha_ };
+      const Visualizer::PointField *fields[4] = { &layout_.position, &layout_.intensity,
+                                                  &layout_.color, &layout_.alpha };
+      for(int i = 0; i < 4; ++i)
+        if(fields[i]->count > 0u){
+          buffer_.enable(attributes[i]);
+          buffer_.attributte_buffer(attributes[i], fields[i]->count, fields[i]->offset,
+                                    type_size_, fields[i]->type,
+                                    fields[i]->normalized ? GL_TRUE : GL_FALSE);
+        }
+      break;
+    }
+    default:
+      buffer_.enable(i_position_);
+      buffer_.attributte_buffer(i_position_, _3D, 0, type_size_);
+      buffer_.enable(i_intensity_);
+      buffer_.attributte_buffer(i_intensity_, _1D, offset_, type_size_);
+      break;
+    }
+  }
+
+  bool PointCloud::process(){
+    // offsets in bytes of the float fields, negative if the point does not have them
+    GLint position{0}, intensity{-1}, color{-1}, alpha{-1};
+    switch(type_){
+    case POINT_XYZ:
+      break;
+    case POINT_XYZI:
+      intensity = offset_;
+      break;
+    case POINT_XYZRGB:
+      color = offset_;
+      break;
+    case POINT_XYZRGBA:
+      color = offset_;
+      alpha = offset_x2_;
+      break;
+    case POINT_LAYOUT:{
+      // the shader reads the points as an array of floats
+      const Visualizer::PointField *fields[4] = { &layout_.position, &layout_.intensity,
+                                                  &layout_.color, &layout_.alpha };
+      GLint *offsets[4] = { &position, &intensity, &color, &alpha };
+      if(layout_.stride % sizeof(float) != 0u) return false;
+      for(int i = 0; i < 4; ++i)
+        if(fields[i]->count > 0u){
+          if(fields[i]->type != GL_FLOAT || fields[i]->offset % sizeof(float) != 0u)
+            return false;
+          *offsets[i] = static_cast<GLint>(fields[i]->offset);
+        }
+      break;
+    }
+    default:
+      // quantized points
+      return false;
+    }
+
+    return processor_->process(buffer_.array_id(), data_size_, type_size_, position, intensity,
+                               color, alpha, secondary_model_, colormap_);
+  }
+
+  const bool PointCloud::float_positions(){
+    return type_ <= POINT_XYZRGBA ||
+           (type_ == POINT_LAYOUT && layout_.position.type == GL_FLOAT);
+  }
+
+  const GLvoid *PointCloud::input(GLsizei *size){
+    const GLvoid *data{nullptr};
+    switch(type_){
+    case POINT_XYZ:
+      *size = point_cloud_xyz_->size();
+      data = point_cloud_xyz_->data();
+      break;
+    case POINT_XYZRGB:
+      *size = point_cloud_rgb_->size();
+      data = point_cloud_rgb_->data();
+      break;
+    case POINT_XYZRGBA:
+      *size = point_cloud_rgba_->size();
+      data = point_cloud_rgba_->data();
+      break;
+    case POINT_XYZI_Q16:
+      *size = point_cloud_q16_->size();
+      data = point_cloud_q16_->data();
+      break;
+    case POINT_XYZRGB8:
+      *size = point_cloud_rgb8_->size();
+      data = point_cloud_rgb8_->data();
+      break;
+    case POINT_LAYOUT:
+      *size = (type_size_ > 0)? point_cloud_raw_->size() / type_size_ : 0;
+      data = point_cloud_raw_->data();
+      break;
+    default:
+      *size = point_cloud_xyzi_->size();
+      data = point_cloud_xyzi_->data();
+      break;
+    }
+    return data;
+  }
+
+  void PointCloud::upload_file(){
+    // uploads the file in blocks directly from the mapped pages, only one block is mapped
+    // at a time (files bigger than the memory can be loaded)
+    const std::uint64_t total{file_->is_loaded() ? file_->size() : 0u};
+    const std::uint64_t block{std::max<std::uint64_t>(POINT_FILE_BLOCK / type_size_, 1u)};
+
+    data_size_ = static_cast<GLsizei>(total);
+    buffer_.allocate_array(nullptr, static_cast<GLsizeiptr>(total) * type_size_, GL_STATIC_DRAW);
+
+    for(std::uint64_t first = 0u; first < total; first += block){
+      const std::uint64_t count{std::min(block, total - first)};
+      const unsigned char *points{file_->map(first, count)};
+      if(!points){
+        data_size_ = static_cast<GLsizei>(first);
+        break;
+      }
+      glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(first) * type_size_,
+                      static_cast<GLsizeiptr>(count) * type_size_, points);
+    }
+    file_->unmap();
+
+    set_attributes();
+    first_ = 0;
+    file_uploaded_ = true;
+  }
+
+  void PointCloud::update_index(){
+    // the positions are copied once per change of the input, not in every update
+    if(index_outdated_.exchange(false) && float_positions()){
+      GLsizei size;
+      const GLvoid *data{input(&size)};
+      index_->build(data, size, type_size_,
+                    (type_ == POINT_LAYOUT)? layout_.position.offset : 0u);
+    }
+    index_->wait();
+  }
+
   void PointCloud::initialize(){
     shader_->use();
     // GLSL attribute locations
@@ -313,18 +1167,33 @@ namespace Toreo {
     i_intensity_        = shader_->attribute_location("i_intensity");
     i_color_            = shader_->attribute_location("i_color");
     i_alpha_            = shader_->attribute_location("i_alpha");
-    // GLSL uniform locations
-    u_primary_model_    = shader_->uniform_location("u_primary_model");
-    u_secondary_model_  = shader_->uniform_location("u_secondary_model");
-    u_palette_          = shader_->uniform_location("u_palette");
-    u_color_size_       = shader_->uniform_location("u_color_size");
-    u_color_mode_       = shader_->uniform_location("u_color_mode");
-    u_intensity_range_  = shader_->uniform_location("u_intensity_range");
-    u_has_alpha_        = shader_->uniform_location("u_has_alpha");
+    // the attributes have fixed locations, they are the same in all the variants
+    program_ = shader_;
+    locate_uniforms();
+    update_colormap();
 
     update();
   }
 
+  void PointCloud::locate_uniforms(){
+    // GLSL uniform locations
+    u_primary_model_    = program_->uniform_location("u_primary_model");
+    u_secondary_model_  = program_->uniform_location("u_secondary_model");
+    u_color_mode_       = program_->uniform_location("u_color_mode");
+    u_intensity_range_  = program_->uniform_location("u_intensity_range");
+    u_has_alpha_        = program_->uniform_location("u_has_alpha");
+    u_scale_            = program_->uniform_location("u_scale");
+    u_offset_           = program_->uniform_location("u_offset");
+    u_age_              = program_->uniform_location("u_age");
+    u_fade_time_        = program_->uniform_location("u_fade_time");
+  }
+
+  void PointCloud::update_colormap(){
+    colormap_.set(color_palette_, color_size_);
+    if(batch_handle_ >= 0)
+      batch_->set_colormap(batch_handle_, color_palette_, color_size_);
+  }
+
   void PointCloud::restart(){
     shader_->use();
     buffer_.vertex_bind();
@@ -333,5 +1202,22 @@ namespace Toreo {
     buffer_.disable(i_intensity_);
     buffer_.disable(i_alpha_);
     buffer_.vertex_release();
+    // the regions and scans are measured in points of the old type
+    stream_.destroy();
+    buffered_ = false;
+    clear_scans();
+    // the points of the new type go into another arena
+    if(batch_ && batch_->type(batch_handle_) != type_){
+      batch_->leave(batch_handle_);
+      batch_handle_ = batch_->join(type_);
+      update_colormap();
+    }
+  }
+
+  void PointCloud::clear_scans(){
+    for(Scan &scan : scans_){
+      if(scan.buffer) delete scan.buffer;
+      scan = Scan();
+    }
   }
 }
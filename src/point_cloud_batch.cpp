@@ -0,0 +1,341 @@
+#include "include/point_cloud_batch.h"
+
+#include <algorithm>
+
+namespace Toreo {
+  namespace {
+    // texture buffer floats per cloud: 6 RGBA texels
+    const std::size_t cloud_floats = 24u;
+    // minimum size of an arena in points
+    const GLsizei minimum_arena = 4096;
+  }
+
+  PointCloudBatch::PointCloudBatch(Shader *shader_program) :
+    shader_(shader_program),
+    arenas_(0),
+    members_(0),
+    commands_(0),
+    clouds_(0),
+    indirect_(0),
+    cloud_buffer_(0),
+    cloud_texture_(0),
+    index_buffer_(0),
+    indirect_buffer_(0),
+    cloud_capacity_(0u),
+    colormaps_(0),
+    rows_(0u),
+    palettes_(0)
+  {
+    glGenBuffers(1, &cloud_buffer_);
+    glGenBuffers(1, &index_buffer_);
+    glGenBuffers(1, &indirect_buffer_);
+    glGenTextures(1, &cloud_texture_);
+    glGenTextures(1, &colormaps_);
+
+    reserve_clouds(64u);
+    reserve_rows(16u);
+  }
+
+  PointCloudBatch::~PointCloudBatch(){
+    for(Arena &arena : arenas_){
+      GLState::delete_vertex_arrays(1, &arena.vertex_array);
+      glDeleteBuffers(1, &arena.buffer);
+    }
+    glDeleteBuffers(1, &cloud_buffer_);
+    glDeleteBuffers(1, &index_buffer_);
+    glDeleteBuffers(1, &indirect_buffer_);
+    GLState::delete_textures(1, &cloud_texture_);
+    GLState::delete_textures(1, &colormaps_);
+  }
+
+  int PointCloudBatch::join(const unsigned int type){
+    const int index{arena(type)};
+    if(index < 0) return -1;
+
+    int handle{0};
+    while(handle < static_cast<int>(members_.size()) && members_[handle].arena >= 0)
+      ++handle;
+    if(handle == static_cast<int>(members_.size()))
+      members_.push_back(Member());
+
+    members_[handle].arena = index;
+    reserve_rows(members_.size());
+    set_colormap(handle, nullptr, 0u);
+    return handle;
+  }
+
+  void PointCloudBatch::leave(const int handle){
+    // its range is reused when the arena grows
+    if(handle >= 0 && handle < static_cast<int>(members_.size()))
+      members_[handle] = Member();
+  }
+
+  unsigned int PointCloudBatch::type(const int handle){
+    if(handle < 0 || handle >= static_cast<int>(members_.size()) || members_[handle].arena < 0)
+      return POINT_LAYOUT;
+    return arenas_[members_[handle].arena].type;
+  }
+
+  void PointCloudBatch::upload(const int handle, const void *points, const GLsizei size){
+    if(handle < 0 || handle >= static_cast<int>(members_.size()) || members_[handle].arena < 0)
+      return;
+
+    Member &member = members_[handle];
+    Arena &arena = arenas_[member.arena];
+
+    if(size > member.capacity){
+      // the old range is left behind, it is removed when the arena grows
+      const GLsizei capacity{size + size / 2 + 1};
+      member.capacity = member.size = 0;
+      if(arena.used + capacity > arena.capacity) grow(arena, capacity);
+
+      member.first = arena.used;
+      member.capacity = capacity;
+      arena.used += capacity;
+    }
+
+    member.size = size;
+    if(size > 0){
+      glBindBuffer(GL_ARRAY_BUFFER, arena.buffer);
+      glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(member.first) * arena.stride,
+                      static_cast<GLsizeiptr>(size) * arena.stride, points);
+    }
+  }
+
+  void PointCloudBatch::set_colormap(const int handle, const algebraica::vec3f *colors,
+                                     const unsigned int quantity){
+    if(handle < 0 || handle >= static_cast<int>(members_.size())) return;
+
+    unsigned char *row{&palettes_[handle * Colormap::size_ * 4]};
+    Colormap::bake(colors, quantity, row);
+
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_2D, colormaps_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, handle, Colormap::size_, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                    row);
+  }
+
+  void PointCloudBatch::queue(const int handle, const algebraica::mat4f &model,
+                              const Visualizer::ColorMode color_mode,
+                              const float maximum_intensity_value, const bool has_alpha,
+                              const float point_size){
+    if(handle < 0 || handle >= static_cast<int>(members_.size())) return;
+
+    const Member &member = members_[handle];
+    if(member.arena < 0 || member.size <= 0) return;
+
+    const GLuint cloud{static_cast<GLuint>(clouds_.size() / cloud_floats)};
+    const float *matrix{model.data()};
+    clouds_.insert(clouds_.end(), matrix, matrix + 16);
+    clouds_.push_back(static_cast<float>(color_mode));
+    clouds_.push_back(maximum_intensity_value);
+    clouds_.push_back(has_alpha ? 1.0f : 0.0f);
+    clouds_.push_back(point_size);
+    clouds_.push_back(static_cast<float>(handle));
+    clouds_.insert(clouds_.end(), 3, 0.0f);
+
+    const Command command = { static_cast<GLuint>(member.size), 1u,
+                              static_cast<GLuint>(member.first), cloud };
+    commands_[member.arena].push_back(command);
+  }
+
+  bool PointCloudBatch::draw(){
+    const std::size_t clouds{clouds_.size() / cloud_floats};
+    if(clouds == 0u) return true;
+
+    bool no_error{shader_->use()};
+
+    if(no_error){
+      reserve_clouds(clouds);
+      glBindBuffer(GL_TEXTURE_BUFFER, cloud_buffer_);
+      glBufferSubData(GL_TEXTURE_BUFFER, 0, clouds_.size() * sizeof(float), clouds_.data());
+
+      if(GLExtensions::multi_draw_arrays_indirect){
+        // the commands of every arena one after another
+        indirect_.clear();
+        for(const std::vector<Command> &commands : commands_)
+          indirect_.insert(indirect_.end(), commands.begin(), commands.end());
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, indirect_.size() * sizeof(Command),
+                        indirect_.data());
+      }
+
+      // texture units defined by the bindings in point_cloud_batch.vert
+      GLState::active_texture(GL_TEXTURE1);
+      GLState::bind_texture(GL_TEXTURE_BUFFER, cloud_texture_);
+      GLState::active_texture(GL_TEXTURE0);
+      GLState::bind_texture(GL_TEXTURE_2D, colormaps_);
+      // the point size of every cloud is written by the shader
+      GLState::enable(GL_PROGRAM_POINT_SIZE);
+
+      std::size_t first{0u};
+      for(std::size_t i = 0; i < arenas_.size(); ++i){
+        const std::vector<Command> &commands = commands_[i];
+        if(commands.empty()) continue;
+
+        GLState::bind_vertex_array(arenas_[i].vertex_array);
+        if(GLExtensions::multi_draw_arrays_indirect)
+          GLExtensions::multi_draw_arrays_indirect(GL_POINTS,
+                                                   reinterpret_cast<const void*>(
+                                                     first * sizeof(Command)),
+                                                   static_cast<GLsizei>(commands.size()), 0);
+        else
+          for(const Command &command : commands)
+            glDrawArraysInstancedBaseInstance(GL_POINTS, command.first, command.count,
+                                              command.instance_count, command.base_instance);
+        first += commands.size();
+      }
+    }
+
+    clouds_.clear();
+    for(std::vector<Command> &commands : commands_)
+      commands.clear();
+    return no_error;
+  }
+
+  int PointCloudBatch::arena(const unsigned int type){
+    for(std::size_t i = 0; i < arenas_.size(); ++i)
+      if(arenas_[i].type == type) return static_cast<int>(i);
+
+    GLsizei stride{0};
+    switch(type){
+    case POINT_XYZ:
+      stride = sizeof(Visualizer::pointXYZ);
+      break;
+    case POINT_XYZI:
+      stride = sizeof(Visualizer::pointXYZI);
+      break;
+    case POINT_XYZRGB:
+      stride = sizeof(Visualizer::pointXYZRGB);
+      break;
+    case POINT_XYZRGBA:
+      stride = sizeof(Visualizer::pointXYZRGBA);
+      break;
+    default:
+      // quantized and layout clouds need their own decoding
+      return -1;
+    }
+
+    Arena arena;
+    arena.type = type;
+    arena.stride = stride;
+    glGenVertexArrays(1, &arena.vertex_array);
+    arenas_.push_back(arena);
+    commands_.resize(arenas_.size());
+
+    grow(arenas_.back(), minimum_arena);
+    return static_cast<int>(arenas_.size() - 1);
+  }
+
+  void PointCloudBatch::grow(Arena &arena, const GLsizei extra){
+    const int index{static_cast<int>(&arena - arenas_.data())};
+
+    GLsizei live{0};
+    for(const Member &member : members_)
+      if(member.arena == index) live += member.capacity;
+    const GLsizei capacity{std::max(std::max(arena.capacity * 2, live + extra), minimum_arena)};
+
+    GLuint buffer{0};
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity) * arena.stride,
+                 nullptr, GL_DYNAMIC_DRAW);
+
+    // the ranges in use are packed at the beginning of the new buffer
+    GLsizei used{0};
+    if(arena.buffer){
+      glBindBuffer(GL_COPY_READ_BUFFER, arena.buffer);
+      for(Member &member : members_)
+        if(member.arena == index && member.capacity > 0){
+          if(member.size > 0)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(member.first) * arena.stride,
+                                static_cast<GLintptr>(used) * arena.stride,
+                                static_cast<GLsizeiptr>(member.size) * arena.stride);
+          member.first = used;
+          used += member.capacity;
+        }
+      glDeleteBuffers(1, &arena.buffer);
+    }
+
+    arena.buffer = buffer;
+    arena.capacity = capacity;
+    arena.used = used;
+    set_attributes(arena);
+  }
+
+  void PointCloudBatch::set_attributes(Arena &arena){
+    const GLsizei position_size{sizeof(algebraica::vec3f)};
+
+    GLState::bind_vertex_array(arena.vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.buffer);
+    // same locations as point_cloud.vert
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, arena.stride, nullptr);
+
+    switch(arena.type){
+    case POINT_XYZI:
+      glEnableVertexAttribArray(1);
+      glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, arena.stride,
+                            reinterpret_cast<const GLvoid*>(position_size));
+      break;
+    case POINT_XYZRGBA:
+      glEnableVertexAttribArray(3);
+      glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, arena.stride,
+                            reinterpret_cast<const GLvoid*>(position_size * 2));
+      // the color is at the same place as in POINT_XYZRGB
+    case POINT_XYZRGB:
+      glEnableVertexAttribArray(2);
+      glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, arena.stride,
+                            reinterpret_cast<const GLvoid*>(position_size));
+      break;
+    }
+
+    // one cloud index per instance, the first is the command's baseInstance
+    glBindBuffer(GL_ARRAY_BUFFER, index_buffer_);
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, 0, nullptr);
+    glVertexAttribDivisor(4, 1);
+  }
+
+  void PointCloudBatch::reserve_clouds(const std::size_t clouds){
+    if(clouds <= cloud_capacity_) return;
+    cloud_capacity_ = std::max(clouds, cloud_capacity_ * 2u);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, cloud_buffer_);
+    glBufferData(GL_TEXTURE_BUFFER, cloud_capacity_ * cloud_floats * sizeof(float), nullptr,
+                 GL_STREAM_DRAW);
+    GLState::active_texture(GL_TEXTURE1);
+    GLState::bind_texture(GL_TEXTURE_BUFFER, cloud_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, cloud_buffer_);
+
+    // the vertex arrays keep pointing to the same buffer
+    std::vector<GLuint> indices(cloud_capacity_);
+    for(std::size_t i = 0; i < indices.size(); ++i)
+      indices[i] = static_cast<GLuint>(i);
+    glBindBuffer(GL_ARRAY_BUFFER, index_buffer_);
+    glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(),
+                 GL_STATIC_DRAW);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, cloud_capacity_ * sizeof(Command), nullptr,
+                 GL_STREAM_DRAW);
+  }
+
+  void PointCloudBatch::reserve_rows(const std::size_t rows){
+    if(rows <= rows_) return;
+    rows_ = std::max(rows, rows_ * 2u);
+    // the palettes of the new rows are written when their clouds join
+    palettes_.resize(rows_ * Colormap::size_ * 4u, 255u);
+
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_2D, colormaps_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Colormap::size_, static_cast<GLsizei>(rows_), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, palettes_.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+}
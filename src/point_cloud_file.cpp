@@ -0,0 +1,396 @@
+#include "include/point_cloud_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace Toreo {
+  namespace {
+    const char raw_magic[4] = {'T', 'R', 'A', 'W'};
+    const std::uint32_t raw_version = 1u;
+    // size of the LAS 1.4 public header block (1.0 -> 1.3 use the first 227 bytes)
+    const std::size_t las_header_size = 375u;
+
+    template<typename T>
+    T read_value(const char *data, const std::size_t offset){
+      T value;
+      std::memcpy(&value, data + offset, sizeof(T));
+      return value;
+    }
+
+    // OpenGL type of a PCD field: type = F, I or U and size in bytes
+    GLenum pcd_type(const char type, const unsigned int size){
+      switch(type){
+      case 'F':
+        return (size == 4u)? GL_FLOAT : (size == 8u)? GL_DOUBLE : 0;
+      case 'I':
+        return (size == 1u)? GL_BYTE : (size == 2u)? GL_SHORT : (size == 4u)? GL_INT : 0;
+      case 'U':
+        return (size == 1u)? GL_UNSIGNED_BYTE : (size == 2u)? GL_UNSIGNED_SHORT :
+                                                              (size == 4u)? GL_UNSIGNED_INT : 0;
+      default:
+        return 0;
+      }
+    }
+
+    Visualizer::PointField field(const unsigned int offset, const unsigned int type,
+                                 const unsigned int count, const bool normalized = false){
+      Visualizer::PointField field;
+      field.offset = offset;
+      field.type = type;
+      field.count = count;
+      field.normalized = normalized;
+      return field;
+    }
+  }
+
+  PointCloudFile::PointCloudFile(const std::string path) :
+    path_(path),
+    error_log_(),
+    is_loaded_(false),
+    point_count_(0u),
+    data_offset_(0u),
+    file_size_(0u),
+    layout_(),
+    scale_(1.0f, 1.0f, 1.0f),
+    offset_(),
+    decodes_positions_(false),
+    position_scale_{1.0, 1.0, 1.0},
+    position_offset_{0.0, 0.0, 0.0},
+    origin_{0.0, 0.0, 0.0},
+    block_(),
+    file_(),
+    region_()
+  {
+    std::ifstream file(path_, std::ios::binary | std::ios::ate);
+    if(!file.is_open()){
+      error_log_ = "The file: " + path_ + " was not found.\n";
+      return;
+    }
+    file_size_ = static_cast<std::uint64_t>(file.tellg());
+    file.close();
+
+    std::string extension{path_.substr(std::min(path_.find_last_of('.'), path_.size()))};
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if(extension == ".pcd")
+      is_loaded_ = read_pcd();
+    else if(extension == ".las")
+      is_loaded_ = read_las();
+    else if(extension == ".traw")
+      is_loaded_ = read_raw();
+    else
+      error_log_ = "The format of: " + path_ + " is not supported.\n";
+
+    if(!is_loaded_) return;
+
+    if(layout_.position.count == 0u || layout_.stride == 0u){
+      error_log_ = "The file: " + path_ + " does not have x, y and z fields.\n";
+      is_loaded_ = false;
+    }else if(data_offset_ + point_count_ * layout_.stride > file_size_){
+      error_log_ = "The file: " + path_ + " is incomplete.\n";
+      is_loaded_ = false;
+    }else{
+      try{
+        boost::interprocess::file_mapping mapping(path_.c_str(), boost::interprocess::read_only);
+        file_.swap(mapping);
+      }catch(const boost::interprocess::interprocess_exception &exception){
+        error_log_ = "The file: " + path_ + " could not be mapped: " + exception.what() + "\n";
+        is_loaded_ = false;
+      }
+    }
+  }
+
+  bool PointCloudFile::save(const std::string path, const Visualizer::PointLayout &layout,
+                            const void *points, const std::uint64_t count,
+                            const algebraica::vec3f scale, const algebraica::vec3f offset){
+    if(layout.stride == 0u || (count > 0u && points == nullptr)) return false;
+
+    RawHeader header;
+    std::memcpy(header.magic, raw_magic, sizeof(header.magic));
+    header.version = raw_version;
+    header.point_count = count;
+
+    const Visualizer::PointField *fields[4] = { &layout.position, &layout.intensity,
+                                                &layout.color, &layout.alpha };
+    header.layout[0] = layout.stride;
+    for(int i = 0; i < 4; ++i){
+      header.layout[1 + i * 4] = fields[i]->offset;
+      header.layout[2 + i * 4] = fields[i]->type;
+      header.layout[3 + i * 4] = fields[i]->count;
+      header.layout[4 + i * 4] = fields[i]->normalized ? 1u : 0u;
+    }
+    for(int axis = 0; axis < 3; ++axis){
+      header.scale[axis] = scale.data()[axis];
+      header.offset[axis] = offset.data()[axis];
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(RawHeader));
+    file.write(static_cast<const char*>(points), count * layout.stride);
+    return file.good();
+  }
+
+  bool PointCloudFile::is_loaded(){
+    return is_loaded_;
+  }
+
+  const std::string PointCloudFile::error_log(){
+    return error_log_;
+  }
+
+  std::uint64_t PointCloudFile::size(){
+    return point_count_;
+  }
+
+  const Visualizer::PointLayout &PointCloudFile::layout(){
+    return layout_;
+  }
+
+  const algebraica::vec3f &PointCloudFile::scale(){
+    return scale_;
+  }
+
+  const algebraica::vec3f &PointCloudFile::offset(){
+    return offset_;
+  }
+
+  const double *PointCloudFile::origin(){
+    return origin_;
+  }
+
+  const unsigned char *PointCloudFile::map(const std::uint64_t first, const std::uint64_t count){
+    if(!is_loaded_ || count == 0u || first + count > point_count_) return nullptr;
+
+    try{
+      boost::interprocess::mapped_region region(file_, boost::interprocess::read_only,
+                                                data_offset_ + first * layout_.stride,
+                                                count * layout_.stride);
+      // the block is read only once from beginning to end
+      region.advise(boost::interprocess::mapped_region::advice_sequential);
+      region_.swap(region);
+    }catch(const boost::interprocess::interprocess_exception &){
+      return nullptr;
+    }
+
+    const unsigned char *points{static_cast<const unsigned char*>(region_.get_address())};
+    if(!decodes_positions_) return points;
+
+    // integer positions are decoded relative to the origin in double precision, the
+    // georeferenced coordinates (10^5 -> 10^6 meters) do not fit in a float
+    block_.assign(points, points + count * layout_.stride);
+    for(std::uint64_t i = 0u; i < count; ++i){
+      unsigned char *point{block_.data() + i * layout_.stride};
+      for(int axis = 0; axis < 3; ++axis){
+        const std::int32_t value{read_value<std::int32_t>(reinterpret_cast<const char*>(point),
+                                                          axis * sizeof(std::int32_t))};
+        const float position{static_cast<float>(value * position_scale_[axis] +
+                                                position_offset_[axis] - origin_[axis])};
+        std::memcpy(point + axis * sizeof(float), &position, sizeof(float));
+      }
+    }
+    return block_.data();
+  }
+
+  void PointCloudFile::unmap(){
+    boost::interprocess::mapped_region empty;
+    region_.swap(empty);
+    std::vector<unsigned char>().swap(block_);
+  }
+
+  bool PointCloudFile::read_pcd(){
+    std::ifstream file(path_, std::ios::binary);
+
+    std::vector<std::string> names;
+    std::vector<unsigned int> sizes, counts;
+    std::vector<char> types;
+    std::uint64_t width{0u}, height{1u};
+    bool has_points{false}, has_data{false};
+
+    std::string line;
+    while(std::getline(file, line)){
+      if(line.empty() || line[0] == '#') continue;
+
+      std::istringstream stream(line);
+      std::string key;
+      stream >> key;
+
+      if(key == "FIELDS"){
+        std::string name;
+        while(stream >> name) names.push_back(name);
+      }else if(key == "SIZE"){
+        unsigned int size;
+        while(stream >> size) sizes.push_back(size);
+      }else if(key == "TYPE"){
+        char type;
+        while(stream >> type) types.push_back(type);
+      }else if(key == "COUNT"){
+        unsigned int count;
+        while(stream >> count) counts.push_back(count);
+      }else if(key == "WIDTH"){
+        stream >> width;
+      }else if(key == "HEIGHT"){
+        stream >> height;
+      }else if(key == "POINTS"){
+        stream >> point_count_;
+        has_points = true;
+      }else if(key == "DATA"){
+        std::string data;
+        stream >> data;
+        if(data != "binary"){
+          error_log_ = "The file: " + path_ + " is not a binary PCD (DATA " + data + ").\n";
+          return false;
+        }
+        data_offset_ = static_cast<std::uint64_t>(file.tellg());
+        has_data = true;
+        break;
+      }
+    }
+
+    if(!has_data || names.empty() || sizes.size() != names.size() ||
+       types.size() != names.size()){
+      error_log_ = "The file: " + path_ + " has an invalid PCD header.\n";
+      return false;
+    }
+    if(counts.size() != names.size()) counts.assign(names.size(), 1u);
+    if(!has_points) point_count_ = width * height;
+
+    unsigned int offset{0u};
+    std::vector<unsigned int> offsets(names.size());
+    for(std::size_t i = 0; i < names.size(); ++i){
+      offsets[i] = offset;
+      offset += sizes[i] * counts[i];
+    }
+    layout_.stride = offset;
+
+    const std::size_t missing{names.size()};
+    const std::size_t x{static_cast<std::size_t>(std::find(names.begin(), names.end(), "x") -
+                                                 names.begin())};
+    const std::size_t y{static_cast<std::size_t>(std::find(names.begin(), names.end(), "y") -
+                                                 names.begin())};
+    const std::size_t z{static_cast<std::size_t>(std::find(names.begin(), names.end(), "z") -
+                                                 names.begin())};
+
+    // the position is read as one attribute of 3 components
+    if(x != missing && y != missing && z != missing && types[x] == types[y] &&
+       types[x] == types[z] && sizes[x] == sizes[y] && sizes[x] == sizes[z] &&
+       offsets[y] == offsets[x] + sizes[x] && offsets[z] == offsets[y] + sizes[y]){
+      const GLenum type{pcd_type(types[x], sizes[x])};
+      if(type == 0){
+        error_log_ = "The file: " + path_ + " has an unsupported position type.\n";
+        return false;
+      }
+      layout_.position = field(offsets[x], type, 3u);
+    }else{
+      error_log_ = "The file: " + path_ + " does not have consecutive x, y and z fields.\n";
+      return false;
+    }
+
+    for(std::size_t i = 0; i < names.size(); ++i)
+      if(names[i] == "intensity" || names[i] == "i"){
+        const GLenum type{pcd_type(types[i], sizes[i])};
+        if(type != 0) layout_.intensity = field(offsets[i], type, 1u);
+      }else if((names[i] == "rgb" || names[i] == "rgba") && sizes[i] == 4u){
+        // packed as 4 bytes: blue, green, red, alpha
+        layout_.color = field(offsets[i], GL_UNSIGNED_BYTE, GL_BGRA, true);
+        if(names[i] == "rgba")
+          layout_.alpha = field(offsets[i] + 3u, GL_UNSIGNED_BYTE, 1u, true);
+      }
+
+    return true;
+  }
+
+  bool PointCloudFile::read_las(){
+    std::ifstream file(path_, std::ios::binary);
+
+    char header[las_header_size] = {0};
+    file.read(header, las_header_size);
+    const std::streamsize header_size{file.gcount()};
+
+    if(header_size < 227 || std::memcmp(header, "LASF", 4) != 0){
+      error_log_ = "The file: " + path_ + " is not a valid LAS file.\n";
+      return false;
+    }
+
+    const unsigned char minor{read_value<unsigned char>(header, 25)};
+    const unsigned char format{read_value<unsigned char>(header, 104)};
+    // the two most significant bits are used by LAZ files
+    if(format > 10u){
+      error_log_ = "The file: " + path_ + " is compressed or has an unknown point format.\n";
+      return false;
+    }
+
+    data_offset_ = read_value<std::uint32_t>(header, 96);
+    point_count_ = read_value<std::uint32_t>(header, 107);
+    if(minor >= 4u && header_size >= 255){
+      const std::uint64_t count{read_value<std::uint64_t>(header, 247)};
+      if(count > 0u) point_count_ = count;
+    }
+
+    // the positions are decoded by map() into floats relative to the center of the
+    // bounding box (maximum and minimum of every axis after the offsets)
+    for(int axis = 0; axis < 3; ++axis){
+      position_scale_[axis] = read_value<double>(header, 131 + axis * 8);
+      position_offset_[axis] = read_value<double>(header, 155 + axis * 8);
+      const double maximum{read_value<double>(header, 179 + axis * 16)};
+      const double minimum{read_value<double>(header, 187 + axis * 16)};
+      origin_[axis] = (maximum >= minimum) ? std::floor((maximum + minimum) * 0.5)
+                                           : position_offset_[axis];
+    }
+    decodes_positions_ = true;
+
+    layout_.stride = read_value<std::uint16_t>(header, 105);
+    layout_.position = field(0u, GL_FLOAT, 3u);
+    layout_.intensity = field(12u, GL_UNSIGNED_SHORT, 1u);
+
+    // colors are 16 bits per channel
+    switch(format){
+    case 2u:
+      layout_.color = field(20u, GL_UNSIGNED_SHORT, 3u, true);
+      break;
+    case 3u:
+    case 5u:
+      layout_.color = field(28u, GL_UNSIGNED_SHORT, 3u, true);
+      break;
+    case 7u:
+    case 8u:
+    case 10u:
+      layout_.color = field(30u, GL_UNSIGNED_SHORT, 3u, true);
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+  bool PointCloudFile::read_raw(){
+    std::ifstream file(path_, std::ios::binary);
+
+    RawHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(RawHeader));
+    if(!file.good() || std::memcmp(header.magic, raw_magic, sizeof(header.magic)) != 0 ||
+       header.version != raw_version){
+      error_log_ = "The file: " + path_ + " is not a valid torero raw file.\n";
+      return false;
+    }
+
+    Visualizer::PointField *fields[4] = { &layout_.position, &layout_.intensity,
+                                          &layout_.color, &layout_.alpha };
+    layout_.stride = header.layout[0];
+    for(int i = 0; i < 4; ++i)
+      *fields[i] = field(header.layout[1 + i * 4], header.layout[2 + i * 4],
+                         header.layout[3 + i * 4], header.layout[4 + i * 4] != 0u);
+
+    scale_ = algebraica::vec3f(header.scale[0], header.scale[1], header.scale[2]);
+    offset_ = algebraica::vec3f(header.offset[0], header.offset[1], header.offset[2]);
+    point_count_ = header.point_count;
+    data_offset_ = sizeof(RawHeader);
+    return true;
+  }
+}
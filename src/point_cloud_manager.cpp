@@ -1,40 +1,62 @@
 #include "include/point_cloud_manager.h"
 #include "include/core.h"
 
+#include <algorithm>
+
 namespace Toreo {
   PointCloudManager::PointCloudManager(Core *core) :
     core_(core),
     shader_(new Shader("resources/shaders/point_cloud.vert",
                        "resources/shaders/point_cloud.frag")),
-    u_pv_(shader_->uniform_location("u_pv")),
+    range_shader_(new Shader("resources/shaders/range_image.vert",
+                             "resources/shaders/point_cloud.frag")),
+    shader_variants_{},
+    batch_shader_(new Shader("resources/shaders/point_cloud_batch.vert",
+                             "resources/shaders/point_cloud.frag")),
+    batch_(new PointCloudBatch(batch_shader_)),
+    process_shader_(nullptr),
     point_clouds_(0),
-    signal_updated_camera_(core->signal_updated_camera()->
-                           connect(boost::bind(&PointCloudManager::updated_camera, this))),
-    signal_draw_all_(core->syncronize(Visualizer::POINT_CLOUDS)->
-                     connect(boost::bind(&PointCloudManager::draw_all, this)))
+    point_budget_(5000000u),
+    render_pass_(core->add_render_pass(Visualizer::POINT_CLOUDS,
+                                       boost::bind(&PointCloudManager::draw_all, this)))
   {
-    shader_->set_value(u_pv_, core->camera_matrix_perspective_view());
+    // one program per color mode without runtime branches, the clouds select theirs
+    for(unsigned int mode = Visualizer::GRAYSCALE; mode <= Visualizer::NONE; ++mode)
+      shader_variants_[mode] = new Shader("resources/shaders/point_cloud.vert",
+                                          "resources/shaders/point_cloud.frag", "",
+                                          "#define COLOR_MODE " + std::to_string(mode));
   }
 
   PointCloudManager::~PointCloudManager(){
-    for(Visualizer::PointCloudElement cloud : point_clouds_)
+    for(Visualizer::PointCloudElement &cloud : point_clouds_)
       if(cloud.point_cloud != nullptr){
         if(cloud.connection.connected())
           cloud.connection.disconnect();
         delete cloud.point_cloud;
-      }
-
-    if(signal_updated_camera_.connected())
-      signal_updated_camera_.disconnect();
+      }else if(cloud.octree != nullptr)
+        delete cloud.octree;
+      else if(cloud.range_image != nullptr)
+        delete cloud.range_image;
 
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
     if(signal_updated_all_.connected())
       signal_updated_all_.disconnect();
 
     if(shader_)
       delete shader_;
+    if(range_shader_)
+      delete range_shader_;
+    for(Shader *variant : shader_variants_)
+      if(variant)
+        delete variant;
+    // after the clouds, they leave the batch when deleted
+    if(batch_)
+      delete batch_;
+    if(batch_shader_)
+      delete batch_shader_;
+    if(process_shader_)
+      delete process_shader_;
   }
 
 
@@ -46,11 +68,14 @@ namespace Toreo {
                                const float point_size, const float maximum_intensity_value){
     Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud,
                                             algebraica::vec3f(color_red, color_green, color_blue),
-                                            point_size, maximum_intensity_value), name, visible };
+                                            point_size, maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
     if(transformation_matrix != nullptr)
       cloud.point_cloud->set_transformation_matrix(transformation_matrix);
 
     point_clouds_.push_back(cloud);
+    core_->request_redraw();
     return point_clouds_.size() - 1;
   }
 
@@ -62,11 +87,13 @@ namespace Toreo {
                                const float maximum_intensity_value){
     Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud,
                                             color_mode, point_size, maximum_intensity_value),
-                                            name, visible };
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
     if(transformation_matrix != nullptr)
       cloud.point_cloud->set_transformation_matrix(transformation_matrix);
 
     point_clouds_.push_back(cloud);
+    core_->request_redraw();
     return point_clouds_.size() - 1;
   }
 
@@ -76,11 +103,14 @@ namespace Toreo {
                                const bool visible, const float point_size,
                                const float maximum_intensity_value){
     Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud,
-                                            point_size, maximum_intensity_value), name, visible };
+                                            point_size, maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
     if(transformation_matrix != nullptr)
       cloud.point_cloud->set_transformation_matrix(transformation_matrix);
 
     point_clouds_.push_back(cloud);
+    core_->request_redraw();
     return point_clouds_.size() - 1;
   }
 
@@ -90,14 +120,147 @@ namespace Toreo {
                                const bool visible, const float point_size,
                                const float maximum_intensity_value){
     Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud,
-                                            point_size, maximum_intensity_value), name, visible };
+                                            point_size, maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
+    if(transformation_matrix != nullptr)
+      cloud.point_cloud->set_transformation_matrix(transformation_matrix);
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::add(const std::vector<Visualizer::pointXYZIq16> *point_cloud,
+                               const std::string name,
+                               const algebraica::vec3f scale, const algebraica::vec3f offset,
+                               const algebraica::mat4f *transformation_matrix,
+                               const Visualizer::ColorMode color_mode,
+                               const bool visible, const float point_size,
+                               const float maximum_intensity_value){
+    Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud, scale, offset,
+                                            color_mode, point_size, maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
+    if(transformation_matrix != nullptr)
+      cloud.point_cloud->set_transformation_matrix(transformation_matrix);
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::add(const std::vector<Visualizer::pointXYZRGB8> *point_cloud,
+                               const std::string name,
+                               const algebraica::vec3f scale, const algebraica::vec3f offset,
+                               const algebraica::mat4f *transformation_matrix,
+                               const bool visible, const float point_size){
+    Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud, scale, offset,
+                                            point_size), name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
+    if(transformation_matrix != nullptr)
+      cloud.point_cloud->set_transformation_matrix(transformation_matrix);
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::add(const std::vector<unsigned char> *point_cloud,
+                               const Visualizer::PointLayout layout, const std::string name,
+                               const algebraica::mat4f *transformation_matrix,
+                               const Visualizer::ColorMode color_mode,
+                               const bool visible, const float point_size,
+                               const float maximum_intensity_value){
+    Visualizer::PointCloudElement cloud = { new PointCloud(shader_, point_cloud, layout,
+                                            color_mode, point_size, maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
+    if(transformation_matrix != nullptr)
+      cloud.point_cloud->set_transformation_matrix(transformation_matrix);
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::add(const std::vector<unsigned short> *range,
+                               const std::vector<unsigned char> *intensity,
+                               const unsigned int rings, const unsigned int columns,
+                               const std::vector<float> &elevations, const std::string name,
+                               const float range_scale,
+                               const algebraica::mat4f *transformation_matrix,
+                               const Visualizer::ColorMode color_mode,
+                               const bool visible, const float point_size){
+    Visualizer::PointCloudElement cloud = { nullptr, name, visible, {}, {} };
+    cloud.range_image = new RangeImageCloud(range_shader_, rings, columns, elevations,
+                                            range_scale, color_mode, point_size);
+    cloud.range_image->change_input(range, intensity);
+    cloud.range_image->update();
+    if(transformation_matrix != nullptr)
+      cloud.range_image->set_transformation_matrix(transformation_matrix);
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::add(const std::string octree_path, const std::string name,
+                               const algebraica::mat4f *transformation_matrix,
+                               const Visualizer::ColorMode color_mode,
+                               const bool visible, const float point_size,
+                               const float maximum_intensity_value){
+    Visualizer::PointCloudElement cloud = { nullptr, name, visible, {}, {} };
+    cloud.octree = new OctreeCloud(shader_, octree_path, color_mode, point_size,
+                                   maximum_intensity_value);
+    if(!cloud.octree->is_loaded())
+      core_->message_handler(cloud.octree->error_log(), Visualizer::ERROR);
+    if(transformation_matrix != nullptr)
+      cloud.octree->set_transformation_matrix(transformation_matrix);
+    cloud.octree->set_cache_size(point_budget_ * 3u);
+    cloud.octree->set_notifier(boost::bind(&PointCloudManager::request_redraw, this));
+
+    point_clouds_.push_back(cloud);
+    core_->request_redraw();
+    return point_clouds_.size() - 1;
+  }
+
+  PCMid PointCloudManager::load(const std::string path, const std::string name,
+                                const algebraica::mat4f *transformation_matrix,
+                                const Visualizer::ColorMode color_mode,
+                                const bool visible, const float point_size,
+                                const float maximum_intensity_value){
+    PointCloudFile *file{new PointCloudFile(path)};
+    if(!file->is_loaded())
+      core_->message_handler(file->error_log(), Visualizer::ERROR);
+
+    Visualizer::PointCloudElement cloud = { new PointCloud(shader_, file, color_mode, point_size,
+                                                           maximum_intensity_value),
+                                            name, visible, {}, {} };
+    cloud.point_cloud->set_shader_variants(shader_variants_);
     if(transformation_matrix != nullptr)
       cloud.point_cloud->set_transformation_matrix(transformation_matrix);
 
     point_clouds_.push_back(cloud);
+    core_->request_redraw();
     return point_clouds_.size() - 1;
   }
 
+  bool PointCloudManager::file_origin(PCMid id, double *x, double *y, double *z){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        double origin[3];
+        if(!point_clouds_[id].point_cloud->file_origin(origin)) return false;
+        *x = origin[0];
+        *y = origin[1];
+        *z = origin[2];
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
   bool PointCloudManager::change_input(PCMid id,
                                        const std::vector<Visualizer::pointXYZ> *point_cloud){
     if(point_clouds_.size() > id)
@@ -146,19 +309,289 @@ namespace Toreo {
       return false;
   }
 
+  bool PointCloudManager::change_input(PCMid id,
+                                       const std::vector<Visualizer::pointXYZIq16> *point_cloud){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->change_input(point_cloud);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::change_input(PCMid id,
+                                       const std::vector<Visualizer::pointXYZRGB8> *point_cloud){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->change_input(point_cloud);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::change_input(PCMid id, const std::vector<unsigned char> *point_cloud){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->change_input(point_cloud);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::change_input(PCMid id, const std::vector<unsigned char> *point_cloud,
+                                       const Visualizer::PointLayout layout){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->change_input(point_cloud, layout);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::change_input(PCMid id, const std::vector<unsigned short> *range,
+                                       const std::vector<unsigned char> *intensity){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->change_input(range, intensity);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_beam_angles(PCMid id, const std::vector<float> &elevations,
+                                          const std::vector<float> &azimuth_offsets){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->set_beam_angles(elevations, azimuth_offsets);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_azimuth(PCMid id, const float start, const float step){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->set_azimuth(start, step);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_quantization(PCMid id, const algebraica::vec3f scale,
+                                           const algebraica::vec3f offset){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_quantization(scale, offset);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
   bool PointCloudManager::set_visibility(PCMid id, const bool visible){
     if(point_clouds_.size() > id){
       point_clouds_[id].visibility = visible;
+      core_->request_redraw();
       return true;
     }else
       return false;
   }
 
+  bool PointCloudManager::set_streaming(PCMid id, const bool streaming){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_streaming(streaming);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_downsampling(PCMid id, const Visualizer::Downsampling downsampling,
+                                           const float value){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_notifier(
+          boost::bind(&PointCloudManager::request_redraw, this));
+        point_clouds_[id].point_cloud->set_downsampling(downsampling, value);
+        point_clouds_[id].point_cloud->update();
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_accumulation(PCMid id, const unsigned int scans,
+                                           const float fade_time){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_accumulation(scans, fade_time);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::accumulate(PCMid id, const algebraica::mat4f &pose,
+                                     const double timestamp){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_scan_pose(pose, timestamp);
+        point_clouds_[id].point_cloud->update();
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_batched(PCMid id, const bool batched){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_batch(batched ? batch_ : nullptr);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_processing(PCMid id,
+                                         const Visualizer::PointProcessing *processing){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        // compiled only when needed, OpenGL 4.2 does not have compute shaders
+        if(processing && !process_shader_ && PointProcessor::is_supported()){
+          process_shader_ = new Shader();
+          if(!process_shader_->create_compute("resources/shaders/point_cloud.comp"))
+            core_->message_handler(process_shader_->error_log(), Visualizer::ERROR);
+        }
+        const bool processed{point_clouds_[id].point_cloud->set_processing(process_shader_,
+                                                                           processing)};
+        core_->request_redraw();
+        return processed;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::set_indexing(PCMid id, const bool indexing){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].point_cloud->set_indexing(indexing);
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::nearest_point(PCMid id, const int screen_x, const int screen_y,
+                                        std::uint32_t *index, algebraica::vec3f *position,
+                                        const float radius){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        float x, y, device_radius;
+        screen_to_device(screen_x, screen_y, radius, &x, &y, &device_radius);
+        return point_clouds_[id].point_cloud->nearest_point(
+              core_->camera_matrix_perspective_view(), x, y, device_radius, index, position);
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::nearest_point(const int screen_x, const int screen_y, PCMid *id,
+                                        std::uint32_t *index, algebraica::vec3f *position,
+                                        const float radius){
+    float x, y, device_radius;
+    screen_to_device(screen_x, screen_y, radius, &x, &y, &device_radius);
+    const algebraica::mat4f &pv = core_->camera_matrix_perspective_view();
+
+    bool found{false};
+    float nearest_depth{0.0f};
+    for(std::size_t i = 0; i < point_clouds_.size(); ++i){
+      Visualizer::PointCloudElement &cloud = point_clouds_[i];
+      if(cloud.point_cloud == nullptr || !cloud.visibility) continue;
+
+      std::uint32_t point;
+      algebraica::vec3f point_position;
+      float depth;
+      if(cloud.point_cloud->nearest_point(pv, x, y, device_radius, &point, &point_position,
+                                          &depth) && (!found || depth < nearest_depth)){
+        found = true;
+        nearest_depth = depth;
+        if(id) *id = static_cast<PCMid>(i);
+        if(index) *index = point;
+        if(position) *position = point_position;
+      }
+    }
+    return found;
+  }
+
+  std::size_t PointCloudManager::points_in_radius(PCMid id, const algebraica::vec3f &center,
+                                                  const float radius,
+                                                  std::vector<std::uint32_t> *indices){
+    if(point_clouds_.size() > id && point_clouds_[id].point_cloud != nullptr)
+      return point_clouds_[id].point_cloud->points_in_radius(center, radius, indices);
+    indices->clear();
+    return 0u;
+  }
+
+  std::size_t PointCloudManager::points_in_box(PCMid id, const algebraica::vec3f &minimum,
+                                               const algebraica::vec3f &maximum,
+                                               std::vector<std::uint32_t> *indices){
+    if(point_clouds_.size() > id && point_clouds_[id].point_cloud != nullptr)
+      return point_clouds_[id].point_cloud->points_in_box(minimum, maximum, indices);
+    indices->clear();
+    return 0u;
+  }
+
+  void PointCloudManager::set_point_budget(const std::size_t points){
+    point_budget_ = points;
+    for(Visualizer::PointCloudElement &cloud : point_clouds_)
+      if(cloud.octree != nullptr)
+        cloud.octree->set_cache_size(point_budget_ * 3u);
+    core_->request_redraw();
+  }
+
   bool PointCloudManager::set_colormap(PCMid id, const algebraica::vec3f *colors,
                                        const unsigned int quantity){
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->set_colormap(colors, quantity);
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->set_colormap(colors, quantity);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -170,6 +603,15 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->set_color_mode(color_mode);
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].octree != nullptr){
+        point_clouds_[id].octree->set_color_mode(color_mode);
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->set_color_mode(color_mode);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -182,6 +624,15 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].octree != nullptr){
+        point_clouds_[id].octree->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr){
+        point_clouds_[id].range_image->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -193,6 +644,7 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->translate(-y, z, -x);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -204,6 +656,7 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->rotate(-pitch, yaw, -roll);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -215,6 +668,7 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->rotate_in_z(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -226,6 +680,7 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->rotate_in_x(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -237,6 +692,7 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr){
         point_clouds_[id].point_cloud->rotate_in_y(angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -248,6 +704,36 @@ namespace Toreo {
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr && point_clouds_[id].visibility){
         point_clouds_[id].point_cloud->update();
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr && point_clouds_[id].visibility){
+        point_clouds_[id].range_image->update();
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::update_range(PCMid id, const std::size_t first,
+                                       const std::size_t count){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr && point_clouds_[id].visibility){
+        point_clouds_[id].point_cloud->update_range(first, count);
+        core_->request_redraw();
+        return true;
+      }else
+        return false;
+    else
+      return false;
+  }
+
+  bool PointCloudManager::append(PCMid id){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr && point_clouds_[id].visibility){
+        point_clouds_[id].point_cloud->append();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -256,15 +742,27 @@ namespace Toreo {
   }
 
   void PointCloudManager::update_all(){
-    for(Visualizer::PointCloudElement cloud : point_clouds_)
+    for(Visualizer::PointCloudElement &cloud : point_clouds_)
       if(cloud.point_cloud != nullptr && cloud.visibility)
         cloud.point_cloud->update();
+      else if(cloud.range_image != nullptr && cloud.visibility)
+        cloud.range_image->update();
+    core_->request_redraw();
   }
 
   bool PointCloudManager::draw(PCMid id){
     if(point_clouds_.size() > id)
       if(point_clouds_[id].point_cloud != nullptr && point_clouds_[id].visibility){
         point_clouds_[id].point_cloud->draw();
+        // a batched cloud was only queued
+        batch_->draw();
+        return true;
+      }else if(point_clouds_[id].octree != nullptr && point_clouds_[id].visibility){
+        point_clouds_[id].octree->draw(core_->camera_matrix_perspective_view(),
+                                       core_->camera_position(), screen_factor(), point_budget_);
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr && point_clouds_[id].visibility){
+        point_clouds_[id].range_image->draw();
         return true;
       }else
         return false;
@@ -273,9 +771,23 @@ namespace Toreo {
   }
 
   void PointCloudManager::draw_all(){
-    for(Visualizer::PointCloudElement cloud : point_clouds_)
-      if(cloud.point_cloud != nullptr && cloud.visibility)
+    // the budget is shared by all the octrees, in order of creation
+    std::size_t budget{point_budget_};
+    const float factor{screen_factor()};
+
+    for(Visualizer::PointCloudElement &cloud : point_clouds_)
+      if(cloud.point_cloud != nullptr && cloud.visibility){
+        if(cloud.refresh && cloud.refresh())
+          cloud.point_cloud->update();
         cloud.point_cloud->draw();
+      }else if(cloud.octree != nullptr && cloud.visibility && budget > 0u)
+        budget -= cloud.octree->draw(core_->camera_matrix_perspective_view(),
+                                     core_->camera_position(), factor, budget);
+      else if(cloud.range_image != nullptr && cloud.visibility)
+        cloud.range_image->draw();
+
+    // all the batched clouds that were queued above
+    batch_->draw();
   }
 
   bool PointCloudManager::delete_cloud(PCMid id){
@@ -285,6 +797,18 @@ namespace Toreo {
           point_clouds_[id].connection.disconnect();
         delete point_clouds_[id].point_cloud;
         point_clouds_[id].point_cloud = nullptr;
+        point_clouds_[id].refresh.clear();
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].octree != nullptr){
+        delete point_clouds_[id].octree;
+        point_clouds_[id].octree = nullptr;
+        core_->request_redraw();
+        return true;
+      }else if(point_clouds_[id].range_image != nullptr){
+        delete point_clouds_[id].range_image;
+        point_clouds_[id].range_image = nullptr;
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -293,18 +817,22 @@ namespace Toreo {
   }
 
   void PointCloudManager::purge(){
-    for(Visualizer::PointCloudElement cloud : point_clouds_)
+    for(Visualizer::PointCloudElement &cloud : point_clouds_)
       if(cloud.point_cloud != nullptr){
         if(cloud.connection.connected())
           cloud.connection.disconnect();
         delete cloud.point_cloud;
-      }
+      }else if(cloud.octree != nullptr)
+        delete cloud.octree;
+      else if(cloud.range_image != nullptr)
+        delete cloud.range_image;
     point_clouds_.clear();
+    core_->request_redraw();
   }
 
   bool PointCloudManager::connect(PCMid id, boost::signals2::signal<void ()> *signal){
     if(point_clouds_.size() > id)
-      if(point_clouds_[id].point_cloud != nullptr){
+      if(point_clouds_[id].point_cloud != nullptr || point_clouds_[id].range_image != nullptr){
         if(point_clouds_[id].connection.connected())
           point_clouds_[id].connection.disconnect();
         point_clouds_[id].connection =
@@ -322,8 +850,42 @@ namespace Toreo {
     signal_updated_all_ = signal->connect(boost::bind(&PointCloudManager::update_all, this));
   }
 
-  void PointCloudManager::updated_camera(){
-    shader_->use();
-    shader_->set_value(u_pv_, core_->camera_matrix_perspective_view());
+  void PointCloudManager::request_redraw(){
+    core_->request_redraw();
+  }
+
+  float PointCloudManager::screen_factor(){
+    // pixels per unit at distance 1: viewport height / (2 * tan(fov / 2))
+    int height;
+    core_->window_size(nullptr, nullptr, nullptr, &height);
+    return height * core_->camera_matrix_perspective().data()[5] * 0.5f;
+  }
+
+  void PointCloudManager::screen_to_device(const int screen_x, const int screen_y,
+                                           const float radius, float *x, float *y,
+                                           float *device_radius){
+    // the mouse is in window coordinates and the viewport (the whole frame) in framebuffer
+    // pixels, they are different in HiDPI monitors
+    int window_width, window_height, frame_width, frame_height;
+    core_->window_size(&window_width, &window_height, &frame_width, &frame_height);
+    const float scale_x{static_cast<float>(frame_width) / std::max(window_width, 1)};
+    const float scale_y{static_cast<float>(frame_height) / std::max(window_height, 1)};
+    const float width{static_cast<float>(std::max(frame_width, 1))};
+    const float height{static_cast<float>(std::max(frame_height, 1))};
+    // the screen's y axis goes down, the normalized device's y axis goes up
+    *x = 2.0f * screen_x * scale_x / width - 1.0f;
+    *y = 1.0f - 2.0f * screen_y * scale_y / height;
+    *device_radius = 2.0f * radius * scale_x / width;
+  }
+
+  bool PointCloudManager::unsubscribe(PCMid id){
+    if(point_clouds_.size() > id)
+      if(point_clouds_[id].point_cloud != nullptr){
+        point_clouds_[id].refresh.clear();
+        return true;
+      }else
+        return false;
+    else
+      return false;
   }
 }
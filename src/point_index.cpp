@@ -0,0 +1,430 @@
+#include "include/point_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace Toreo {
+  namespace {
+    const std::int32_t maximum_voxels = (1 << 21) - 1;
+    const std::uint64_t empty_key = ~0ull;
+    // the voxels are made smaller while they contain more points than this on average
+    const std::size_t maximum_occupancy = 32u;
+
+    std::uint64_t mix(std::uint64_t key){
+      // splitmix64 finalizer
+      key ^= key >> 30;
+      key *= 0xbf58476d1ce4e5b9ull;
+      key ^= key >> 27;
+      key *= 0x94d049bb133111ebull;
+      return key ^ (key >> 31);
+    }
+
+    std::uint64_t pack(const std::int32_t x, const std::int32_t y, const std::int32_t z){
+      return static_cast<std::uint64_t>(x) | (static_cast<std::uint64_t>(y) << 21) |
+             (static_cast<std::uint64_t>(z) << 42);
+    }
+
+    // inverse of a column major 4x4 matrix, returns false if it is singular
+    bool invert(const float *m, float *inverse){
+      float r[16];
+      r[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] +
+               m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+      r[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] -
+               m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+      r[8]  =  m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] +
+               m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+      r[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] -
+               m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+      r[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] -
+               m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+      r[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] +
+               m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+      r[9]  = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] -
+               m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+      r[13] =  m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] +
+               m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+      r[2]  =  m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] +
+               m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+      r[6]  = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] -
+               m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+      r[10] =  m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] +
+               m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+      r[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] -
+               m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+      r[3]  = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] -
+               m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+      r[7]  =  m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] +
+               m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+      r[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] -
+               m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+      r[15] =  m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] +
+               m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+      const float determinant{m[0] * r[0] + m[1] * r[4] + m[2] * r[8] + m[3] * r[12]};
+      if(determinant == 0.0f || !std::isfinite(determinant)) return false;
+
+      for(int i = 0; i < 16; ++i)
+        inverse[i] = r[i] / determinant;
+      return true;
+    }
+
+    // point = matrix * (x, y, z, 1) divided by w
+    bool unproject(const float *m, const float x, const float y, const float z, float *point){
+      const float w{m[3] * x + m[7] * y + m[11] * z + m[15]};
+      if(w == 0.0f) return false;
+      for(int i = 0; i < 3; ++i)
+        point[i] = (m[i] * x + m[i + 4] * y + m[i + 8] * z + m[i + 12]) / w;
+      return true;
+    }
+
+    float distance(const float *a, const float *b){
+      return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) +
+                       (a[2] - b[2]) * (a[2] - b[2]));
+    }
+  }
+
+  PointIndex::PointIndex() :
+    mutex_(),
+    grid_(),
+    worker_(new WorkerPool(1u))
+  {}
+
+  PointIndex::~PointIndex(){
+    delete worker_;
+  }
+
+  void PointIndex::build(const void *points, const std::size_t count, const std::size_t stride,
+                         const std::size_t position_offset){
+    // the input could change while the worker builds the index
+    boost::shared_ptr<std::vector<float> > positions(new std::vector<float>(count * 3u));
+    const unsigned char *input{static_cast<const unsigned char*>(points) + position_offset};
+    for(std::size_t i = 0; i < count; ++i)
+      std::memcpy(&(*positions)[i * 3u], input + i * stride, 3u * sizeof(float));
+
+    worker_->clear();
+    worker_->post(boost::bind(&PointIndex::create, this, positions));
+  }
+
+  void PointIndex::wait(){
+    worker_->wait();
+  }
+
+  bool PointIndex::is_ready(){
+    return grid() != nullptr;
+  }
+
+  std::size_t PointIndex::size(){
+    const boost::shared_ptr<const Grid> current{grid()};
+    return current ? current->indices.size() : 0u;
+  }
+
+  bool PointIndex::nearest(const float *mvp, const float x, const float y, const float radius,
+                           std::uint32_t *index, float *position, float *depth){
+    const boost::shared_ptr<const Grid> current{grid()};
+    if(!current || current->indices.empty()) return false;
+    const Grid &grid = *current;
+
+    // the axes conversion of point_cloud.vert: (x, y, z) -> (-y, z, -x)
+    float m[16], inverse[16];
+    for(int i = 0; i < 4; ++i){
+      m[i]      = -mvp[i + 8];
+      m[i + 4]  = -mvp[i];
+      m[i + 8]  = mvp[i + 4];
+      m[i + 12] = mvp[i + 12];
+    }
+    if(!invert(m, inverse)) return false;
+
+    // ray from the near to the far plane, the pick tolerance grows linearly with the
+    // distance: tolerance(t) = a + b * t
+    float near[3], far[3], near_side[3], far_side[3];
+    if(!unproject(inverse, x, y, -1.0f, near) || !unproject(inverse, x, y, 1.0f, far) ||
+       !unproject(inverse, x + radius, y, -1.0f, near_side) ||
+       !unproject(inverse, x + radius, y, 1.0f, far_side))
+      return false;
+
+    const float length{distance(near, far)};
+    if(!(length > 0.0f)) return false;
+    const float direction[3]{(far[0] - near[0]) / length, (far[1] - near[1]) / length,
+                             (far[2] - near[2]) / length};
+    const float a{distance(near, near_side)};
+    const float b{(distance(far, far_side) - a) / length};
+
+    // clipping the ray with the bounding box (plus one voxel)
+    float t_start{0.0f}, t_end{length};
+    for(int i = 0; i < 3; ++i){
+      const float low{grid.minimum[i] - grid.voxel}, high{grid.maximum[i] + grid.voxel};
+      if(std::fabs(direction[i]) < 1.0e-12f){
+        if(near[i] < low || near[i] > high) return false;
+        continue;
+      }
+      float t0{(low - near[i]) / direction[i]}, t1{(high - near[i]) / direction[i]};
+      if(t0 > t1) std::swap(t0, t1);
+      t_start = std::max(t_start, t0);
+      t_end = std::min(t_end, t1);
+    }
+    if(t_start > t_end) return false;
+
+    // voxel traversal (Amanatides & Woo), the neighbours within the tolerance are visited
+    std::int32_t current_voxel[3], step[3];
+    float t_next[3], t_delta[3];
+    for(int i = 0; i < 3; ++i){
+      current_voxel[i] = voxel(grid, near[i] + direction[i] * t_start, i);
+      step[i] = (direction[i] > 0.0f)? 1 : ((direction[i] < 0.0f)? -1 : 0);
+      if(step[i] == 0){
+        t_next[i] = t_delta[i] = std::numeric_limits<float>::infinity();
+        continue;
+      }
+      const float boundary{grid.minimum[i] +
+                           (current_voxel[i] + (step[i] > 0 ? 1 : 0)) * grid.voxel};
+      t_next[i] = (boundary - near[i]) / direction[i];
+      t_delta[i] = grid.voxel / std::fabs(direction[i]);
+    }
+
+    float best{std::numeric_limits<float>::infinity()};
+    std::uint32_t best_point{0u};
+    float t{t_start};
+    const std::int32_t steps{grid.voxels[0] + grid.voxels[1] + grid.voxels[2] + 3};
+
+    for(std::int32_t s = 0; s < steps && t <= t_end; ++s){
+      const float t_exit{std::min(std::min(t_next[0], t_next[1]), t_next[2])};
+      // voxels covered by the tolerance cone at the exit of this voxel
+      const std::int32_t reach{static_cast<std::int32_t>(
+                                 std::ceil((a + b * std::min(t_exit, t_end)) / grid.voxel))};
+      // nothing closer can be found after this voxel
+      if(best < std::numeric_limits<float>::infinity() &&
+         t > best + (reach + 1) * grid.voxel * 1.7320508f)
+        break;
+
+      // only the neighbours inside the grid
+      std::int32_t first[3], last[3];
+      for(int i = 0; i < 3; ++i){
+        first[i] = std::max(current_voxel[i] - reach, 0);
+        last[i] = std::min(current_voxel[i] + reach, grid.voxels[i] - 1);
+      }
+
+      for(std::int32_t vx = first[0]; vx <= last[0]; ++vx)
+        for(std::int32_t vy = first[1]; vy <= last[1]; ++vy)
+          for(std::int32_t vz = first[2]; vz <= last[2]; ++vz){
+            const Cell *cell{find(grid, vx, vy, vz)};
+            if(!cell) continue;
+
+            for(std::uint32_t i = cell->first; i < cell->first + cell->count; ++i){
+              const float *point{&grid.positions[i * 3u]};
+              const float w[3]{point[0] - near[0], point[1] - near[1], point[2] - near[2]};
+              const float along{w[0] * direction[0] + w[1] * direction[1] +
+                                w[2] * direction[2]};
+              if(along < 0.0f || along > length || along >= best) continue;
+
+              const float tolerance{a + b * along};
+              const float squared{w[0] * w[0] + w[1] * w[1] + w[2] * w[2] - along * along};
+              if(squared <= tolerance * tolerance){
+                best = along;
+                best_point = i;
+              }
+            }
+          }
+
+      // next voxel
+      int axis{0};
+      if(t_next[1] < t_next[axis]) axis = 1;
+      if(t_next[2] < t_next[axis]) axis = 2;
+      t = t_next[axis];
+      t_next[axis] += t_delta[axis];
+      current_voxel[axis] += step[axis];
+      if(current_voxel[axis] < -2 || current_voxel[axis] > grid.voxels[axis] + 1) break;
+    }
+
+    if(best == std::numeric_limits<float>::infinity()) return false;
+
+    const float *point{&grid.positions[best_point * 3u]};
+    if(index) *index = grid.indices[best_point];
+    if(position) std::memcpy(position, point, 3u * sizeof(float));
+    if(depth){
+      const float z{m[2] * point[0] + m[6] * point[1] + m[10] * point[2] + m[14]};
+      const float w{m[3] * point[0] + m[7] * point[1] + m[11] * point[2] + m[15]};
+      *depth = (w != 0.0f)? z / w : 0.0f;
+    }
+    return true;
+  }
+
+  std::size_t PointIndex::in_radius(const float *center, const float radius,
+                                    std::vector<std::uint32_t> *indices){
+    indices->clear();
+    const boost::shared_ptr<const Grid> current{grid()};
+    if(!current || current->indices.empty() || !(radius >= 0.0f)) return 0u;
+
+    const float minimum[3]{center[0] - radius, center[1] - radius, center[2] - radius};
+    const float maximum[3]{center[0] + radius, center[1] + radius, center[2] + radius};
+    collect(*current, minimum, maximum, center, radius * radius, indices);
+    return indices->size();
+  }
+
+  std::size_t PointIndex::in_box(const float *minimum, const float *maximum,
+                                 std::vector<std::uint32_t> *indices){
+    indices->clear();
+    const boost::shared_ptr<const Grid> current{grid()};
+    if(!current || current->indices.empty()) return 0u;
+
+    collect(*current, minimum, maximum, nullptr, 0.0f, indices);
+    return indices->size();
+  }
+
+  void PointIndex::create(const boost::shared_ptr<std::vector<float> > positions){
+    boost::shared_ptr<Grid> grid(new Grid());
+    const std::vector<float> &input = *positions;
+    const std::size_t count{input.size() / 3u};
+
+    // points with NaN or infinite coordinates (no returns) are not indexed
+    std::vector<std::uint32_t> valid;
+    valid.reserve(count);
+    for(std::size_t i = 0; i < count; ++i)
+      if(std::isfinite(input[i * 3u]) && std::isfinite(input[i * 3u + 1u]) &&
+         std::isfinite(input[i * 3u + 2u]))
+        valid.push_back(static_cast<std::uint32_t>(i));
+
+    if(!valid.empty()){
+      for(int axis = 0; axis < 3; ++axis)
+        grid->minimum[axis] = grid->maximum[axis] = input[valid[0] * 3u + axis];
+      for(const std::uint32_t i : valid)
+        for(int axis = 0; axis < 3; ++axis){
+          grid->minimum[axis] = std::min(grid->minimum[axis], input[i * 3u + axis]);
+          grid->maximum[axis] = std::max(grid->maximum[axis], input[i * 3u + axis]);
+        }
+
+      // first guess: 8 points per voxel if they filled the whole volume
+      double volume{1.0};
+      for(int axis = 0; axis < 3; ++axis)
+        volume *= std::max(static_cast<double>(grid->maximum[axis] - grid->minimum[axis]), 1.0e-3);
+      grid->voxel = static_cast<float>(std::max(std::cbrt(volume * 8.0 / valid.size()), 1.0e-3));
+
+      std::vector<std::pair<std::uint64_t, std::uint32_t> > keys(valid.size());
+      std::size_t occupied{0u};
+
+      for(int attempt = 0; attempt < 4; ++attempt){
+        for(int axis = 0; axis < 3; ++axis)
+          grid->voxels[axis] = static_cast<std::int32_t>(std::min<double>(
+                                 std::floor((grid->maximum[axis] - grid->minimum[axis]) /
+                                            grid->voxel) + 1.0, maximum_voxels));
+
+        for(std::size_t k = 0; k < valid.size(); ++k){
+          const float *point{&input[valid[k] * 3u]};
+          keys[k] = std::make_pair(pack(voxel(*grid, point[0], 0), voxel(*grid, point[1], 1),
+                                        voxel(*grid, point[2], 2)), valid[k]);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        occupied = 1u;
+        for(std::size_t k = 1; k < keys.size(); ++k)
+          if(keys[k].first != keys[k - 1u].first) ++occupied;
+
+        // surfaces fill only a small part of the volume
+        if(keys.size() <= occupied * maximum_occupancy || attempt == 3) break;
+        grid->voxel *= 0.5f;
+      }
+
+      std::size_t capacity{64u};
+      while(capacity < occupied * 2u) capacity <<= 1;
+      const Cell empty = { empty_key, 0u, 0u };
+      grid->cells.assign(capacity, empty);
+      grid->mask = capacity - 1u;
+      grid->positions.resize(keys.size() * 3u);
+      grid->indices.resize(keys.size());
+
+      // the points of every voxel are consecutive
+      std::size_t slot{0u};
+      for(std::size_t k = 0; k < keys.size(); ++k){
+        std::memcpy(&grid->positions[k * 3u], &input[keys[k].second * 3u], 3u * sizeof(float));
+        grid->indices[k] = keys[k].second;
+
+        if(k == 0u || keys[k].first != keys[k - 1u].first){
+          slot = static_cast<std::size_t>(mix(keys[k].first) >> 16) & grid->mask;
+          while(grid->cells[slot].key != empty_key) slot = (slot + 1u) & grid->mask;
+          grid->cells[slot].key = keys[k].first;
+          grid->cells[slot].first = static_cast<std::uint32_t>(k);
+        }
+        ++grid->cells[slot].count;
+      }
+    }
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    grid_ = grid;
+  }
+
+  boost::shared_ptr<const PointIndex::Grid> PointIndex::grid(){
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    return grid_;
+  }
+
+  void PointIndex::collect(const Grid &grid, const float *minimum, const float *maximum,
+                           const float *center, const float squared_radius,
+                           std::vector<std::uint32_t> *indices){
+    std::int32_t low[3], high[3];
+    std::uint64_t voxels{1u};
+    for(int i = 0; i < 3; ++i){
+      if(maximum[i] < grid.minimum[i] || minimum[i] > grid.maximum[i] || minimum[i] > maximum[i])
+        return;
+      low[i] = voxel(grid, minimum[i], i);
+      high[i] = voxel(grid, maximum[i], i);
+      voxels *= static_cast<std::uint64_t>(high[i] - low[i] + 1);
+    }
+
+    const auto points = [&](const Cell &cell){
+      for(std::uint32_t i = cell.first; i < cell.first + cell.count; ++i){
+        const float *point{&grid.positions[i * 3u]};
+        if(point[0] < minimum[0] || point[0] > maximum[0] || point[1] < minimum[1] ||
+           point[1] > maximum[1] || point[2] < minimum[2] || point[2] > maximum[2])
+          continue;
+        if(center){
+          const float x{point[0] - center[0]}, y{point[1] - center[1]}, z{point[2] - center[2]};
+          if(x * x + y * y + z * z > squared_radius) continue;
+        }
+        indices->push_back(grid.indices[i]);
+      }
+    };
+
+    // big regions: visiting the occupied voxels is faster than looking for every voxel
+    if(voxels > grid.cells.size() / 2u){
+      for(const Cell &cell : grid.cells){
+        if(cell.key == empty_key) continue;
+        const std::int32_t x{static_cast<std::int32_t>(cell.key & maximum_voxels)};
+        const std::int32_t y{static_cast<std::int32_t>((cell.key >> 21) & maximum_voxels)};
+        const std::int32_t z{static_cast<std::int32_t>((cell.key >> 42) & maximum_voxels)};
+        if(x >= low[0] && x <= high[0] && y >= low[1] && y <= high[1] &&
+           z >= low[2] && z <= high[2])
+          points(cell);
+      }
+    }else{
+      for(std::int32_t x = low[0]; x <= high[0]; ++x)
+        for(std::int32_t y = low[1]; y <= high[1]; ++y)
+          for(std::int32_t z = low[2]; z <= high[2]; ++z){
+            const Cell *cell{find(grid, x, y, z)};
+            if(cell) points(*cell);
+          }
+    }
+  }
+
+  const PointIndex::Cell *PointIndex::find(const Grid &grid, const std::int32_t x,
+                                           const std::int32_t y, const std::int32_t z){
+    if(x < 0 || y < 0 || z < 0 || x >= grid.voxels[0] || y >= grid.voxels[1] ||
+       z >= grid.voxels[2] || grid.cells.empty())
+      return nullptr;
+
+    const std::uint64_t key{pack(x, y, z)};
+    std::size_t slot{static_cast<std::size_t>(mix(key) >> 16) & grid.mask};
+    while(grid.cells[slot].key != empty_key){
+      if(grid.cells[slot].key == key) return &grid.cells[slot];
+      slot = (slot + 1u) & grid.mask;
+    }
+    return nullptr;
+  }
+
+  std::int32_t PointIndex::voxel(const Grid &grid, const float value, const int axis){
+    const float scaled{std::floor((value - grid.minimum[axis]) / grid.voxel)};
+    if(!(scaled > 0.0f)) return 0;
+    if(scaled >= grid.voxels[axis] - 1) return grid.voxels[axis] - 1;
+    return static_cast<std::int32_t>(scaled);
+  }
+}
@@ -0,0 +1,154 @@
+#include "include/point_processor.h"
+
+#include <algorithm>
+
+namespace Toreo {
+  namespace {
+    // invocations per work group, the same as local_size_x in point_cloud.comp
+    const GLuint group_size = 256u;
+    // floats per output point
+    const GLsizei output_floats = 8;
+  }
+
+  PointProcessor::PointProcessor(Shader *shader_program, const GLint position,
+                                 const GLint intensity, const GLint color, const GLint alpha) :
+    shader_(shader_program),
+    processing_(),
+    output_(true),
+    command_(0),
+    capacity_(0),
+    i_position_(position),
+    i_intensity_(intensity),
+    i_color_(color),
+    i_alpha_(alpha)
+  {
+    // nothing is drawn until the first process()
+    const GLuint command[4] = { 0u, 1u, 0u, 0u };
+    glGenBuffers(1, &command_);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), command, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    shader_->use();
+    u_size_             = shader_->uniform_location("u_size");
+    u_stride_           = shader_->uniform_location("u_stride");
+    u_position_         = shader_->uniform_location("u_position");
+    u_intensity_        = shader_->uniform_location("u_intensity");
+    u_color_            = shader_->uniform_location("u_color");
+    u_alpha_            = shader_->uniform_location("u_alpha");
+    u_model_            = shader_->uniform_location("u_model");
+    u_clip_box_         = shader_->uniform_location("u_clip_box");
+    u_box_minimum_      = shader_->uniform_location("u_box_minimum");
+    u_box_maximum_      = shader_->uniform_location("u_box_maximum");
+    u_planes_           = shader_->uniform_location("u_planes");
+    u_plane_            = shader_->uniform_location("u_plane");
+    u_coloring_         = shader_->uniform_location("u_coloring");
+    u_coloring_minimum_ = shader_->uniform_location("u_coloring_minimum");
+    u_coloring_maximum_ = shader_->uniform_location("u_coloring_maximum");
+
+    reserve(1);
+  }
+
+  PointProcessor::~PointProcessor(){
+    glDeleteBuffers(1, &command_);
+  }
+
+  bool PointProcessor::is_supported(){
+    return GLExtensions::dispatch_compute != nullptr;
+  }
+
+  void PointProcessor::set_processing(const Visualizer::PointProcessing &processing){
+    processing_ = processing;
+    processing_.planes = std::min(processing_.planes, 4u);
+  }
+
+  const Visualizer::PointProcessing &PointProcessor::processing(){
+    return processing_;
+  }
+
+  const bool PointProcessor::is_coloring(){
+    return processing_.coloring != Visualizer::NO_COLORING;
+  }
+
+  bool PointProcessor::process(const GLuint input, const GLsizei size, const GLsizei stride,
+                               const GLint position, const GLint intensity,
+                               const GLint color, const GLint alpha,
+                               const algebraica::mat4f &model, Colormap &colormap){
+    bool no_error{is_supported() && shader_->use()};
+
+    if(no_error){
+      // the shader reads floats, the offsets are given in floats
+      const GLint floats{static_cast<GLint>(sizeof(float))};
+      reserve(size);
+
+      // the shader counts the kept points from zero
+      const GLuint zero{0u};
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_);
+      glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(GLuint), &zero);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+      shader_->set_value(u_size_, static_cast<GLuint>(size));
+      shader_->set_value(u_stride_, static_cast<int>(stride / floats));
+      shader_->set_value(u_position_, static_cast<int>(position / floats));
+      shader_->set_value(u_intensity_, (intensity < 0)? -1 : static_cast<int>(intensity / floats));
+      shader_->set_value(u_color_,     (color < 0)?     -1 : static_cast<int>(color / floats));
+      shader_->set_value(u_alpha_,     (alpha < 0)?     -1 : static_cast<int>(alpha / floats));
+      shader_->set_value(u_model_, model);
+
+      shader_->set_value(u_clip_box_, processing_.clip_box);
+      shader_->set_value(u_box_minimum_, processing_.box_minimum);
+      shader_->set_value(u_box_maximum_, processing_.box_maximum);
+      shader_->set_value(u_planes_, static_cast<int>(processing_.planes));
+      if(processing_.planes > 0u)
+        glUniform4fv(u_plane_, processing_.planes, processing_.plane[0].data());
+      shader_->set_value(u_coloring_, static_cast<int>(processing_.coloring));
+      shader_->set_value(u_coloring_minimum_, processing_.coloring_minimum);
+      shader_->set_value(u_coloring_maximum_, processing_.coloring_maximum);
+      if(is_coloring()) colormap.bind();
+
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, input);
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, output_.array_id());
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, command_);
+
+      if(size > 0)
+        GLExtensions::dispatch_compute((static_cast<GLuint>(size) + group_size - 1u) /
+                                       group_size, 1u, 1u);
+
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+      // the points and the command are read by the next draw
+      glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    }
+    return no_error;
+  }
+
+  void PointProcessor::draw(){
+    output_.vertex_bind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_);
+    glDrawArraysIndirect(GL_POINTS, nullptr);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    output_.vertex_release();
+  }
+
+  void PointProcessor::reserve(const GLsizei size){
+    if(size <= capacity_) return;
+
+    // the storage grows 50% over the needed size, every point could be kept
+    capacity_ = size + size / 2;
+    const GLsizei stride{output_floats * static_cast<GLsizei>(sizeof(float))};
+
+    output_.vertex_bind();
+    output_.allocate_array(nullptr, static_cast<GLsizeiptr>(capacity_) * stride,
+                           GL_DYNAMIC_COPY);
+    output_.enable(i_position_);
+    output_.attributte_buffer(i_position_, _3D, 0, stride);
+    output_.enable(i_intensity_);
+    output_.attributte_buffer(i_intensity_, _1D, 3 * sizeof(float), stride);
+    output_.enable(i_color_);
+    output_.attributte_buffer(i_color_, _3D, 4 * sizeof(float), stride);
+    output_.enable(i_alpha_);
+    output_.attributte_buffer(i_alpha_, _1D, 7 * sizeof(float), stride);
+    output_.vertex_release();
+  }
+}
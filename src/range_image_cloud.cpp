@@ -0,0 +1,188 @@
+#include "include/range_image_cloud.h"
+
+#include <algorithm>
+
+namespace Toreo {
+  RangeImageCloud::RangeImageCloud(Shader *shader_program, const unsigned int rings,
+                                   const unsigned int columns,
+                                   const std::vector<float> &elevations,
+                                   const float range_scale,
+                                   const Visualizer::ColorMode color_mode,
+                                   const float point_size) :
+    shader_(shader_program),
+    buffer_(true),
+    textures_{0, 0, 0},
+    range_(nullptr),
+    intensity_(nullptr),
+    rings_(rings > 0u ? rings : 1u),
+    columns_(columns > 0u ? columns : 1u),
+    range_scale_(range_scale),
+    azimuth_start_(0.0f),
+    azimuth_step_(_2PI / columns_),
+    primary_model_(nullptr),
+    secondary_model_(),
+    identity_matrix_(),
+    color_mode_(color_mode),
+    point_size_(point_size),
+    color_palette_{algebraica::vec3f(0.2, 0.5, 0.7), algebraica::vec3f(0, 1, 0),
+                   algebraica::vec3f(1, 1, 0), algebraica::vec3f(1, 0, 0)},
+    color_size_(4),
+    colormap_(color_palette_, color_size_)
+  {
+    glGenTextures(3, textures_);
+    create_texture(textures_[0], GL_R16UI, columns_, rings_);
+    create_texture(textures_[1], GL_R8, columns_, rings_);
+    create_texture(textures_[2], GL_RG32F, rings_, 1);
+
+    // no returns and no intensity until the first update
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const std::vector<unsigned short> zeros(rings_ * columns_, 0);
+    GLState::bind_texture(GL_TEXTURE_2D, textures_[0]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns_, rings_, GL_RED_INTEGER,
+                    GL_UNSIGNED_SHORT, zeros.data());
+    GLState::bind_texture(GL_TEXTURE_2D, textures_[1]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns_, rings_, GL_RED, GL_UNSIGNED_BYTE,
+                    zeros.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    set_beam_angles(elevations);
+
+    shader_->use();
+    // GLSL uniform locations
+    u_primary_model_    = shader_->uniform_location("u_primary_model");
+    u_secondary_model_  = shader_->uniform_location("u_secondary_model");
+    u_color_mode_       = shader_->uniform_location("u_color_mode");
+    u_range_scale_      = shader_->uniform_location("u_range_scale");
+    u_azimuth_start_    = shader_->uniform_location("u_azimuth_start");
+    u_azimuth_step_     = shader_->uniform_location("u_azimuth_step");
+    u_columns_          = shader_->uniform_location("u_columns");
+  }
+
+  RangeImageCloud::~RangeImageCloud(){
+    GLState::delete_textures(3, textures_);
+  }
+
+  void RangeImageCloud::change_input(const std::vector<unsigned short> *range,
+                                     const std::vector<unsigned char> *intensity){
+    range_ = range;
+    intensity_ = intensity;
+  }
+
+  void RangeImageCloud::set_beam_angles(const std::vector<float> &elevations,
+                                        const std::vector<float> &azimuth_offsets){
+    std::vector<float> beams(rings_ * 2, 0.0f);
+    for(unsigned int ring = 0; ring < rings_; ++ring){
+      if(ring < elevations.size()) beams[ring * 2] = elevations[ring];
+      if(ring < azimuth_offsets.size()) beams[ring * 2 + 1] = azimuth_offsets[ring];
+    }
+
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_2D, textures_[2]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rings_, 1, GL_RG, GL_FLOAT, beams.data());
+  }
+
+  void RangeImageCloud::set_azimuth(const float start, const float step){
+    azimuth_start_ = start;
+    azimuth_step_ = step;
+  }
+
+  void RangeImageCloud::set_range_scale(const float range_scale){
+    range_scale_ = range_scale;
+  }
+
+  void RangeImageCloud::set_colormap(const algebraica::vec3f *colors,
+                                     const unsigned int quantity){
+    // the maximum readable size is 10 colors
+    color_size_ = std::min(quantity, 10u);
+
+    for(uint i = 0; i < 10; i++)
+      if(i < quantity)
+        color_palette_[i] = algebraica::vec3f(*(colors + i)) / 255.0f;
+      else
+        color_palette_[i] = algebraica::vec3f();
+
+    colormap_.set(color_palette_, color_size_);
+  }
+
+  void RangeImageCloud::set_color_mode(const Visualizer::ColorMode color_mode){
+    color_mode_ = color_mode;
+  }
+
+  void RangeImageCloud::set_transformation_matrix(const algebraica::mat4f *transformation_matrix){
+    primary_model_ = transformation_matrix;
+  }
+
+  void RangeImageCloud::set_point_size(const float point_size){
+    point_size_ = point_size;
+  }
+
+  bool RangeImageCloud::update(){
+    bool no_error{shader_->use()};
+
+    if(no_error){
+      const std::size_t size{static_cast<std::size_t>(rings_) * columns_};
+      // rows of 1 byte texels are not 4 bytes aligned
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      GLState::active_texture(GL_TEXTURE0);
+
+      if(range_ && range_->size() >= size){
+        GLState::bind_texture(GL_TEXTURE_2D, textures_[0]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns_, rings_, GL_RED_INTEGER,
+                        GL_UNSIGNED_SHORT, range_->data());
+      }
+      if(intensity_ && intensity_->size() >= size){
+        GLState::bind_texture(GL_TEXTURE_2D, textures_[1]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, columns_, rings_, GL_RED, GL_UNSIGNED_BYTE,
+                        intensity_->data());
+      }
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    return no_error;
+  }
+
+  bool RangeImageCloud::draw(){
+    bool no_error{shader_->use()};
+
+    if(no_error){
+      buffer_.vertex_bind();
+
+      if(primary_model_)
+        shader_->set_value(u_primary_model_, *primary_model_);
+      else
+        shader_->set_value(u_primary_model_, identity_matrix_);
+
+      shader_->set_value(u_secondary_model_, secondary_model_);
+      shader_->set_value(u_color_mode_, static_cast<float>(color_mode_));
+      shader_->set_value(u_range_scale_, range_scale_);
+      shader_->set_value(u_azimuth_start_, azimuth_start_);
+      shader_->set_value(u_azimuth_step_, azimuth_step_);
+      shader_->set_value(u_columns_, static_cast<int>(columns_));
+
+      // texture units defined by the bindings in range_image.vert
+      for(GLenum unit = 0; unit < 3; ++unit){
+        GLState::active_texture(GL_TEXTURE0 + unit);
+        GLState::bind_texture(GL_TEXTURE_2D, textures_[unit]);
+      }
+      if(color_mode_ != Visualizer::GRAYSCALE) colormap_.bind(3u);
+
+      glPointSize(point_size_);
+      glDrawArrays(GL_POINTS, 0, rings_ * columns_);
+      glPointSize(1.0f);
+
+      buffer_.vertex_release();
+    }
+    return no_error;
+  }
+
+  void RangeImageCloud::create_texture(const GLuint texture, const GLenum internal_format,
+                                       const GLsizei width, const GLsizei height){
+    GLState::active_texture(GL_TEXTURE0);
+    GLState::bind_texture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, width, height);
+    // the texels are read with texelFetch, integer textures can not be filtered
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+}
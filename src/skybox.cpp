@@ -33,23 +33,18 @@ namespace Toreo {
     if(!sky_shader_->use())
       core_->message_handler(sky_shader_->error_log(), Visualizer::ERROR);
 
-    sky_u_pv_ = sky_shader_->uniform_location("u_pv");
     sky_u_skybox_ = sky_shader_->uniform_location("u_skybox");
 
-    signal_update_camera_ = core->signal_updated_camera()
-                            ->connect(boost::bind(&Skybox::update_camera, this));
-    signal_update_screen_ = core->syncronize(Visualizer::SKYBOX)
-                            ->connect(boost::bind(&Skybox::draw, this));
+    render_pass_ = core->add_render_pass(Visualizer::SKYBOX, boost::bind(&Skybox::draw, this));
 
     runner_ = boost::thread(boost::bind(&Skybox::load_images, this));
     runner_.detach();
   }
 
   Skybox::~Skybox(){
-    signal_update_camera_.disconnect();
-    signal_update_screen_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
-    glDeleteTextures(1, &sky_texture_id_);
+    GLState::delete_textures(1, &sky_texture_id_);
 
     delete buffer_cube_;
     delete sky_shader_;
@@ -58,8 +53,8 @@ namespace Toreo {
   void Skybox::draw(){
     if(is_loaded_){
       sky_shader_->use();
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
+      GLState::active_texture(GL_TEXTURE0);
+      GLState::bind_texture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
 
       buffer_cube_->vertex_bind();
       glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -122,6 +117,8 @@ namespace Toreo {
     protector_.lock();
     is_ready_ = true;
     protector_.unlock();
+    // the images are loaded in the next frame
+    core_->request_redraw();
   }
 
   void Skybox::load_ready(){
@@ -130,9 +127,9 @@ namespace Toreo {
       if(is_ready_){
         // pbr: setup cubemap to render to and attach to framebuffer
         // ---------------------------------------------------------
-        glActiveTexture(GL_TEXTURE0);
+        GLState::active_texture(GL_TEXTURE0);
         glGenTextures(1, &sky_texture_id_);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
+        GLState::bind_texture(GL_TEXTURE_CUBE_MAP, sky_texture_id_);
 
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -158,11 +155,6 @@ namespace Toreo {
         sky_shader_->use();
         sky_shader_->set_value(sky_u_skybox_, 0);
 
-        // initialize static shader uniforms before rendering
-        // --------------------------------------------------
-        sky_shader_->use();
-        sky_shader_->set_value(sky_u_pv_, core_->camera_matrix_static_perspective_view());
-
         is_loaded_ = true;
 
       }else{
@@ -171,13 +163,6 @@ namespace Toreo {
     }
   }
 
-  void Skybox::update_camera(){
-    if(is_ready_){
-      sky_shader_->use();
-      sky_shader_->set_value(sky_u_pv_, core_->camera_matrix_static_perspective_view());
-    }
-  }
-
   void Skybox::write_data_opengl(const Visualizer::ImageFile &image, const int level){
     switch(image.components_size){
     case 1:
@@ -310,12 +310,15 @@ namespace Toreo{
       error_ = false;
       error_log_.clear();
       protector_.unlock();
+      // the textures are loaded in the next frame
+      core_->request_redraw();
     }else{
       protector_.lock();
       error_ = true;
       error_log_ = "File not found:" + folder_address_ + "...\n----------\n";
       is_ready_ = false;
       protector_.unlock();
+      core_->request_redraw();
     }
   }
 
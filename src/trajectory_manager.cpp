@@ -9,45 +9,34 @@ namespace Toreo {
     shader_(new Shader("resources/shaders/trajectory.vert",
                        "resources/shaders/trajectory.frag",
                        "resources/shaders/trajectory.geom")),
-    u_pv_(shader_->uniform_location("u_pv")),
     u_point_light_(shader_->uniform_location("u_point_light")),
     u_point_light_color_(shader_->uniform_location("u_point_light_color")),
     u_directional_light_(shader_->uniform_location("u_directional_light")),
     u_directional_light_color_(shader_->uniform_location("u_directional_light_color")),
-    u_camera_position_(shader_->uniform_location("u_camera_position")),
     trajectories_(0),
     solid_(nullptr),
     dotted_(nullptr),
     dashed_(nullptr),
     arrowed_(nullptr),
-    signal_updated_camera_(core->signal_updated_camera()->
-                           connect(boost::bind(&TrajectoryManager::updated_camera, this))),
-    signal_draw_all_(core->syncronize(Visualizer::TRAJECTORIES)->
-                     connect(boost::bind(&TrajectoryManager::draw_all, this)))
+    render_pass_(core->add_render_pass(Visualizer::TRAJECTORIES,
+                                       boost::bind(&TrajectoryManager::draw_all, this)))
   {
     initialize();
   }
 
   TrajectoryManager::~TrajectoryManager(){
-    for(Visualizer::TrajectoryElement trajectory : trajectories_)
+    for(Visualizer::TrajectoryElement &trajectory : trajectories_)
       if(trajectory.trajectory != nullptr){
         if(trajectory.connection.connected())
           trajectory.connection.disconnect();
         delete trajectory.trajectory;
       }
 
-    if(signal_updated_camera_.connected())
-      signal_updated_camera_.disconnect();
-
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
+    core_->remove_render_pass(render_pass_);
 
     if(signal_updated_all_.connected())
       signal_updated_all_.disconnect();
 
-    if(signal_draw_all_.connected())
-      signal_draw_all_.disconnect();
-
     if(solid_) delete solid_;
     if(dotted_) delete dotted_;
     if(dashed_) delete dashed_;
@@ -63,11 +52,12 @@ namespace Toreo {
                               const Visualizer::LineType type,
                               const bool visible){
     Visualizer::TrajectoryElement trajectory = { new Trajectory(shader_, trajectories),
-                                                 type, name, visible };
+                                                 type, name, visible, {}, {} };
     if(transformation_matrix != nullptr)
       trajectory.trajectory->set_transformation_matrix(transformation_matrix);
 
     trajectories_.push_back(trajectory);
+    core_->request_redraw();
     return trajectories_.size() - 1;
   }
 
@@ -87,6 +77,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).type = type;
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -97,6 +88,7 @@ namespace Toreo {
   bool TrajectoryManager::set_visibility(TMid id, const bool visible){
     if(trajectories_.size() > id){
       trajectories_.at(id).visibility = visible;
+      core_->request_redraw();
       return true;
     }else
       return false;
@@ -107,6 +99,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->set_transformation_matrix(transformation_matrix);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -118,6 +111,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->translate(-y, z, -x);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -129,6 +123,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->rotate(-pitch, yaw, -roll);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -140,6 +135,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->rotate_in_z(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -151,6 +147,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->rotate_in_x(-angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -162,6 +159,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr){
         trajectories_.at(id).trajectory->rotate_in_y(angle);
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -173,6 +171,7 @@ namespace Toreo {
     if(trajectories_.size() > id)
       if(trajectories_.at(id).trajectory != nullptr && trajectories_.at(id).visibility){
         trajectories_.at(id).trajectory->update();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -181,9 +180,10 @@ namespace Toreo {
   }
 
   void TrajectoryManager::update_all(){
-    for(Visualizer::TrajectoryElement trajectory : trajectories_)
+    for(Visualizer::TrajectoryElement &trajectory : trajectories_)
       if(trajectory.trajectory != nullptr && trajectory.visibility)
         trajectory.trajectory->update();
+    core_->request_redraw();
   }
 
   bool TrajectoryManager::draw(TMid id){
@@ -212,8 +212,10 @@ namespace Toreo {
   }
 
   void TrajectoryManager::draw_all(){
-    for(Visualizer::TrajectoryElement trajectory : trajectories_)
+    for(Visualizer::TrajectoryElement &trajectory : trajectories_)
       if(trajectory.trajectory != nullptr && trajectory.visibility){
+        if(trajectory.refresh && trajectory.refresh())
+          trajectory.trajectory->update();
         switch(trajectory.type){
         case Visualizer::DOTTED:
           if(dotted_) dotted_->use();
@@ -239,6 +241,8 @@ namespace Toreo {
           trajectories_.at(id).connection.disconnect();
         delete trajectories_.at(id).trajectory;
         trajectories_.at(id).trajectory = nullptr;
+        trajectories_.at(id).refresh.clear();
+        core_->request_redraw();
         return true;
       }else
         return false;
@@ -247,13 +251,14 @@ namespace Toreo {
   }
 
   void TrajectoryManager::purge(){
-    for(Visualizer::TrajectoryElement trajectory : trajectories_)
+    for(Visualizer::TrajectoryElement &trajectory : trajectories_)
       if(trajectory.trajectory != nullptr){
         if(trajectory.connection.connected())
           trajectory.connection.disconnect();
         delete trajectory.trajectory;
       }
     trajectories_.clear();
+    core_->request_redraw();
   }
 
   bool TrajectoryManager::connect(TMid id, boost::signals2::signal<void ()> *signal){
@@ -276,9 +281,19 @@ namespace Toreo {
     signal_updated_all_ = signal->connect(boost::bind(&TrajectoryManager::update_all, this));
   }
 
-  void TrajectoryManager::updated_camera(){
-    shader_->use();
-    shader_->set_value(u_pv_, core_->camera_matrix_perspective_view());
+  void TrajectoryManager::request_redraw(){
+    core_->request_redraw();
+  }
+
+  bool TrajectoryManager::unsubscribe(TMid id){
+    if(trajectories_.size() > id)
+      if(trajectories_.at(id).trajectory != nullptr){
+        trajectories_.at(id).refresh.clear();
+        return true;
+      }else
+        return false;
+    else
+      return false;
   }
 
   void TrajectoryManager::initialize(){
@@ -330,7 +345,6 @@ namespace Toreo {
     if(t_texture.data) arrowed_ = new Texture(8, core_->max_anisotropic_filtering(), &t_texture);
     stbi_image_free(t_texture.data);
 
-    shader_->set_value(u_pv_, core_->camera_matrix_perspective_view());
     shader_->set_value(shader_->uniform_location("u_diffuse"), 8);
   }
 }
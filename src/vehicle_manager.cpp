@@ -1,7 +1,9 @@
 #include "include/vehicle_manager.h"
+#include "include/core.h"
 
 namespace Toreo {
-  VehicleManager::VehicleManager() :
+  VehicleManager::VehicleManager(Core *core) :
+    core_(core),
     null_(0.0f),
     null_d_(0.0),
     latitude_(nullptr),
@@ -135,6 +137,7 @@ namespace Toreo {
     vehicle_frame_.rotate(*pitch_, *yaw_, *roll_);
 
     navigation_frame_ = vehicle_frame_.only_translation();
+    core_->request_redraw();
   }
 
   const algebraica::mat4f *VehicleManager::navigation_frame() const{
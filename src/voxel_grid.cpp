@@ -0,0 +1,239 @@
+#include "include/voxel_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TORERO_VOXEL_GRID_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Toreo {
+  namespace {
+    // voxel coordinates are stored with an offset of 2^20 in 21 bits, points further than
+    // 2^20 leaves from the origin are merged into the border voxels
+    const std::int32_t voxel_offset = 1 << 20;
+    const std::int32_t voxel_maximum = (1 << 21) - 1;
+    // below this number of points per thread the threads cost more than they save
+    const std::size_t minimum_thread_points = 65536u;
+
+    std::uint64_t mix(std::uint64_t key){
+      // splitmix64 finalizer
+      key ^= key >> 30;
+      key *= 0xbf58476d1ce4e5b9ull;
+      key ^= key >> 27;
+      key *= 0x94d049bb133111ebull;
+      return key ^ (key >> 31);
+    }
+
+    std::uint64_t pack(const std::int32_t x, const std::int32_t y, const std::int32_t z){
+      return static_cast<std::uint64_t>(x) | (static_cast<std::uint64_t>(y) << 21) |
+             (static_cast<std::uint64_t>(z) << 42);
+    }
+
+    std::int32_t voxel(const float value, const float inverse_leaf){
+      const float scaled{value * inverse_leaf};
+      // NaN and values too big for an integer
+      if(!(scaled > -voxel_offset)) return 0;
+      if(!(scaled < voxel_offset)) return voxel_maximum;
+      return std::min(static_cast<std::int32_t>(std::floor(scaled)) + voxel_offset,
+                      voxel_maximum);
+    }
+
+#ifdef TORERO_VOXEL_GRID_SSE2
+    // floor(value * inverse_leaf) + offset limited to 0 -> maximum, for 4 values
+    __m128i voxel(const __m128 value, const __m128 inverse_leaf){
+      const __m128 limit{_mm_set1_ps(static_cast<float>(voxel_offset))};
+      // clamping before the conversion also removes NaN (the comparison is false)
+      __m128 scaled{_mm_mul_ps(value, inverse_leaf)};
+      scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+
+      __m128i truncated{_mm_cvttps_epi32(scaled)};
+      // truncation rounds negative values up: subtract 1 where value < truncated
+      const __m128 greater{_mm_cmplt_ps(scaled, _mm_cvtepi32_ps(truncated))};
+      truncated = _mm_add_epi32(truncated, _mm_castps_si128(greater));
+      truncated = _mm_add_epi32(truncated, _mm_set1_epi32(voxel_offset));
+
+      // SSE2 does not have integer min/max
+      const __m128i maximum{_mm_set1_epi32(voxel_maximum)};
+      const __m128i over{_mm_cmpgt_epi32(truncated, maximum)};
+      truncated = _mm_or_si128(_mm_and_si128(over, maximum), _mm_andnot_si128(over, truncated));
+      const __m128i under{_mm_cmplt_epi32(truncated, _mm_setzero_si128())};
+      return _mm_andnot_si128(under, truncated);
+    }
+#endif
+  }
+
+  VoxelGrid::VoxelGrid(const float leaf_size, const unsigned int threads) :
+    leaf_size_(leaf_size > 0.0f ? leaf_size : 0.1f),
+    threads_(threads > 0u ? threads : std::max(boost::thread::hardware_concurrency(), 1u)),
+    keys_(0),
+    hashes_(0),
+    buckets_(threads_ * threads_),
+    kept_(threads_),
+    indices_(0),
+    workers_(nullptr)
+  {}
+
+  VoxelGrid::~VoxelGrid(){
+    if(workers_) delete workers_;
+  }
+
+  void VoxelGrid::set_leaf_size(const float leaf_size){
+    if(leaf_size > 0.0f) leaf_size_ = leaf_size;
+  }
+
+  float VoxelGrid::leaf_size(){
+    return leaf_size_;
+  }
+
+  std::size_t VoxelGrid::filter(const void *points, const std::size_t count,
+                                const std::size_t stride, std::vector<unsigned char> *output,
+                                const std::size_t position_offset){
+    select(points, count, stride, position_offset);
+    gather(points, stride, output);
+    return indices_.size();
+  }
+
+  std::size_t VoxelGrid::random_subset(const void *points, const std::size_t count,
+                                       const std::size_t stride, const float fraction,
+                                       std::vector<unsigned char> *output){
+    const std::uint64_t threshold{static_cast<std::uint64_t>(
+                                    std::min(std::max(fraction, 0.0f), 1.0f) * 16777216.0f)};
+    indices_.clear();
+    for(std::size_t i = 0; i < count; ++i)
+      if((mix(i) & 0xFFFFFFu) < threshold)
+        indices_.push_back(static_cast<std::uint32_t>(i));
+
+    gather(points, stride, output);
+    return indices_.size();
+  }
+
+  void VoxelGrid::select(const void *points, const std::size_t count, const std::size_t stride,
+                         const std::size_t position_offset){
+    const unsigned char *positions{static_cast<const unsigned char*>(points) + position_offset};
+    const unsigned int threads{static_cast<unsigned int>(
+                                 std::min<std::size_t>(threads_,
+                                                       count / minimum_thread_points + 1u))};
+    keys_.resize(count);
+    hashes_.resize(count);
+
+    run(boost::bind(&VoxelGrid::compute_keys, this, positions, stride, count, _1, threads),
+        threads);
+    run(boost::bind(&VoxelGrid::unique_keys, this, _1, threads), threads);
+
+    indices_.clear();
+    for(unsigned int thread = 0; thread < threads; ++thread)
+      indices_.insert(indices_.end(), kept_[thread].begin(), kept_[thread].end());
+    // every thread keeps its points in order, merging them restores the original order
+    if(threads > 1u) std::sort(indices_.begin(), indices_.end());
+  }
+
+  void VoxelGrid::run(const boost::function<void (unsigned int)> &task,
+                      const unsigned int threads){
+    if(threads > 1u && !workers_) workers_ = new WorkerPool(threads_ - 1u);
+
+    for(unsigned int thread = 0; thread + 1u < threads; ++thread)
+      workers_->post(boost::bind(task, thread));
+    task(threads - 1u);
+    if(threads > 1u) workers_->wait();
+  }
+
+  void VoxelGrid::compute_keys(const unsigned char *points, const std::size_t stride,
+                               const std::size_t count, const unsigned int share,
+                               const unsigned int threads){
+    const std::size_t size{(count + threads - 1u) / threads};
+    const std::size_t first{std::min(count, share * size)};
+    const std::size_t last{std::min(count, (share + 1u) * size)};
+    const float inverse_leaf{1.0f / leaf_size_};
+    std::size_t i{first};
+
+#ifdef TORERO_VOXEL_GRID_SSE2
+    const __m128 inverse{_mm_set1_ps(inverse_leaf)};
+    alignas(16) std::int32_t x[4], y[4], z[4];
+
+    for(; i + 4u <= last; i += 4u){
+      float position[4][3];
+      for(int j = 0; j < 4; ++j)
+        std::memcpy(position[j], points + (i + j) * stride, sizeof(position[j]));
+
+      _mm_store_si128(reinterpret_cast<__m128i*>(x),
+                      voxel(_mm_set_ps(position[3][0], position[2][0], position[1][0],
+                                       position[0][0]), inverse));
+      _mm_store_si128(reinterpret_cast<__m128i*>(y),
+                      voxel(_mm_set_ps(position[3][1], position[2][1], position[1][1],
+                                       position[0][1]), inverse));
+      _mm_store_si128(reinterpret_cast<__m128i*>(z),
+                      voxel(_mm_set_ps(position[3][2], position[2][2], position[1][2],
+                                       position[0][2]), inverse));
+
+      for(int j = 0; j < 4; ++j)
+        keys_[i + j] = pack(x[j], y[j], z[j]);
+    }
+#endif
+
+    for(; i < last; ++i){
+      float position[3];
+      std::memcpy(position, points + i * stride, sizeof(position));
+      keys_[i] = pack(voxel(position[0], inverse_leaf), voxel(position[1], inverse_leaf),
+                      voxel(position[2], inverse_leaf));
+    }
+
+    // every point is hashed only once, the threads only read their own buckets
+    std::vector<std::uint32_t> *buckets{&buckets_[share * threads]};
+    for(unsigned int thread = 0; thread < threads; ++thread)
+      buckets[thread].clear();
+    for(i = first; i < last; ++i){
+      hashes_[i] = mix(keys_[i]);
+      buckets[hashes_[i] % threads].push_back(static_cast<std::uint32_t>(i));
+    }
+  }
+
+  void VoxelGrid::unique_keys(const unsigned int thread, const unsigned int threads){
+    std::vector<std::uint32_t> &kept = kept_[thread];
+    kept.clear();
+
+    std::size_t size{0u};
+    for(unsigned int share = 0; share < threads; ++share)
+      size += buckets_[share * threads + thread].size();
+
+    // open addressing table with at least twice the number of points of this thread,
+    // ~0 is never a key (only 63 bits are used)
+    const std::uint64_t empty{~0ull};
+    std::size_t capacity{64u};
+    while(capacity < 2u * size + 16u) capacity <<= 1;
+    std::vector<std::uint64_t> table(capacity, empty);
+    const std::size_t mask{capacity - 1u};
+
+    // the shares are consecutive ranges of points: the kept points stay in order
+    for(unsigned int share = 0; share < threads; ++share)
+      for(const std::uint32_t i : buckets_[share * threads + thread]){
+        const std::uint64_t key{keys_[i]};
+
+        std::size_t slot{static_cast<std::size_t>(hashes_[i] >> 16) & mask};
+        while(table[slot] != empty && table[slot] != key)
+          slot = (slot + 1u) & mask;
+
+        if(table[slot] == empty){
+          table[slot] = key;
+          kept.push_back(i);
+        }
+      }
+  }
+
+  void VoxelGrid::gather(const void *points, const std::size_t stride,
+                         std::vector<unsigned char> *output){
+    const unsigned char *input{static_cast<const unsigned char*>(points)};
+    output->resize(indices_.size() * stride);
+
+    unsigned char *destination{output->data()};
+    for(const std::uint32_t index : indices_){
+      std::memcpy(destination, input + index * stride, stride);
+      destination += stride;
+    }
+  }
+}